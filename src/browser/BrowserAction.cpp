@@ -21,6 +21,7 @@
 #include "BrowserShared.h"
 #include "config-keepassx.h"
 #include "core/Global.h"
+#include "core/Trace.h"
 
 #include <QJsonDocument>
 #include <QJsonParseError>
@@ -54,6 +55,7 @@ namespace
 
 QJsonObject BrowserAction::processClientMessage(const QJsonObject& json)
 {
+    TRACE_SCOPE("browser", "processClientMessage");
     if (json.isEmpty()) {
         return getErrorReply("", ERROR_KEEPASS_EMPTY_MESSAGE_RECEIVED);
     }
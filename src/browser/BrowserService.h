@@ -165,6 +165,7 @@ private:
     Q_DISABLE_COPY(BrowserService);
 
     friend class TestBrowser;
+    friend class TestDatabaseBenchmark;
 };
 
 static inline BrowserService* browserService()
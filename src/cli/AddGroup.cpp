@@ -31,6 +31,7 @@ AddGroup::AddGroup()
     name = QString("mkdir");
     description = QObject::tr("Adds a new group to a database.");
     positionalArguments.append({QString("group"), QObject::tr("Path of the group to add."), QString("")});
+    addCompressionOptions();
 }
 
 AddGroup::~AddGroup()
@@ -21,6 +21,7 @@
 
 #include <QCommandLineParser>
 #include <QFile>
+#include <QSaveFile>
 #include <QString>
 
 #include "cli/TextStream.h"
@@ -34,17 +35,19 @@ const QCommandLineOption Analyze::HIBPDatabaseOption = QCommandLineOption(
                 "https://haveibeenpwned.com/Passwords."),
     QObject::tr("FILENAME"));
 
-const QCommandLineOption Analyze::OkonOption =
-    QCommandLineOption("okon",
-                       QObject::tr("Path to okon-cli to search a formatted HIBP file"),
-                       QObject::tr("okon-cli"));
+const QCommandLineOption Analyze::BuildHibpIndexOption =
+    QCommandLineOption("build-hibp-index",
+                       QObject::tr("Convert the HIBP file, which must be ordered by hash, into an index at FILENAME "
+                                   "before checking the passwords. Pass the index to --hibp to check against it "
+                                   "later on."),
+                       QObject::tr("FILENAME"));
 
 Analyze::Analyze()
 {
     name = QString("analyze");
     description = QObject::tr("Analyze passwords for weaknesses and problems.");
     options.append(Analyze::HIBPDatabaseOption);
-    options.append(Analyze::OkonOption);
+    options.append(Analyze::BuildHibpIndexOption);
 }
 
 int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -61,27 +64,53 @@ int Analyze::executeWithDatabase(QSharedPointer<Database> database, QSharedPoint
         return EXIT_FAILURE;
     }
 
-    auto okon = parser->value(Analyze::OkonOption);
-    if (!okon.isEmpty()) {
-        out << QObject::tr("Evaluating database entries using okon...") << endl;
-
-        if (!HibpOffline::okonReport(database, okon, hibpDatabase, findings, &error)) {
-            err << error << endl;
-            return EXIT_FAILURE;
-        }
-    } else {
+    auto hibpIndex = parser->value(Analyze::BuildHibpIndexOption);
+    if (!hibpIndex.isEmpty()) {
         QFile hibpFile(hibpDatabase);
         if (!hibpFile.open(QFile::ReadOnly)) {
             err << QObject::tr("Failed to open HIBP file %1: %2").arg(hibpDatabase).arg(hibpFile.errorString()) << endl;
             return EXIT_FAILURE;
         }
+        QSaveFile indexFile(hibpIndex);
+        if (!indexFile.open(QIODevice::WriteOnly)) {
+            err << QObject::tr("Failed to open HIBP index %1: %2").arg(hibpIndex).arg(indexFile.errorString()) << endl;
+            return EXIT_FAILURE;
+        }
 
-        out << QObject::tr("Evaluating database entries against HIBP file, this will take a while...") << endl;
+        out << QObject::tr("Building HIBP index, this will take a while...") << endl;
 
-        if (!HibpOffline::report(database, hibpFile, findings, &error)) {
+        if (!HibpOffline::buildIndex(hibpFile, indexFile, &error)) {
             err << error << endl;
             return EXIT_FAILURE;
         }
+        if (!indexFile.commit()) {
+            err << QObject::tr("Failed to write HIBP index %1: %2").arg(hibpIndex).arg(indexFile.errorString())
+                << endl;
+            return EXIT_FAILURE;
+        }
+        hibpDatabase = hibpIndex;
+    }
+
+    QFile hibpFile(hibpDatabase);
+    if (!hibpFile.open(QFile::ReadOnly)) {
+        err << QObject::tr("Failed to open HIBP file %1: %2").arg(hibpDatabase).arg(hibpFile.errorString()) << endl;
+        return EXIT_FAILURE;
+    }
+
+    out << QObject::tr("Evaluating database entries against HIBP file, this will take a while...") << endl;
+
+    // Only reported when the whole file has to be read
+    int reportedPercent = 0;
+    auto progress = [&](qint64 processed, qint64 total) {
+        const int percent = total > 0 ? static_cast<int>(processed * 100 / total) : 0;
+        if (percent / 10 > reportedPercent / 10) {
+            out << QObject::tr("Read %1% of the HIBP file").arg(percent) << endl;
+            reportedPercent = percent;
+        }
+    };
+    if (!HibpOffline::report(database, hibpFile, findings, &error, progress)) {
+        err << error << endl;
+        return EXIT_FAILURE;
     }
 
     for (auto& finding : findings) {
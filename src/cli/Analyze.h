@@ -27,7 +27,7 @@ public:
     int executeWithDatabase(QSharedPointer<Database> db, QSharedPointer<QCommandLineParser> parser) override;
 
     static const QCommandLineOption HIBPDatabaseOption;
-    static const QCommandLineOption OkonOption;
+    static const QCommandLineOption BuildHibpIndexOption;
 
 private:
     void printHibpFinding(const Entry* entry, int count, QTextStream& out);
@@ -76,6 +76,16 @@ const QCommandLineOption Command::YubiKeyOption =
                        QObject::tr("Yubikey slot and optional serial used to access the database (e.g., 1:7370001)."),
                        QObject::tr("slot[:serial]"));
 
+const QCommandLineOption Command::CompressionLevelOption = QCommandLineOption(
+    QStringList() << "compression-level",
+    QObject::tr("Compression level used when saving the database: fast, default, best or 1 to 9."),
+    QObject::tr("level"));
+
+const QCommandLineOption Command::CompressionBufferSizeOption =
+    QCommandLineOption(QStringList() << "compression-buffer-size",
+                       QObject::tr("Size of the compression buffers in KiB used when saving the database."),
+                       QObject::tr("size"));
+
 namespace
 {
 
@@ -158,6 +168,100 @@ QSharedPointer<QCommandLineParser> Command::getCommandLineParser(const QStringLi
     return parser;
 }
 
+/**
+ * Accept the compression options on the command line. Only commands
+ * that save a database should call this.
+ */
+void Command::addCompressionOptions()
+{
+    options.append(Command::CompressionLevelOption);
+    options.append(Command::CompressionBufferSizeOption);
+    m_compressionOptions = true;
+}
+
+/**
+ * Validate the compression options of the command line. Commands call
+ * this before prompting for a password.
+ *
+ * @return false if an option has an invalid value
+ */
+bool Command::checkCompressionOptions(const QCommandLineParser& parser)
+{
+    return parseCompressionOptions(parser, nullptr, nullptr);
+}
+
+/**
+ * Apply the compression options of the command line to a database
+ * before it is saved.
+ *
+ * @return false if an option has an invalid value
+ */
+bool Command::applyCompressionOptions(const QCommandLineParser& parser, Database* db)
+{
+    int level = 0;
+    int bufferSize = 0;
+    if (!parseCompressionOptions(parser, &level, &bufferSize)) {
+        return false;
+    }
+    if (level > 0) {
+        db->setCompressionLevel(level);
+    }
+    if (bufferSize > 0) {
+        db->setCompressionBufferSize(bufferSize);
+    }
+    return true;
+}
+
+/**
+ * @param level set to the compression level, or 0 if not given
+ * @param bufferSize set to the buffer size in bytes, or 0 if not given
+ * @return false if an option has an invalid value
+ */
+bool Command::parseCompressionOptions(const QCommandLineParser& parser, int* level, int* bufferSize)
+{
+    auto& err = Utils::STDERR;
+
+    if (!m_compressionOptions) {
+        return true;
+    }
+
+    if (parser.isSet(CompressionLevelOption)) {
+        const QString value = parser.value(CompressionLevelOption);
+        int parsedLevel = 0;
+        if (value == QStringLiteral("fast")) {
+            parsedLevel = Database::CompressionLevelFast;
+        } else if (value == QStringLiteral("default")) {
+            parsedLevel = Database::CompressionLevelDefault;
+        } else if (value == QStringLiteral("best")) {
+            parsedLevel = Database::CompressionLevelBest;
+        } else {
+            parsedLevel = value.toInt();
+        }
+        if (parsedLevel < Database::CompressionLevelFast || parsedLevel > Database::CompressionLevelBest) {
+            err << QObject::tr("Invalid compression level %1.").arg(value) << endl;
+            return false;
+        }
+        if (level) {
+            *level = parsedLevel;
+        }
+    }
+
+    if (parser.isSet(CompressionBufferSizeOption)) {
+        const QString value = parser.value(CompressionBufferSizeOption);
+        const int size = value.toInt();
+        if (size < 4 || size > 64 * 1024) {
+            err << QObject::tr("Invalid compression buffer size %1, must be between 4 and 65536 KiB.").arg(value)
+                << endl;
+            return false;
+        }
+        if (bufferSize) {
+            *bufferSize = size * 1024;
+        }
+    }
+
+    return true;
+}
+
 namespace Commands
 {
     QMap<QString, QSharedPointer<Command>> s_commands;
@@ -52,12 +52,24 @@ public:
     QString getDescriptionLine();
     QSharedPointer<QCommandLineParser> getCommandLineParser(const QStringList& arguments);
     QString getHelpText();
+    bool checkCompressionOptions(const QCommandLineParser& parser);
+    bool applyCompressionOptions(const QCommandLineParser& parser, Database* db);
 
     static const QCommandLineOption HelpOption;
     static const QCommandLineOption QuietOption;
     static const QCommandLineOption KeyFileOption;
     static const QCommandLineOption NoPasswordOption;
     static const QCommandLineOption YubiKeyOption;
+    static const QCommandLineOption CompressionLevelOption;
+    static const QCommandLineOption CompressionBufferSizeOption;
+
+protected:
+    void addCompressionOptions();
+
+private:
+    bool parseCompressionOptions(const QCommandLineParser& parser, int* level, int* bufferSize);
+
+    bool m_compressionOptions = false;
 };
 
 namespace Commands
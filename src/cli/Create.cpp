@@ -55,6 +55,7 @@ Create::Create()
     options.append(Create::SetKeyFileOption);
     options.append(Create::SetPasswordOption);
     options.append(Create::DecryptionTimeOption);
+    addCompressionOptions();
 }
 
 /**
@@ -88,6 +89,10 @@ int Create::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
+    if (!checkCompressionOptions(*parser)) {
+        return EXIT_FAILURE;
+    }
+
     // Validate the decryption time before asking for a password.
     QString decryptionTimeValue = parser->value(Create::DecryptionTimeOption);
     int decryptionTime = 0;
@@ -136,6 +141,9 @@ int Create::execute(const QStringList& arguments)
 
     QSharedPointer<Database> db(new Database);
     db->setKey(key);
+    if (!applyCompressionOptions(*parser, db.data())) {
+        return EXIT_FAILURE;
+    }
 
     if (decryptionTime != 0) {
         auto kdf = db->kdf();
@@ -41,6 +41,10 @@ int DatabaseCommand::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
+    if (!checkCompressionOptions(*parser)) {
+        return EXIT_FAILURE;
+    }
+
     QStringList args = parser->positionalArguments();
     auto db = currentDatabase;
     if (!db) {
@@ -63,5 +67,9 @@ int DatabaseCommand::execute(const QStringList& arguments)
         }
     }
 
+    if (!applyCompressionOptions(*parser, db.data())) {
+        return EXIT_FAILURE;
+    }
+
     return executeWithDatabase(db, parser);
 }
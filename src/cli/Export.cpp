@@ -20,16 +20,16 @@
 
 #include "Export.h"
 
-#include "cli/TextStream.h"
 #include "cli/Utils.h"
 #include "core/Database.h"
 #include "format/CsvExporter.h"
+#include "format/HtmlExporter.h"
 
 const QCommandLineOption Export::FormatOption = QCommandLineOption(
     QStringList() << "f"
                   << "format",
-    QObject::tr("Format to use when exporting. Available choices are 'xml' or 'csv'. Defaults to 'xml'."),
-    QStringLiteral("xml|csv"));
+    QObject::tr("Format to use when exporting. Available choices are 'xml', 'csv' or 'html'. Defaults to 'xml'."),
+    QStringLiteral("xml|csv|html"));
 
 Export::Export()
 {
@@ -40,21 +40,30 @@ Export::Export()
 
 int Export::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
 {
-    TextStream out(Utils::STDOUT.device());
+    // Exports are written straight to the output device as they are generated
+    // instead of being assembled in memory first.
+    QIODevice* out = Utils::STDOUT.device();
     auto& err = Utils::STDERR;
 
     QString format = parser->value(Export::FormatOption);
     if (format.isEmpty() || format.startsWith(QStringLiteral("xml"), Qt::CaseInsensitive)) {
-        QByteArray xmlData;
         QString errorMessage;
-        if (!database->extract(xmlData, &errorMessage)) {
+        if (!database->extract(out, &errorMessage)) {
             err << QObject::tr("Unable to export database to XML: %1").arg(errorMessage) << endl;
             return EXIT_FAILURE;
         }
-        out.write(xmlData.constData());
     } else if (format.startsWith(QStringLiteral("csv"), Qt::CaseInsensitive)) {
         CsvExporter csvExporter;
-        out << csvExporter.exportDatabase(database);
+        if (!csvExporter.exportDatabase(out, database)) {
+            err << QObject::tr("Unable to export database to CSV: %1").arg(csvExporter.errorString()) << endl;
+            return EXIT_FAILURE;
+        }
+    } else if (format.startsWith(QStringLiteral("html"), Qt::CaseInsensitive)) {
+        HtmlExporter htmlExporter;
+        if (!htmlExporter.exportDatabase(out, database)) {
+            err << QObject::tr("Unable to export database to HTML: %1").arg(htmlExporter.errorString()) << endl;
+            return EXIT_FAILURE;
+        }
     } else {
         err << QObject::tr("Unsupported format %1").arg(format) << endl;
         return EXIT_FAILURE;
@@ -27,6 +27,7 @@
 #include "cli/TextStream.h"
 #include "cli/Utils.h"
 #include "core/Database.h"
+#include "core/ImportTask.h"
 #include "keys/CompositeKey.h"
 #include "keys/Key.h"
 
@@ -46,6 +47,7 @@ Import::Import()
     description = QObject::tr("Import the contents of an XML database.");
     positionalArguments.append({QString("xml"), QObject::tr("Path of the XML database export."), QString("")});
     positionalArguments.append({QString("database"), QObject::tr("Path of the new database."), QString("")});
+    addCompressionOptions();
 }
 
 int Import::execute(const QStringList& arguments)
@@ -67,6 +69,10 @@ int Import::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
+    if (!checkCompressionOptions(*parser)) {
+        return EXIT_FAILURE;
+    }
+
     auto key = QSharedPointer<CompositeKey>::create();
 
     auto passwordKey = Utils::getConfirmedPassword();
@@ -81,17 +87,27 @@ int Import::execute(const QStringList& arguments)
         return EXIT_FAILURE;
     }
 
-    QString errorMessage;
-    Database db;
-    db.setKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2));
-    db.setKey(key);
+    ImportTask importTask([&xmlExportPath](ImportTask*, QString* error) {
+        auto db = QSharedPointer<Database>::create();
+        if (!db->import(xmlExportPath, error)) {
+            return QSharedPointer<Database>();
+        }
+        return db;
+    });
+    auto db = importTask.run();
+    if (!db) {
+        err << QObject::tr("Unable to import XML database: %1").arg(importTask.errorString()) << endl;
+        return EXIT_FAILURE;
+    }
 
-    if (!db.import(xmlExportPath, &errorMessage)) {
-        err << QObject::tr("Unable to import XML database: %1").arg(errorMessage) << endl;
+    QString errorMessage;
+    db->setKdf(KeePass2::uuidToKdf(KeePass2::KDF_ARGON2));
+    db->setKey(key);
+    if (!applyCompressionOptions(*parser, db.data())) {
         return EXIT_FAILURE;
     }
 
-    if (!db.saveAs(dbPath, &errorMessage, true, false)) {
+    if (!db->saveAs(dbPath, &errorMessage, true, false)) {
         err << QObject::tr("Failed to save the database: %1.").arg(errorMessage) << endl;
         return EXIT_FAILURE;
     }
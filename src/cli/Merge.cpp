@@ -57,6 +57,7 @@ Merge::Merge()
     options.append(Merge::YubiKeyFromOption);
 #endif
     positionalArguments.append({QString("database2"), QObject::tr("Path of the database to merge from."), QString("")});
+    addCompressionOptions();
 }
 
 int Merge::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
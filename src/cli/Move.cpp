@@ -32,6 +32,7 @@ Move::Move()
     description = QObject::tr("Moves an entry to a new group.");
     positionalArguments.append({QString("entry"), QObject::tr("Path of the entry to move."), QString("")});
     positionalArguments.append({QString("group"), QObject::tr("Path of the destination group."), QString("")});
+    addCompressionOptions();
 }
 
 Move::~Move()
@@ -33,6 +33,7 @@ Remove::Remove()
     name = QString("rm");
     description = QString("Remove an entry from the database.");
     positionalArguments.append({QString("entry"), QObject::tr("Path of the entry to remove."), QString("")});
+    addCompressionOptions();
 }
 
 int Remove::executeWithDatabase(QSharedPointer<Database> database, QSharedPointer<QCommandLineParser> parser)
@@ -19,10 +19,17 @@
 #include "CsvParser.h"
 
 #include <QObject>
+#include <QScopedPointer>
 #include <QTextCodec>
 
 #include "core/Tools.h"
 
+namespace
+{
+    // Input is read and decoded in blocks of this size when streaming
+    const qint64 StreamChunkSize = 64 * 1024;
+} // namespace
+
 CsvParser::CsvParser()
     : m_ch(0)
     , m_comment('#')
@@ -32,8 +39,10 @@ CsvParser::CsvParser()
     , m_isEof(false)
     , m_isFileLoaded(false)
     , m_isGood(true)
+    , m_fileSize(0)
     , m_lastPos(-1)
     , m_maxCols(0)
+    , m_rowCount(0)
     , m_qualifier('"')
     , m_separator(',')
     , m_statusMsg("")
@@ -73,6 +82,233 @@ bool CsvParser::parse(QFile* device)
     return parseFile();
 }
 
+bool CsvParser::parse(QIODevice* device, const CsvRowCallback& callback)
+{
+    // The table and a loaded file are left alone so a preview can stay
+    // visible while the same file is streamed again for the import
+    m_currCol = 1;
+    m_currRow = 1;
+    m_isGood = true;
+    m_fileSize = 0;
+    m_maxCols = 0;
+    m_rowCount = 0;
+    m_statusMsg = "";
+
+    if (nullptr == device) {
+        appendStatusMsg(QObject::tr("NULL device"), true);
+        return false;
+    }
+    if (!device->isOpen() && !device->open(QIODevice::ReadOnly)) {
+        appendStatusMsg(QObject::tr("error reading from device"), true);
+        return false;
+    }
+
+    QTextCodec* codec = m_ts.codec() ? m_ts.codec() : QTextCodec::codecForName("UTF-8");
+    QScopedPointer<QTextDecoder> decoder(codec->makeDecoder());
+    QByteArray chunk;
+    QString text;
+    CsvRow row;
+    QString error;
+    bool atEnd = false;
+    while (!atEnd) {
+        chunk.resize(StreamChunkSize);
+        const qint64 bytesRead = device->read(chunk.data(), chunk.size());
+        if (bytesRead < 0) {
+            appendStatusMsg(QObject::tr("error reading from device"), true);
+            return false;
+        }
+        chunk.resize(static_cast<int>(bytesRead));
+        m_fileSize += bytesRead;
+        atEnd = bytesRead == 0 || device->atEnd();
+        text.append(decoder->toUnicode(chunk));
+
+        // Consume all complete rows, a row cut off at the end of the block
+        // is parsed again once the next block has been appended
+        int pos = 0;
+        while (pos < text.size()) {
+            row.clear();
+            error.clear();
+            const int next = parseRow(text, pos, atEnd, row, error);
+            if (next < 0) {
+                break;
+            }
+            pos = next;
+            if (!error.isEmpty()) {
+                appendStatusMsg(error, true);
+            }
+            ++m_currRow;
+            if (isEmptyRow(row)) {
+                continue;
+            }
+            ++m_rowCount;
+            m_maxCols = qMax(m_maxCols, row.size());
+            if (!callback(row)) {
+                return m_isGood;
+            }
+        }
+        text.remove(0, pos);
+    }
+
+    if (0 == m_fileSize) {
+        appendStatusMsg(QObject::tr("file empty").append("\n"));
+    }
+    return m_isGood;
+}
+
+/**
+ * Parse the record starting at pos, including its line terminator.
+ *
+ * @return position after the record or -1 if more input is needed
+ */
+int CsvParser::parseRow(const QString& text, int pos, bool atEnd, CsvRow& row, QString& error)
+{
+    const QChar* data = text.constData();
+    const int size = text.size();
+    const ushort separator = m_separator.unicode();
+
+    // Skip comment lines as a whole
+    int i = pos;
+    while (i < size && (isSpace(data[i]) || isTab(data[i]))) {
+        ++i;
+    }
+    if (i == size && !atEnd) {
+        return -1;
+    }
+    if (i < size && data[i] == m_comment) {
+        while (i < size && !isCRLF(data[i]) && data[i] != '\r') {
+            ++i;
+        }
+        if (i == size) {
+            return atEnd ? size : -1;
+        }
+        return skipLineEnd(text, i, atEnd);
+    }
+
+    while (true) {
+        QString field;
+        bool quoted = false;
+        if (pos < size && data[pos] == m_qualifier) {
+            bool closed;
+            pos = parseQuotedField(text, pos + 1, atEnd, field, closed);
+            if (pos < 0) {
+                return -1;
+            }
+            if (!closed && error.isEmpty()) {
+                error = QObject::tr("missing closing quote");
+                m_currCol = row.size() + 1;
+            }
+            quoted = true;
+        }
+
+        // Unquoted text runs up to the next separator or line end
+        int end = pos;
+        while (end < size) {
+            const ushort c = data[end].unicode();
+            if (c == separator || c == '\n' || c == '\r') {
+                break;
+            }
+            ++end;
+        }
+        if (end == size && !atEnd) {
+            return -1;
+        }
+        if (end > pos) {
+            if (quoted && error.isEmpty()) {
+                error = QObject::tr("malformed string");
+                m_currCol = row.size() + 1;
+            }
+            field.append(data + pos, end - pos);
+        }
+        row.append(field);
+
+        pos = end;
+        if (pos == size) {
+            return size;
+        }
+        if (!isSeparator(data[pos])) {
+            return skipLineEnd(text, pos, atEnd);
+        }
+        ++pos;
+    }
+}
+
+/**
+ * Parse the contents of a quoted field starting after the opening qualifier.
+ *
+ * @return position after the closing qualifier or -1 if more input is needed
+ */
+int CsvParser::parseQuotedField(const QString& text, int pos, bool atEnd, QString& field, bool& closed) const
+{
+    const QChar* data = text.constData();
+    const int size = text.size();
+    int start = pos;
+    closed = false;
+
+    while (pos < size) {
+        const QChar c = data[pos];
+        if (m_isBackslashSyntax && c == '\\') {
+            // escape-character syntax, e.g. \"
+            if (pos + 1 == size) {
+                if (!atEnd) {
+                    return -1;
+                }
+                field.append(data + start, size - start);
+                return size;
+            }
+            field.append(data + start, pos - start);
+            field.append(data[pos + 1]);
+            pos += 2;
+            start = pos;
+        } else if (c == m_qualifier) {
+            // double quote syntax, e.g. ""
+            if (!m_isBackslashSyntax) {
+                if (pos + 1 == size && !atEnd) {
+                    return -1;
+                }
+                if (pos + 1 < size && data[pos + 1] == m_qualifier) {
+                    field.append(data + start, pos + 1 - start);
+                    pos += 2;
+                    start = pos;
+                    continue;
+                }
+            }
+            field.append(data + start, pos - start);
+            closed = true;
+            return pos + 1;
+        } else if (c == '\r') {
+            // Line breaks in quoted text are normalized like in the buffered parser
+            if (pos + 1 == size && !atEnd) {
+                return -1;
+            }
+            field.append(data + start, pos - start);
+            field.append('\n');
+            pos += (pos + 1 < size && data[pos + 1] == '\n') ? 2 : 1;
+            start = pos;
+        } else {
+            ++pos;
+        }
+    }
+
+    if (!atEnd) {
+        return -1;
+    }
+    field.append(data + start, size - start);
+    return size;
+}
+
+int CsvParser::skipLineEnd(const QString& text, int pos, bool atEnd) const
+{
+    if (text.at(pos) == '\r') {
+        if (pos + 1 == text.size()) {
+            return atEnd ? pos + 1 : -1;
+        }
+        if (text.at(pos + 1) == '\n') {
+            return pos + 2;
+        }
+    }
+    return pos + 1;
+}
+
 bool CsvParser::readFile(QFile* device)
 {
     if (device->isOpen()) {
@@ -88,6 +324,7 @@ bool CsvParser::readFile(QFile* device)
 
         m_array.replace("\r\n", "\n");
         m_array.replace("\r", "\n");
+        m_fileSize = m_array.size();
         if (0 == m_array.size()) {
             appendStatusMsg(QObject::tr("file empty").append("\n"));
         }
@@ -105,6 +342,7 @@ void CsvParser::reset()
     m_isGood = true;
     m_lastPos = -1;
     m_maxCols = 0;
+    m_rowCount = 0;
     m_statusMsg = "";
     m_ts.seek(0);
     m_table.clear();
@@ -120,6 +358,7 @@ void CsvParser::clear()
 {
     reset();
     m_isFileLoaded = false;
+    m_fileSize = 0;
     m_array.clear();
 }
 
@@ -135,6 +374,7 @@ bool CsvParser::parseFile()
         parseRecord();
     }
     fillColumns();
+    m_rowCount = m_table.size();
     return m_isGood;
 }
 
@@ -383,6 +623,16 @@ void CsvParser::setBackslashSyntax(bool set)
     m_isBackslashSyntax = set;
 }
 
+// use the same codec, separator, qualifier, comment and escape syntax as other
+void CsvParser::copyOptions(const CsvParser& other)
+{
+    m_comment = other.m_comment;
+    m_isBackslashSyntax = other.m_isBackslashSyntax;
+    m_qualifier = other.m_qualifier;
+    m_separator = other.m_separator;
+    m_ts.setCodec(other.m_ts.codec());
+}
+
 void CsvParser::setComment(const QChar& c)
 {
     m_comment = c.unicode();
@@ -405,7 +655,7 @@ void CsvParser::setTextQualifier(const QChar& c)
 
 int CsvParser::getFileSize() const
 {
-    return m_csv.size();
+    return static_cast<int>(m_fileSize);
 }
 
 const CsvTable CsvParser::getCsvTable() const
@@ -429,7 +679,7 @@ int CsvParser::getCsvCols() const
 
 int CsvParser::getCsvRows() const
 {
-    return m_table.size();
+    return m_rowCount;
 }
 
 void CsvParser::appendStatusMsg(const QString& s, bool isCritical)
@@ -24,8 +24,12 @@
 #include <QQueue>
 #include <QTextStream>
 
+#include <functional>
+
 typedef QStringList CsvRow;
 typedef QList<CsvRow> CsvTable;
+// return false to stop parsing
+typedef std::function<bool(const CsvRow&)> CsvRowCallback;
 
 class CsvParser
 {
@@ -35,6 +39,9 @@ public:
     ~CsvParser();
     // read data from device and parse it
     bool parse(QFile* device);
+    // read data from device in chunks and pass each row to callback,
+    // rows are not stored in the table and short rows are not filled up
+    bool parse(QIODevice* device, const CsvRowCallback& callback);
     bool isFileLoaded();
     // reparse the same buffer (device is not opened again)
     bool reparse();
@@ -43,6 +50,7 @@ public:
     void setFieldSeparator(const QChar& c);
     void setTextQualifier(const QChar& c);
     void setBackslashSyntax(bool set);
+    void copyOptions(const CsvParser& other);
     int getFileSize() const;
     int getCsvRows() const;
     int getCsvCols() const;
@@ -52,6 +60,8 @@ public:
 protected:
     CsvTable m_table;
 
+    void fillColumns();
+
 private:
     QByteArray m_array;
     QBuffer m_csv;
@@ -63,8 +73,10 @@ private:
     bool m_isEof;
     bool m_isFileLoaded;
     bool m_isGood;
+    qint64 m_fileSize;
     qint64 m_lastPos;
     int m_maxCols;
+    int m_rowCount;
     QChar m_qualifier;
     QChar m_separator;
     QString m_statusMsg;
@@ -73,7 +85,6 @@ private:
     void getChar(QChar& c);
     void ungetChar();
     void peek(QChar& c);
-    void fillColumns();
     bool isTerminator(const QChar& c) const;
     bool isSeparator(const QChar& c) const;
     bool isQualifier(const QChar& c) const;
@@ -91,6 +102,9 @@ private:
     void parseQuoted(QString& s);
     void parseEscaped(QString& s);
     void parseEscapedText(QString& s);
+    int parseRow(const QString& text, int pos, bool atEnd, CsvRow& row, QString& error);
+    int parseQuotedField(const QString& text, int pos, bool atEnd, QString& field, bool& closed) const;
+    int skipLineEnd(const QString& text, int pos, bool atEnd) const;
     bool readFile(QFile* device);
     void reset();
     void clear();
@@ -24,11 +24,13 @@
 #include "core/Group.h"
 #include "core/Merger.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
+#include "streams/MappedFileBuffer.h"
 
 #include <QFile>
 #include <QFileInfo>
@@ -38,11 +40,14 @@
 #include <QXmlStreamReader>
 
 QHash<QUuid, QPointer<Database>> Database::s_uuidMap;
+// Databases are also created on worker threads while importing
+QMutex Database::s_uuidMapMutex;
 
 Database::Database()
     : m_metadata(new Metadata(this))
     , m_data()
     , m_rootGroup(nullptr)
+    , m_modifiedTimer(this)
     , m_fileWatcher(new FileWatcher(this))
     , m_emitModified(false)
     , m_uuid(QUuid::createUuid())
@@ -52,7 +57,10 @@ Database::Database()
     rootGroup()->setName(tr("Passwords", "Root group name"));
     m_modifiedTimer.setSingleShot(true);
 
-    s_uuidMap.insert(m_uuid, this);
+    {
+        QMutexLocker uuidMapLocker(&s_uuidMapMutex);
+        s_uuidMap.insert(m_uuid, this);
+    }
 
     connect(m_metadata, SIGNAL(metadataModified()), SLOT(markAsModified()));
     connect(&m_modifiedTimer, SIGNAL(timeout()), SIGNAL(databaseModified()));
@@ -112,6 +120,7 @@ bool Database::open(QSharedPointer<const CompositeKey> key, QString* error, bool
  */
 bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey> key, QString* error, bool readOnly)
 {
+    TRACE_SCOPE("database", "open");
     QFile dbFile(filePath);
     if (!dbFile.exists()) {
         if (error) {
@@ -136,8 +145,12 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
 
     setEmitModified(false);
 
+    // read through a memory mapping if possible
+    MappedFileBuffer mappedFile;
+    QIODevice* device = mappedFile.map(&dbFile) ? static_cast<QIODevice*>(&mappedFile) : &dbFile;
+
     KeePass2Reader reader;
-    if (!reader.readDatabase(&dbFile, std::move(key), this)) {
+    if (!reader.readDatabase(device, std::move(key), this)) {
         if (error) {
             *error = tr("Error while reading the database: %1").arg(reader.errorString());
         }
@@ -146,6 +159,7 @@ bool Database::open(const QString& filePath, QSharedPointer<const CompositeKey>
 
     setReadOnly(readOnly);
     setFilePath(filePath);
+    mappedFile.unmap();
     dbFile.close();
 
     markAsClean();
@@ -177,6 +191,7 @@ bool Database::isSaving()
  */
 bool Database::save(QString* error, bool atomic, bool backup)
 {
+    TRACE_SCOPE("database", "save");
     Q_ASSERT(!m_data.filePath.isEmpty());
     if (m_data.filePath.isEmpty()) {
         if (error) {
@@ -341,6 +356,7 @@ bool Database::performSave(const QString& filePath, QString* error, bool atomic,
 
 bool Database::writeDatabase(QIODevice* device, QString* error)
 {
+    TRACE_SCOPE("database", "writeDatabase");
     Q_ASSERT(!m_data.isReadOnly);
     if (m_data.isReadOnly) {
         if (error) {
@@ -393,6 +409,30 @@ bool Database::extract(QByteArray& xmlOutput, QString* error)
     return true;
 }
 
+/**
+ * Write the unencrypted XML representation of the database to a device.
+ *
+ * Unlike the QByteArray overload, the document is never held in memory as
+ * a whole, which keeps exports of large databases bounded in size.
+ *
+ * @param device output device, opened for writing
+ * @param error error message in case of failure
+ * @return true on success
+ */
+bool Database::extract(QIODevice* device, QString* error)
+{
+    TRACE_SCOPE("database", "extract");
+    KeePass2Writer writer;
+    if (!writer.extractDatabase(this, device)) {
+        if (error) {
+            *error = writer.errorString();
+        }
+        return false;
+    }
+
+    return true;
+}
+
 bool Database::import(const QString& xmlExportPath, QString* error)
 {
     KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
@@ -433,7 +473,10 @@ void Database::releaseData()
     m_modified = false;
     m_modifiedTimer.stop();
 
-    s_uuidMap.remove(m_uuid);
+    {
+        QMutexLocker uuidMapLocker(&s_uuidMapMutex);
+        s_uuidMap.remove(m_uuid);
+    }
     m_uuid = QUuid();
 
     m_data.clear();
@@ -704,6 +747,49 @@ void Database::setCompressionAlgorithm(Database::CompressionAlgorithm algo)
     m_data.compressionAlgorithm = algo;
 }
 
+/**
+ * @return zlib compression level used when saving, between 1 and 9
+ */
+int Database::compressionLevel() const
+{
+    return m_data.compressionLevel;
+}
+
+/**
+ * Set the zlib compression level used when saving. The level is not stored
+ * in the database file and only applies to saves from this instance.
+ *
+ * @param level compression level between 1 (fastest) and 9 (smallest)
+ */
+void Database::setCompressionLevel(int level)
+{
+    Q_ASSERT(level >= CompressionLevelFast && level <= CompressionLevelBest);
+
+    m_data.compressionLevel = qBound<int>(CompressionLevelFast, level, CompressionLevelBest);
+}
+
+/**
+ * @return size of the compression buffers in bytes
+ */
+int Database::compressionBufferSize() const
+{
+    return m_data.compressionBufferSize;
+}
+
+/**
+ * Set the size of the compression buffers used when saving. Larger buffers
+ * mean fewer, larger writes to the encryption layer and, with multiple
+ * threads, larger blocks that are compressed in parallel.
+ *
+ * @param size buffer size in bytes
+ */
+void Database::setCompressionBufferSize(int size)
+{
+    Q_ASSERT(size > 0);
+
+    m_data.compressionBufferSize = qMax(4096, size);
+}
+
 /**
  * Set and transform a new encryption key.
  *
@@ -889,6 +975,7 @@ void Database::markNonDataChange()
  */
 Database* Database::databaseByUuid(const QUuid& uuid)
 {
+    QMutexLocker locker(&s_uuidMapMutex);
     return s_uuidMap.value(uuid, nullptr);
 }
 
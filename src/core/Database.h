@@ -64,6 +64,18 @@ public:
     };
     static const quint32 CompressionAlgorithmMax = CompressionGZip;
 
+    /**
+     * zlib compression levels offered in the user interface,
+     * any level between 1 and 9 is accepted.
+     */
+    enum CompressionLevel
+    {
+        CompressionLevelFast = 1,
+        CompressionLevelDefault = 6,
+        CompressionLevelBest = 9
+    };
+    static const int DefaultCompressionBufferSize = 256 * 1024;
+
     Database();
     explicit Database(const QString& filePath);
     ~Database() override;
@@ -76,6 +88,7 @@ public:
     bool save(QString* error = nullptr, bool atomic = true, bool backup = false);
     bool saveAs(const QString& filePath, QString* error = nullptr, bool atomic = true, bool backup = false);
     bool extract(QByteArray&, QString* error = nullptr);
+    bool extract(QIODevice* device, QString* error = nullptr);
     bool import(const QString& xmlExportPath, QString* error = nullptr);
 
     void releaseData();
@@ -127,6 +140,10 @@ public:
     void setCipher(const QUuid& cipher);
     Database::CompressionAlgorithm compressionAlgorithm() const;
     void setCompressionAlgorithm(Database::CompressionAlgorithm algo);
+    int compressionLevel() const;
+    void setCompressionLevel(int level);
+    int compressionBufferSize() const;
+    void setCompressionBufferSize(int size);
 
     QSharedPointer<Kdf> kdf() const;
     void setKdf(QSharedPointer<Kdf> kdf);
@@ -163,6 +180,8 @@ private:
         bool isReadOnly = false;
         QUuid cipher = KeePass2::CIPHER_AES256;
         CompressionAlgorithm compressionAlgorithm = CompressionGZip;
+        int compressionLevel = CompressionLevelDefault;
+        int compressionBufferSize = DefaultCompressionBufferSize;
 
         QScopedPointer<PasswordKey> masterSeed;
         QScopedPointer<PasswordKey> transformedDatabaseKey;
@@ -219,6 +238,7 @@ private:
 
     QUuid m_uuid;
     static QHash<QUuid, QPointer<Database>> s_uuidMap;
+    static QMutex s_uuidMapMutex;
 };
 
 #endif // KEEPASSX_DATABASE_H
@@ -24,6 +24,7 @@
 #include "core/DatabaseIcons.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/PasswordHealth.h"
 #include "core/Tools.h"
 #include "totp/totp.h"
 
@@ -596,7 +597,11 @@ void Entry::setUsername(const QString& username)
 
 void Entry::setPassword(const QString& password)
 {
+    const QString oldPassword = m_attributes->value(EntryAttributes::PasswordKey);
     m_attributes->set(EntryAttributes::PasswordKey, password, m_attributes->isProtected(EntryAttributes::PasswordKey));
+    if (!oldPassword.isEmpty() && oldPassword != password) {
+        PasswordHealth::removeFromEntropyCache(oldPassword);
+    }
 }
 
 void Entry::setNotes(const QString& notes)
@@ -1121,7 +1126,8 @@ void Entry::setGroup(Group* group)
             // copy custom icon to the new database
             if (!iconUuid().isNull() && group->database() && m_group->database()->metadata()->hasCustomIcon(iconUuid())
                 && !group->database()->metadata()->hasCustomIcon(iconUuid())) {
-                group->database()->metadata()->addCustomIcon(iconUuid(), icon());
+                group->database()->metadata()->addCustomIcon(
+                    iconUuid(), m_group->database()->metadata()->customIconData(iconUuid()));
             }
         }
     }
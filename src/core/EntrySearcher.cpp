@@ -20,6 +20,7 @@
 
 #include "core/Group.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 
 EntrySearcher::EntrySearcher(bool caseSensitive, bool skipProtected)
     : m_caseSensitive(caseSensitive)
@@ -68,6 +69,7 @@ QList<Entry*> EntrySearcher::search(const QString& searchString, const Group* ba
  */
 QList<Entry*> EntrySearcher::repeat(const Group* baseGroup, bool forceSearch)
 {
+    TRACE_SCOPE("search", "search");
     Q_ASSERT(baseGroup);
 
     QList<Entry*> results;
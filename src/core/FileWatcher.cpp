@@ -27,6 +27,10 @@
 
 FileWatcher::FileWatcher(QObject* parent)
     : QObject(parent)
+    , m_fileWatcher(this)
+    , m_fileChangeDelayTimer(this)
+    , m_fileIgnoreDelayTimer(this)
+    , m_fileChecksumTimer(this)
 {
     connect(&m_fileWatcher, SIGNAL(fileChanged(QString)), SLOT(checkFileChanged()));
     connect(&m_fileChecksumTimer, SIGNAL(timeout()), SLOT(checkFileChanged()));
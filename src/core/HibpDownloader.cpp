@@ -39,31 +39,23 @@ namespace
     }
 
     /*
-     * Search a password's hash in the output of the HIBP web service.
+     * Parse the output of the HIBP web service for one hash prefix.
      *
-     * Returns the number of times the password is found in breaches, or
-     * 0 if the password is not in the HIBP result.
+     * Returns the number of times each hash suffix has been found in
+     * breaches. The suffixes are the remaining 35 characters of the hash.
      */
-    int pwnCount(const QString& password, const QString& hibpResult)
+    QHash<QString, int> parseRange(const QByteArray& hibpResult)
     {
-        // The first 5 characters of the hash are in the URL already,
-        // the HIBP result contains the remainder
-        auto pos = hibpResult.indexOf(sha1Hex(password).mid(5));
-        if (pos < 0) {
-            return 0;
+        QHash<QString, int> counts;
+        for (const auto& line : hibpResult.split('\n')) {
+            const auto colon = line.indexOf(':');
+            if (colon < 0) {
+                continue;
+            }
+            const auto suffix = QString::fromLatin1(line.left(colon).trimmed()).toUpper();
+            counts.insert(suffix, line.mid(colon + 1).trimmed().toInt());
         }
-
-        // Skip past the sha1 and ':'
-        pos += 36;
-
-        // Find where the count ends
-        auto end = hibpResult.indexOf('\n', pos);
-        if (end < 0) {
-            end = hibpResult.size();
-        }
-
-        // Extract the count, remove remaining whitespace, and convert to int
-        return hibpResult.midRef(pos, end - pos).trimmed().toInt();
+        return counts;
     }
 } // namespace
 
@@ -85,8 +77,10 @@ HibpDownloader::~HibpDownloader()
  */
 void HibpDownloader::add(const QString& password)
 {
-    if (!m_pwdsToTry.contains(password)) {
-        m_pwdsToTry << password;
+    auto& passwords = m_pwdsToTry[sha1Hex(password).left(5)];
+    if (!passwords.contains(password)) {
+        passwords << password;
+        ++m_pwdsToTryCount;
     }
 }
 
@@ -95,11 +89,39 @@ void HibpDownloader::add(const QString& password)
  */
 void HibpDownloader::validate()
 {
-    for (auto password : m_pwdsToTry) {
+    for (auto it = m_pwdsToTry.constBegin(); it != m_pwdsToTry.constEnd(); ++it) {
+        // A prefix that is already pending is answered by the request for it
+        if (!m_pending.contains(it.key())) {
+            m_queue << it.key();
+        }
+
+        auto& passwords = m_pending[it.key()];
+        for (const auto& password : it.value()) {
+            if (!passwords.contains(password)) {
+                passwords << password;
+                ++m_pendingCount;
+            }
+        }
+    }
+
+    m_pwdsToTry.clear();
+    m_pwdsToTryCount = 0;
+    fetchNextPrefixes();
+}
+
+/*
+ * Start the requests for the queued hash prefixes, up to
+ * MAX_CONCURRENT_REQUESTS at a time.
+ */
+void HibpDownloader::fetchNextPrefixes()
+{
+    while (m_replies.size() < MAX_CONCURRENT_REQUESTS && !m_queue.isEmpty()) {
+        const auto prefix = m_queue.takeFirst();
+
         // The URL we query is https://api.pwnedpasswords.com/range/XXXXX,
         // where XXXXX is the first five bytes of the hex representation of
         // the password's SHA1.
-        const auto url = QString("https://api.pwnedpasswords.com/range/") + sha1Hex(password).left(5);
+        const auto url = QString("https://api.pwnedpasswords.com/range/") + prefix;
 
         // HIBP requires clients to specify a user agent in the request
         // (https://haveibeenpwned.com/API/v3#UserAgent); however, in order
@@ -112,20 +134,18 @@ void HibpDownloader::validate()
         auto reply = getNetMgr()->get(request);
         connect(reply, &QNetworkReply::finished, this, &HibpDownloader::fetchFinished);
         connect(reply, &QIODevice::readyRead, this, &HibpDownloader::fetchReadyRead);
-        m_replies.insert(reply, {password, {}});
+        m_replies.insert(reply, {prefix, {}});
     }
-
-    m_pwdsToTry.clear();
 }
 
 int HibpDownloader::passwordsToValidate() const
 {
-    return m_pwdsToTry.size();
+    return m_pwdsToTryCount;
 }
 
 int HibpDownloader::passwordsRemaining() const
 {
-    return m_replies.size();
+    return m_pendingCount;
 }
 
 /*
@@ -134,10 +154,14 @@ int HibpDownloader::passwordsRemaining() const
 void HibpDownloader::abort()
 {
     for (auto reply : m_replies.keys()) {
+        reply->disconnect(this);
         reply->abort();
         reply->deleteLater();
     }
     m_replies.clear();
+    m_queue.clear();
+    m_pending.clear();
+    m_pendingCount = 0;
 }
 
 /*
@@ -167,8 +191,8 @@ void HibpDownloader::fetchFinished()
     const auto ok = reply->error() == QNetworkReply::NoError;
     const auto err = reply->errorString();
 
-    const auto password = entry->first;
-    const auto hibpReply = entry->second;
+    const auto prefix = entry->first;
+    const auto hibpReply = entry->second + reply->readAll();
 
     reply->deleteLater();
     m_replies.remove(reply);
@@ -185,6 +209,14 @@ void HibpDownloader::fetchFinished()
         return;
     }
 
-    // Current password validated, send the result to the caller
-    emit hibpResult(password, pwnCount(password, hibpReply));
+    // Keep the other requests going while the results are processed
+    const auto passwords = m_pending.take(prefix);
+    fetchNextPrefixes();
+
+    // Passwords of the current prefix validated, send the results to the caller
+    const auto counts = parseRange(hibpReply);
+    for (const auto& password : passwords) {
+        --m_pendingCount;
+        emit hibpResult(password, counts.value(sha1Hex(password).mid(5)));
+    }
 }
@@ -21,6 +21,7 @@
 #include "config-keepassx.h"
 #include <QHash>
 #include <QObject>
+#include <QStringList>
 #include <QTimer>
 
 #ifndef WITH_XC_NETWORKING
@@ -34,15 +35,20 @@ class QNetworkReply;
  * "Have I Been Pwned" website (https://haveibeenpwned.com/)
  * in the background.
  *
- * Usage: Pass the password to check to the ctor and process
- * the `finished` signal to get the result. Process the
- * `failed` signal to handle errors.
+ * Usage: Add the passwords to check, call validate() and process
+ * the `hibpResult` signal to get the results. Process the
+ * `fetchFailed` signal to handle errors.
+ *
+ * Passwords whose SHA1 hashes start with the same five hex digits
+ * share one request, and only a few requests run at the same time.
  */
 class HibpDownloader : public QObject
 {
     Q_OBJECT
 
 public:
+    static const int MAX_CONCURRENT_REQUESTS = 4;
+
     explicit HibpDownloader(QObject* parent = nullptr);
     ~HibpDownloader() override;
 
@@ -63,9 +69,16 @@ private slots:
     void fetchReadyRead();
 
 private:
-    void fetchPassword(const QString& password);
+    void fetchNextPrefixes();
 
-    QStringList m_pwdsToTry; // The list of remaining passwords to validate
+    // Passwords added since the last validate(), by hash prefix
+    QHash<QString, QStringList> m_pwdsToTry;
+    int m_pwdsToTryCount = 0;
+    // Passwords being validated, by hash prefix, and the prefixes still to be fetched
+    QHash<QString, QStringList> m_pending;
+    int m_pendingCount = 0;
+    QStringList m_queue;
+    // The running requests, with the prefix and the data received so far
     QHash<QNetworkReply*, QPair<QString, QByteArray>> m_replies;
 };
 
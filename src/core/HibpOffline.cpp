@@ -17,87 +17,259 @@
 
 #include "HibpOffline.h"
 
+#include <QBitArray>
 #include <QCryptographicHash>
+#include <QFile>
 #include <QMultiHash>
-#include <QProcess>
+#include <QVector>
+#include <QtEndian>
 
 #include "core/Database.h"
 #include "core/Group.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <limits>
+
 namespace HibpOffline
 {
     const std::size_t SHA1_BYTES = 20;
+    const int SORTED_CHECK_LINES = 64;
 
-    enum class ParseResult
-    {
-        Ok,
-        Eof,
-        Error
-    };
+    /*
+     * Layout of the binary index, all integers are little endian:
+     *   header  magic "KPXCHIBP", quint32 version, quint32 number of records
+     *   table   quint32 index of the first record for each of the 2^16 leading hash bytes, plus the record count
+     *   records the remaining 18 bytes of each hash followed by its quint32 count, ordered by hash
+     */
+    const char INDEX_MAGIC[] = "KPXCHIBP";
+    const int INDEX_MAGIC_BYTES = 8;
+    const quint32 INDEX_VERSION = 1;
+    const int INDEX_HEADER_BYTES = INDEX_MAGIC_BYTES + 4 + 4;
+    const int INDEX_BUCKETS = 1 << 16;
+    const int INDEX_TABLE_BYTES = (INDEX_BUCKETS + 1) * 4;
+    const int INDEX_HASH_BYTES = SHA1_BYTES - 2;
+    const int INDEX_RECORD_BYTES = INDEX_HASH_BYTES + 4;
+    const int INDEX_WRITE_RECORDS = 64 * 1024;
+
+    const qint64 SCAN_CHUNK_BYTES = 4 * 1024 * 1024;
+    const qint64 SCAN_MAX_LINE_BYTES = 1024;
 
-    ParseResult parseHibpLine(QIODevice& input, QByteArray& sha1, int& count)
+    std::array<qint8, 256> makeHexDigits()
     {
-        QByteArray hexSha1(SHA1_BYTES * 2, '\0');
-        const qint64 rc = input.read(hexSha1.data(), hexSha1.size());
-        if (rc == 0) {
-            return ParseResult::Eof;
-        } else if (rc != hexSha1.size()) {
-            return ParseResult::Error;
+        std::array<qint8, 256> digits;
+        digits.fill(-1);
+        for (int i = 0; i < 10; ++i) {
+            digits['0' + i] = static_cast<qint8>(i);
         }
+        for (int i = 0; i < 6; ++i) {
+            digits['A' + i] = static_cast<qint8>(10 + i);
+            digits['a' + i] = static_cast<qint8>(10 + i);
+        }
+        return digits;
+    }
 
-        sha1 = QByteArray::fromHex(hexSha1);
+    const std::array<qint8, 256> HEX_DIGITS = makeHexDigits();
 
-        char c;
-        if (!input.getChar(&c) || c != ':') {
-            return ParseResult::Error;
+    int hexDigit(char c)
+    {
+        return HEX_DIGITS[static_cast<uchar>(c)];
+    }
+
+    /**
+     * Parse the line starting at offset pos of a memory mapped HIBP file.
+     *
+     * @param next set to the start of the following line
+     * @return false if the line is malformed
+     */
+    bool parseMappedLine(const char* data, qint64 size, qint64 pos, QByteArray& sha1, int& count, qint64& next)
+    {
+        const qint64 hexSize = SHA1_BYTES * 2;
+        if (size - pos < hexSize + 2 || data[pos + hexSize] != ':') {
+            return false;
+        }
+
+        sha1.resize(SHA1_BYTES);
+        for (std::size_t i = 0; i < SHA1_BYTES; ++i) {
+            const int high = hexDigit(data[pos + i * 2]);
+            const int low = hexDigit(data[pos + i * 2 + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            sha1[static_cast<int>(i)] = static_cast<char>((high << 4) | low);
         }
 
         count = 0;
-        while (true) {
-            if (!input.getChar(&c)) {
-                return ParseResult::Error;
+        for (next = pos + hexSize + 1; next < size && '0' <= data[next] && data[next] <= '9'; ++next) {
+            count = count * 10 + (data[next] - '0');
+        }
+        if (next == pos + hexSize + 1 || (next < size && data[next] != '\n' && data[next] != '\r')) {
+            return false;
+        }
+        while (next < size && (data[next] == '\n' || data[next] == '\r')) {
+            ++next;
+        }
+        return true;
+    }
+
+    /**
+     * Guess whether a mapped HIBP file is ordered by hash from its first lines.
+     * The files ordered by prevalence fail this check almost immediately.
+     */
+    bool isSortedByHash(const char* data, qint64 size)
+    {
+        QByteArray previous;
+        QByteArray sha1;
+        int count;
+        qint64 pos = 0;
+        for (int line = 0; line < SORTED_CHECK_LINES && pos < size; ++line) {
+            if (!parseMappedLine(data, size, pos, sha1, count, pos) || (!previous.isEmpty() && !(previous < sha1))) {
+                return false;
             }
+            previous = sha1;
+        }
+        return true;
+    }
 
-            if (c == '\n' || c == '\r') {
-                break;
+    enum class SearchResult
+    {
+        Found,
+        NotFound,
+        Error
+    };
+
+    /**
+     * Binary search a mapped HIBP file that is ordered by hash. Every probe is moved back to the
+     * start of its line, and has to lie between the hashes seen so far or the file is not sorted.
+     */
+    SearchResult searchSorted(const char* data, qint64 size, const QByteArray& sha1, int& count, QString* error)
+    {
+        qint64 low = 0;
+        qint64 high = size;
+        QByteArray lowSha1;
+        QByteArray highSha1;
+        QByteArray lineSha1;
+        while (low < high) {
+            qint64 lineStart = low + (high - low) / 2;
+            while (lineStart > low && data[lineStart - 1] != '\n') {
+                --lineStart;
             }
 
-            if (!('0' <= c && c <= '9')) {
-                return ParseResult::Error;
+            qint64 lineEnd;
+            if (!parseMappedLine(data, size, lineStart, lineSha1, count, lineEnd)) {
+                *error = QObject::tr("HIBP file, byte %1: parse error").arg(lineStart);
+                return SearchResult::Error;
+            }
+            if ((!lowSha1.isEmpty() && !(lowSha1 < lineSha1)) || (!highSha1.isEmpty() && !(lineSha1 < highSha1))) {
+                *error = QObject::tr("HIBP file is not sorted by hash");
+                return SearchResult::Error;
             }
 
-            count *= 10;
-            count += (c - '0');
+            if (lineSha1 == sha1) {
+                return SearchResult::Found;
+            } else if (lineSha1 < sha1) {
+                low = lineEnd;
+                lowSha1 = lineSha1;
+            } else {
+                high = lineStart;
+                highSha1 = lineSha1;
+            }
         }
+        return SearchResult::NotFound;
+    }
 
-        while (1 == input.peek(&c, 1) && (c == '\n' || c == '\r')) {
-            input.getChar(&c);
+    int indexBucket(const QByteArray& sha1)
+    {
+        return (static_cast<uchar>(sha1.at(0)) << 8) | static_cast<uchar>(sha1.at(1));
+    }
+
+    bool isIndex(const char* data, qint64 size)
+    {
+        return size >= INDEX_HEADER_BYTES && memcmp(data, INDEX_MAGIC, INDEX_MAGIC_BYTES) == 0;
+    }
+
+    /**
+     * Check the version, size and bucket table of a mapped HIBP index,
+     * so that searchIndex() never reads past the mapped records.
+     */
+    bool checkIndex(const char* data, qint64 size, QString* error)
+    {
+        const auto header = reinterpret_cast<const uchar*>(data) + INDEX_MAGIC_BYTES;
+        if (qFromLittleEndian<quint32>(header) != INDEX_VERSION) {
+            *error = QObject::tr("Unsupported HIBP index version");
+            return false;
+        }
+        const quint32 records = qFromLittleEndian<quint32>(header + 4);
+        if (size != INDEX_HEADER_BYTES + INDEX_TABLE_BYTES + static_cast<qint64>(records) * INDEX_RECORD_BYTES) {
+            *error = QObject::tr("HIBP index is corrupted");
+            return false;
         }
 
-        return ParseResult::Ok;
+        const auto table = reinterpret_cast<const uchar*>(data) + INDEX_HEADER_BYTES;
+        quint32 previous = 0;
+        for (int bucket = 0; bucket <= INDEX_BUCKETS; ++bucket) {
+            const quint32 first = qFromLittleEndian<quint32>(table + bucket * 4);
+            if (first < previous) {
+                *error = QObject::tr("HIBP index is corrupted");
+                return false;
+            }
+            previous = first;
+        }
+        if (previous != records) {
+            *error = QObject::tr("HIBP index is corrupted");
+            return false;
+        }
+        return true;
     }
 
-    bool
-    report(QSharedPointer<Database> db, QIODevice& hibpInput, QList<QPair<const Entry*, int>>& findings, QString* error)
+    SearchResult searchIndex(const char* data, const QByteArray& sha1, int& count, QString* error)
     {
-        QMultiHash<QByteArray, const Entry*> entriesBySha1;
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-            if (!entry->isRecycled()) {
-                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
-                entriesBySha1.insert(sha1, entry);
+        const auto table = reinterpret_cast<const uchar*>(data) + INDEX_HEADER_BYTES;
+        const auto records = data + INDEX_HEADER_BYTES + INDEX_TABLE_BYTES;
+        const int bucket = indexBucket(sha1);
+
+        quint32 low = qFromLittleEndian<quint32>(table + bucket * 4);
+        quint32 high = qFromLittleEndian<quint32>(table + (bucket + 1) * 4);
+        if (low > high || high > qFromLittleEndian<quint32>(table + INDEX_BUCKETS * 4)) {
+            *error = QObject::tr("HIBP index is corrupted");
+            return SearchResult::Error;
+        }
+
+        const char* suffix = sha1.constData() + 2;
+        while (low < high) {
+            const quint32 mid = low + (high - low) / 2;
+            const char* record = records + static_cast<qint64>(mid) * INDEX_RECORD_BYTES;
+            const int cmp = memcmp(record, suffix, INDEX_HASH_BYTES);
+            if (cmp == 0) {
+                count = static_cast<int>(qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(record)
+                                                                    + INDEX_HASH_BYTES));
+                return SearchResult::Found;
+            } else if (cmp < 0) {
+                low = mid + 1;
+            } else {
+                high = mid;
             }
         }
+        return SearchResult::NotFound;
+    }
 
-        QByteArray sha1;
-        for (quint64 lineNum = 1;; ++lineNum) {
-            int count = 0;
+    bool lookupReport(const QMultiHash<QByteArray, const Entry*>& entriesBySha1,
+                      const std::function<SearchResult(const QByteArray& sha1, int& count)>& lookup,
+                      QList<QPair<const Entry*, int>>& findings)
+    {
+        // Report in file order, like a full scan would
+        QList<QByteArray> hashes = entriesBySha1.uniqueKeys();
+        std::sort(hashes.begin(), hashes.end());
 
-            switch (parseHibpLine(hibpInput, sha1, count)) {
-            case ParseResult::Eof:
-                return true;
-            case ParseResult::Error:
-                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum);
+        for (const auto& sha1 : asConst(hashes)) {
+            int count = 0;
+            switch (lookup(sha1, count)) {
+            case SearchResult::Error:
                 return false;
+            case SearchResult::NotFound:
+                continue;
             default:
                 break;
             }
@@ -106,46 +278,224 @@ namespace HibpOffline
                 findings.append({entry, count});
             }
         }
+        return true;
     }
 
-    bool okonReport(QSharedPointer<Database> db,
-                    const QString& okon,
-                    const QString& okonDatabase,
+    /**
+     * Read the whole HIBP input in large chunks. Most lines are rejected by the first two bytes of
+     * their hash, only the remaining ones are looked up in the hash of the database entries.
+     */
+    bool scanReport(const QMultiHash<QByteArray, const Entry*>& entriesBySha1,
+                    QIODevice& hibpInput,
                     QList<QPair<const Entry*, int>>& findings,
-                    QString* error)
+                    QString* error,
+                    const ProgressCallback& progress)
     {
-        if (!okonDatabase.endsWith(".okon")) {
-            *error = QObject::tr("To use okon you must provide a post-processed file (e.g. file.okon)");
-            return false;
+        QBitArray prefixes(INDEX_BUCKETS);
+        for (auto it = entriesBySha1.constBegin(); it != entriesBySha1.constEnd(); ++it) {
+            prefixes.setBit(indexBucket(it.key()));
         }
 
-        QProcess okonProcess;
+        const qint64 total = hibpInput.isSequential() ? 0 : hibpInput.size();
+        qint64 processed = 0;
+        QByteArray buffer;
+        qint64 buffered = 0;
+        QByteArray sha1;
+        quint64 lineNum = 1;
+        bool atEnd = false;
+        while (!atEnd) {
+            buffer.resize(static_cast<int>(buffered + SCAN_CHUNK_BYTES));
+            const qint64 read = hibpInput.read(buffer.data() + buffered, SCAN_CHUNK_BYTES);
+            if (read < 0) {
+                *error = QObject::tr("Failed to read HIBP file: %1").arg(hibpInput.errorString());
+                return false;
+            }
+            atEnd = read == 0;
+            buffered += read;
 
-        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-            if (!entry->isRecycled()) {
-                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
-                okonProcess.start(okon, {"--path", okonDatabase, "--hash", QString::fromLatin1(sha1.toHex())});
-                if (!okonProcess.waitForStarted()) {
-                    *error = QObject::tr("Could not start okon process: %1").arg(okon);
-                    return false;
+            const char* data = buffer.constData();
+            qint64 pos = 0;
+            while (pos < buffered) {
+                if (data[pos] == '\n' || data[pos] == '\r') {
+                    ++pos;
+                    continue;
                 }
 
-                if (!okonProcess.waitForFinished()) {
-                    *error = QObject::tr("Error: okon process did not finish");
-                    return false;
+                // Only parse complete lines, the rest is kept for the next chunk
+                const auto newline = static_cast<const char*>(memchr(data + pos, '\n', buffered - pos));
+                if (!newline && !atEnd && buffered - pos <= SCAN_MAX_LINE_BYTES) {
+                    break;
                 }
+                const qint64 lineEnd = newline ? newline - data + 1 : buffered;
 
-                switch (okonProcess.exitCode()) {
-                case 1:
-                    findings.append({entry, -1});
-                    break;
-                case 2:
-                    *error = QObject::tr("Failed to load okon processed database: %1").arg(okonDatabase);
+                int count = 0;
+                qint64 next = 0;
+                if (!parseMappedLine(data, lineEnd, pos, sha1, count, next) || next != lineEnd) {
+                    *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum);
                     return false;
                 }
+                if (prefixes.testBit(indexBucket(sha1))) {
+                    for (const auto* entry : entriesBySha1.values(sha1)) {
+                        findings.append({entry, count});
+                    }
+                }
+                pos = next;
+                ++lineNum;
+            }
+
+            buffered -= pos;
+            memmove(buffer.data(), buffer.constData() + pos, static_cast<size_t>(buffered));
+            processed += pos;
+            if (progress) {
+                progress(processed, total);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Check the passwords of the database against a HIBP file.
+     *
+     * A file that can be memory mapped is searched for each password if it is an index written by
+     * buildIndex() or a text file ordered by hash, otherwise the whole input is read.
+     *
+     * @param progress called with the number of bytes read so far while the whole input is read
+     */
+    bool report(QSharedPointer<Database> db,
+                QIODevice& hibpInput,
+                QList<QPair<const Entry*, int>>& findings,
+                QString* error,
+                const ProgressCallback& progress)
+    {
+        QMultiHash<QByteArray, const Entry*> entriesBySha1;
+        for (const auto* entry : db->rootGroup()->entriesRecursive()) {
+            if (!entry->isRecycled()) {
+                const auto sha1 = QCryptographicHash::hash(entry->password().toUtf8(), QCryptographicHash::Sha1);
+                entriesBySha1.insert(sha1, entry);
+            }
+        }
+
+        auto hibpFile = qobject_cast<QFile*>(&hibpInput);
+        const qint64 size = hibpFile ? hibpFile->size() : 0;
+        uchar* mapping = size > 0 ? hibpFile->map(0, size) : nullptr;
+        if (mapping) {
+            const auto data = reinterpret_cast<const char*>(mapping);
+            bool result = false;
+            bool searched = true;
+            if (isIndex(data, size)) {
+                result = checkIndex(data, size, error)
+                         && lookupReport(
+                             entriesBySha1,
+                             [&](const QByteArray& sha1, int& count) { return searchIndex(data, sha1, count, error); },
+                             findings);
+            } else if (isSortedByHash(data, size)) {
+                result = lookupReport(
+                    entriesBySha1,
+                    [&](const QByteArray& sha1, int& count) { return searchSorted(data, size, sha1, count, error); },
+                    findings);
+            } else {
+                searched = false;
+            }
+            hibpFile->unmap(mapping);
+            if (searched) {
+                return result;
             }
         }
 
+        return scanReport(entriesBySha1, hibpInput, findings, error, progress);
+    }
+
+    /**
+     * Convert a HIBP text file ordered by hash into the binary index searched by report().
+     * The index is roughly half the size of the text file.
+     *
+     * @param indexOutput seekable device, the header is written last
+     */
+    bool buildIndex(QIODevice& hibpInput, QIODevice& indexOutput, QString* error)
+    {
+        if (!hibpInput.isReadable()) {
+            *error = QObject::tr("Failed to read HIBP file: %1").arg(hibpInput.errorString());
+            return false;
+        }
+        if (indexOutput.isSequential() || !indexOutput.seek(INDEX_HEADER_BYTES + INDEX_TABLE_BYTES)) {
+            *error = QObject::tr("Failed to write HIBP index: %1").arg(indexOutput.errorString());
+            return false;
+        }
+
+        QVector<quint32> bucketSizes(INDEX_BUCKETS, 0);
+        quint32 records = 0;
+        QByteArray pending;
+        pending.reserve(INDEX_WRITE_RECORDS * INDEX_RECORD_BYTES);
+        auto writePending = [&]() {
+            const bool ok = indexOutput.write(pending) == pending.size();
+            pending.clear();
+            if (!ok) {
+                *error = QObject::tr("Failed to write HIBP index: %1").arg(indexOutput.errorString());
+            }
+            return ok;
+        };
+
+        char line[256];
+        QByteArray sha1;
+        QByteArray previous;
+        for (quint64 lineNum = 1; !hibpInput.atEnd(); ++lineNum) {
+            const qint64 length = hibpInput.readLine(line, sizeof(line));
+            if (length < 0) {
+                *error = QObject::tr("Failed to read HIBP file: %1").arg(hibpInput.errorString());
+                return false;
+            }
+            if (length == 0 || line[0] == '\n' || line[0] == '\r') {
+                continue;
+            }
+
+            int count = 0;
+            qint64 next = 0;
+            if (!parseMappedLine(line, length, 0, sha1, count, next) || next != length) {
+                *error = QObject::tr("HIBP file, line %1: parse error").arg(lineNum);
+                return false;
+            }
+            if (!previous.isEmpty() && !(previous < sha1)) {
+                *error = QObject::tr("HIBP file, line %1: only files ordered by hash can be indexed").arg(lineNum);
+                return false;
+            }
+            if (records == std::numeric_limits<quint32>::max()) {
+                *error = QObject::tr("HIBP file has too many hashes to be indexed");
+                return false;
+            }
+            previous = sha1;
+
+            uchar countBytes[4];
+            qToLittleEndian<quint32>(static_cast<quint32>(count), countBytes);
+            pending.append(sha1.constData() + 2, INDEX_HASH_BYTES);
+            pending.append(reinterpret_cast<const char*>(countBytes), sizeof(countBytes));
+            ++bucketSizes[indexBucket(sha1)];
+            ++records;
+
+            if (pending.size() >= INDEX_WRITE_RECORDS * INDEX_RECORD_BYTES && !writePending()) {
+                return false;
+            }
+        }
+        if (!writePending()) {
+            return false;
+        }
+
+        QByteArray header(INDEX_MAGIC, INDEX_MAGIC_BYTES);
+        header.resize(INDEX_HEADER_BYTES + INDEX_TABLE_BYTES);
+        auto headerData = reinterpret_cast<uchar*>(header.data());
+        qToLittleEndian<quint32>(INDEX_VERSION, headerData + INDEX_MAGIC_BYTES);
+        qToLittleEndian<quint32>(records, headerData + INDEX_MAGIC_BYTES + 4);
+        quint32 first = 0;
+        for (int bucket = 0; bucket <= INDEX_BUCKETS; ++bucket) {
+            qToLittleEndian<quint32>(first, headerData + INDEX_HEADER_BYTES + bucket * 4);
+            if (bucket < INDEX_BUCKETS) {
+                first += bucketSizes.at(bucket);
+            }
+        }
+
+        if (!indexOutput.seek(0) || indexOutput.write(header) != header.size()) {
+            *error = QObject::tr("Failed to write HIBP index: %1").arg(indexOutput.errorString());
+            return false;
+        }
         return true;
     }
 } // namespace HibpOffline
@@ -22,21 +22,22 @@
 #include <QList>
 #include <QPair>
 
+#include <functional>
+
 class Database;
 class Entry;
 
 namespace HibpOffline
 {
+    typedef std::function<void(qint64 processed, qint64 total)> ProgressCallback;
+
     bool report(QSharedPointer<Database> db,
                 QIODevice& hibpInput,
                 QList<QPair<const Entry*, int>>& findings,
-                QString* error);
+                QString* error,
+                const ProgressCallback& progress = ProgressCallback());
 
-    bool okonReport(QSharedPointer<Database> db,
-                    const QString& okon,
-                    const QString& okonDatabase,
-                    QList<QPair<const Entry*, int>>& findings,
-                    QString* error);
+    bool buildIndex(QIODevice& hibpInput, QIODevice& indexOutput, QString* error);
 } // namespace HibpOffline
 
 #endif // KEEPASSXC_HIBPOFFLINE_H
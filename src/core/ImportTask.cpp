@@ -0,0 +1,146 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImportTask.h"
+
+#include <QEventLoop>
+#include <QThread>
+#include <QtConcurrent>
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+
+ImportTask::ImportTask(Importer importer, QObject* parent)
+    : QObject(parent)
+    , m_importer(std::move(importer))
+    , m_canceled(0)
+    , m_reportedProgress(-1)
+    , m_running(false)
+{
+    connect(&m_watcher, SIGNAL(finished()), SLOT(importFinished()));
+}
+
+ImportTask::~ImportTask()
+{
+    // The importer may still refer to its caller, never leave it running
+    cancel();
+    m_watcher.waitForFinished();
+}
+
+/**
+ * Start the importer on the global thread pool.
+ */
+void ImportTask::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_canceled.storeRelease(0);
+    m_reportedProgress = -1;
+    m_database.reset();
+    m_error.clear();
+
+    QThread* targetThread = thread();
+    m_watcher.setFuture(QtConcurrent::run([this, targetThread] {
+        QString error;
+        QSharedPointer<Database> db = m_importer(this, &error);
+        if (db && isCanceled()) {
+            db.reset();
+        }
+        if (db) {
+            db->moveToThread(targetThread);
+            // history items have no QObject parent and are not moved with the database
+            const QList<Entry*> entries = db->rootGroup()->entriesRecursive(true);
+            for (Entry* entry : entries) {
+                if (!entry->parent()) {
+                    entry->moveToThread(targetThread);
+                }
+            }
+        } else if (isCanceled()) {
+            error = tr("Import was canceled.");
+        }
+        m_error = error;
+        return db;
+    }));
+}
+
+/**
+ * Start the importer and wait for it without blocking the event loop.
+ *
+ * @return imported database or nullptr on failure
+ */
+QSharedPointer<Database> ImportTask::run()
+{
+    start();
+    if (m_running) {
+        QEventLoop loop;
+        connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+        loop.exec();
+    }
+    return m_database;
+}
+
+bool ImportTask::isRunning() const
+{
+    return m_running;
+}
+
+bool ImportTask::isCanceled() const
+{
+    return m_canceled.loadAcquire() != 0;
+}
+
+/**
+ * Request the importer to stop. A database that is still produced is discarded.
+ */
+void ImportTask::cancel()
+{
+    m_canceled.storeRelease(1);
+}
+
+QSharedPointer<Database> ImportTask::database() const
+{
+    return m_database;
+}
+
+QString ImportTask::errorString() const
+{
+    return m_error;
+}
+
+/**
+ * Report progress from the importer. Only whole percent steps are signaled
+ * so large imports do not flood the event loop of the receiving thread.
+ */
+void ImportTask::setProgress(int value, int maximum)
+{
+    const int percent = maximum > 0 ? static_cast<int>(qint64(value) * 100 / maximum) : 0;
+    if (percent != m_reportedProgress) {
+        m_reportedProgress = percent;
+        emit progressChanged(value, maximum);
+    }
+}
+
+void ImportTask::importFinished()
+{
+    m_database = m_watcher.result();
+    m_running = false;
+    emit finished();
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_IMPORTTASK_H
+#define KEEPASSXC_IMPORTTASK_H
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QSharedPointer>
+
+#include <functional>
+
+class Database;
+
+/**
+ * Builds a database on a worker thread, e.g. when importing another format.
+ *
+ * The importer creates a detached database that nothing else refers to.
+ * Once it is done, the database is moved to the thread that owns the task
+ * and handed over in one step through finished(). Importers can report
+ * progress and should poll isCanceled() between steps.
+ */
+class ImportTask : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<QSharedPointer<Database>(ImportTask* task, QString* error)> Importer;
+
+    explicit ImportTask(Importer importer, QObject* parent = nullptr);
+    ~ImportTask() override;
+
+    void start();
+    QSharedPointer<Database> run();
+    bool isRunning() const;
+    bool isCanceled() const;
+
+    QSharedPointer<Database> database() const;
+    QString errorString() const;
+
+    void setProgress(int value, int maximum);
+
+public slots:
+    void cancel();
+
+signals:
+    void progressChanged(int value, int maximum);
+    void finished();
+
+private slots:
+    void importFinished();
+
+private:
+    Importer m_importer;
+    QFutureWatcher<QSharedPointer<Database>> m_watcher;
+    QSharedPointer<Database> m_database;
+    QString m_error;
+    QAtomicInt m_canceled;
+    int m_reportedProgress;
+    bool m_running;
+};
+
+#endif // KEEPASSXC_IMPORTTASK_H
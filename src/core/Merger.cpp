@@ -21,6 +21,7 @@
 #include "core/Database.h"
 #include "core/Entry.h"
 #include "core/Metadata.h"
+#include "core/Trace.h"
 
 Merger::Merger(const Database* sourceDb, Database* targetDb)
     : m_mode(Group::Default)
@@ -62,6 +63,7 @@ void Merger::resetForcedMergeMode()
 
 QStringList Merger::merge()
 {
+    TRACE_SCOPE("merge", "merge");
     // Order of merge steps is important - it is possible that we
     // create some items before deleting them afterwards
     ChangeList changes;
@@ -614,8 +616,7 @@ Merger::ChangeList Merger::mergeMetadata(const MergeContext& context)
 
     for (const auto& iconUuid : sourceMetadata->customIconsOrder()) {
         if (!targetMetadata->hasCustomIcon(iconUuid)) {
-            QImage customIcon = sourceMetadata->customIcon(iconUuid);
-            targetMetadata->addCustomIcon(iconUuid, customIcon);
+            targetMetadata->addCustomIcon(iconUuid, sourceMetadata->customIconData(iconUuid));
             changes << tr("Adding missing icon %1").arg(QString::fromLatin1(iconUuid.toRfc4122().toHex()));
         }
     }
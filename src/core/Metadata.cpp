@@ -17,6 +17,7 @@
 
 #include "Metadata.h"
 #include <QApplication>
+#include <QBuffer>
 #include <QtCore/QCryptographicHash>
 
 #include "core/Clock.h"
@@ -30,6 +31,7 @@ const int Metadata::DefaultHistoryMaxSize = 6 * 1024 * 1024;
 
 Metadata::Metadata(QObject* parent)
     : QObject(parent)
+    , m_customIconsHashesDirty(false)
     , m_customData(new CustomData(this))
     , m_updateDatetime(true)
 {
@@ -65,10 +67,12 @@ void Metadata::init()
 void Metadata::clear()
 {
     init();
+    m_customIconsData.clear();
     m_customIcons.clear();
     m_customIconsRaw.clear();
     m_customIconsOrder.clear();
     m_customIconsHashes.clear();
+    m_customIconsHashesDirty = false;
     m_customData->clear();
 }
 
@@ -177,9 +181,34 @@ bool Metadata::protectNotes() const
     return m_data.protectNotes;
 }
 
+/**
+ * Decode the custom icon on first use. The decoded image is cached until
+ * the icon is removed.
+ */
 QImage Metadata::customIcon(const QUuid& uuid) const
 {
-    return m_customIconsRaw.value(uuid);
+    auto it = m_customIconsRaw.constFind(uuid);
+    if (it != m_customIconsRaw.constEnd()) {
+        return it.value();
+    }
+
+    auto data = m_customIconsData.constFind(uuid);
+    if (data == m_customIconsData.constEnd()) {
+        return {};
+    }
+
+    QImage image;
+    image.loadFromData(data.value());
+    m_customIconsRaw.insert(uuid, image);
+    return image;
+}
+
+/**
+ * @return the custom icon as stored in the database, usually PNG encoded
+ */
+QByteArray Metadata::customIconData(const QUuid& uuid) const
+{
+    return m_customIconsData.value(uuid);
 }
 
 QPixmap Metadata::customIconPixmap(const QUuid& uuid, IconSize size) const
@@ -187,7 +216,22 @@ QPixmap Metadata::customIconPixmap(const QUuid& uuid, IconSize size) const
     if (!hasCustomIcon(uuid)) {
         return {};
     }
-    return m_customIcons.value(uuid).pixmap(databaseIcons()->iconSize(size));
+
+    auto it = m_customIcons.constFind(uuid);
+    if (it == m_customIcons.constEnd()) {
+        QIcon icon;
+        // TODO: This check can go away when we move all QIcon handling outside of core
+        // On older versions of Qt, loading a QPixmap from QImage outside of a GUI
+        // environment causes ASAN to fail and crash on nullptr violation
+        static bool isGui = qApp->inherits("QGuiApplication");
+        if (isGui) {
+            // Generate QIcon with pre-baked resolutions
+            auto image = customIcon(uuid).scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            icon = QIcon(QPixmap::fromImage(image));
+        }
+        it = m_customIcons.insert(uuid, icon);
+    }
+    return it.value().pixmap(databaseIcons()->iconSize(size));
 }
 
 QHash<QUuid, QPixmap> Metadata::customIconsPixmaps(IconSize size) const
@@ -203,7 +247,7 @@ QHash<QUuid, QPixmap> Metadata::customIconsPixmaps(IconSize size) const
 
 bool Metadata::hasCustomIcon(const QUuid& uuid) const
 {
-    return m_customIconsRaw.contains(uuid);
+    return m_customIconsData.contains(uuid);
 }
 
 QList<QUuid> Metadata::customIconsOrder() const
@@ -360,31 +404,35 @@ void Metadata::setProtectNotes(bool value)
 }
 
 void Metadata::addCustomIcon(const QUuid& uuid, const QImage& image)
+{
+    QByteArray iconData;
+    QBuffer buffer(&iconData);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    buffer.close();
+
+    addCustomIcon(uuid, iconData);
+    m_customIconsRaw.insert(uuid, image);
+}
+
+/**
+ * Add a custom icon from its encoded data. The data is kept as is and
+ * written back unchanged when the database is saved.
+ */
+void Metadata::addCustomIcon(const QUuid& uuid, const QByteArray& iconData)
 {
     Q_ASSERT(!uuid.isNull());
-    Q_ASSERT(!m_customIconsRaw.contains(uuid));
+    Q_ASSERT(!m_customIconsData.contains(uuid));
 
-    m_customIconsRaw[uuid] = image;
+    m_customIconsData[uuid] = iconData;
+    m_customIcons.remove(uuid);
+    m_customIconsRaw.remove(uuid);
     // remove all uuids to prevent duplicates in release mode
     m_customIconsOrder.removeAll(uuid);
     m_customIconsOrder.append(uuid);
-    // Associate image hash to uuid
-    QByteArray hash = hashImage(image);
-    m_customIconsHashes[hash] = uuid;
-    Q_ASSERT(m_customIconsRaw.count() == m_customIconsOrder.count());
-
-    // TODO: This check can go away when we move all QIcon handling outside of core
-    // On older versions of Qt, loading a QPixmap from QImage outside of a GUI
-    // environment causes ASAN to fail and crash on nullptr violation
-    static bool isGui = qApp->inherits("QGuiApplication");
-    if (isGui) {
-        // Generate QIcon with pre-baked resolutions
-        auto basePixmap = QPixmap::fromImage(image.scaled(64, 64, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-        QIcon icon(basePixmap);
-        m_customIcons.insert(uuid, icon);
-    } else {
-        m_customIcons.insert(uuid, QIcon());
-    }
+    // Image hashes are only computed when they are needed
+    m_customIconsHashesDirty = true;
+    Q_ASSERT(m_customIconsData.count() == m_customIconsOrder.count());
 
     emit metadataModified();
 }
@@ -392,23 +440,28 @@ void Metadata::addCustomIcon(const QUuid& uuid, const QImage& image)
 void Metadata::removeCustomIcon(const QUuid& uuid)
 {
     Q_ASSERT(!uuid.isNull());
-    Q_ASSERT(m_customIconsRaw.contains(uuid));
-
-    // Remove hash record only if this is the same uuid
-    QByteArray hash = hashImage(m_customIconsRaw[uuid]);
-    if (m_customIconsHashes.contains(hash) && m_customIconsHashes[hash] == uuid) {
-        m_customIconsHashes.remove(hash);
-    }
+    Q_ASSERT(m_customIconsData.contains(uuid));
 
     m_customIcons.remove(uuid);
     m_customIconsRaw.remove(uuid);
+    m_customIconsData.remove(uuid);
     m_customIconsOrder.removeAll(uuid);
-    Q_ASSERT(m_customIconsRaw.count() == m_customIconsOrder.count());
+    m_customIconsHashesDirty = true;
+    Q_ASSERT(m_customIconsData.count() == m_customIconsOrder.count());
     emit metadataModified();
 }
 
-QUuid Metadata::findCustomIcon(const QImage& candidate)
+QUuid Metadata::findCustomIcon(const QImage& candidate) const
 {
+    if (m_customIconsHashesDirty) {
+        // Later icons take precedence over earlier ones with the same image
+        m_customIconsHashes.clear();
+        for (const QUuid& uuid : m_customIconsOrder) {
+            m_customIconsHashes.insert(hashImage(customIcon(uuid)), uuid);
+        }
+        m_customIconsHashesDirty = false;
+    }
+
     QByteArray hash = hashImage(candidate);
     return m_customIconsHashes.value(hash, QUuid());
 }
@@ -419,7 +472,7 @@ void Metadata::copyCustomIcons(const QSet<QUuid>& iconList, const Metadata* othe
         Q_ASSERT(otherMetadata->hasCustomIcon(uuid));
 
         if (!hasCustomIcon(uuid) && otherMetadata->hasCustomIcon(uuid)) {
-            addCustomIcon(uuid, otherMetadata->customIcon(uuid));
+            addCustomIcon(uuid, otherMetadata->customIconData(uuid));
         }
     }
 }
@@ -84,6 +84,7 @@ public:
     bool protectUrl() const;
     bool protectNotes() const;
     QImage customIcon(const QUuid& uuid) const;
+    QByteArray customIconData(const QUuid& uuid) const;
     bool hasCustomIcon(const QUuid& uuid) const;
     QPixmap customIconPixmap(const QUuid& uuid, IconSize size = IconSize::Default) const;
     QHash<QUuid, QPixmap> customIconsPixmaps(IconSize size = IconSize::Default) const;
@@ -123,9 +124,10 @@ public:
     void setProtectUrl(bool value);
     void setProtectNotes(bool value);
     void addCustomIcon(const QUuid& uuid, const QImage& image);
+    void addCustomIcon(const QUuid& uuid, const QByteArray& iconData);
     void removeCustomIcon(const QUuid& uuid);
     void copyCustomIcons(const QSet<QUuid>& iconList, const Metadata* otherMetadata);
-    QUuid findCustomIcon(const QImage& candidate);
+    QUuid findCustomIcon(const QImage& candidate) const;
     void setRecycleBinEnabled(bool value);
     void setRecycleBin(Group* group);
     void setRecycleBinChanged(const QDateTime& value);
@@ -156,14 +158,17 @@ private:
     template <class P, class V> bool set(P& property, const V& value);
     template <class P, class V> bool set(P& property, const V& value, QDateTime& dateTime);
 
-    QByteArray hashImage(const QImage& image);
+    static QByteArray hashImage(const QImage& image);
 
     MetadataData m_data;
 
-    QHash<QUuid, QIcon> m_customIcons;
-    QHash<QUuid, QImage> m_customIconsRaw;
+    // Icons are kept in their encoded form and only decoded when first displayed
+    QHash<QUuid, QByteArray> m_customIconsData;
     QList<QUuid> m_customIconsOrder;
-    QHash<QByteArray, QUuid> m_customIconsHashes;
+    mutable QHash<QUuid, QIcon> m_customIcons;
+    mutable QHash<QUuid, QImage> m_customIconsRaw;
+    mutable QHash<QByteArray, QUuid> m_customIconsHashes;
+    mutable bool m_customIconsHashesDirty;
 
     QPointer<Group> m_recycleBin;
     QDateTime m_recycleBinChanged;
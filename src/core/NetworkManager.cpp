@@ -30,4 +30,14 @@ QNetworkAccessManager* getNetMgr()
     }
     return g_netMgr;
 }
+
+/**
+ * Replace the network access manager, e.g. with a mock in the
+ * tests. The caller keeps the ownership of `netMgr`, passing
+ * nullptr restores the default on the next getNetMgr().
+ */
+void setNetMgr(QNetworkAccessManager* netMgr)
+{
+    g_netMgr = netMgr;
+}
 #endif
@@ -27,6 +27,7 @@
 #include <QNetworkRequest>
 
 QNetworkAccessManager* getNetMgr();
+void setNetMgr(QNetworkAccessManager* netMgr);
 #else
 Q_STATIC_ASSERT_X(false, "Qt Networking used when WITH_XC_NETWORKING is disabled!");
 #endif
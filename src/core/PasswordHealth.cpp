@@ -16,17 +16,100 @@
  */
 
 #include <QApplication>
+#include <QCache>
+#include <QMutex>
 #include <QString>
+#include <QtConcurrent>
+
+#include <sodium.h>
 
 #include "Database.h"
 #include "Entry.h"
 #include "Group.h"
 #include "PasswordHealth.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
 #include "zxcvbn.h"
 
 // Define the static member variable with the custom field name
 const QString PasswordHealth::OPTION_KNOWN_BAD = QStringLiteral("KnownBad");
 
+namespace
+{
+    const int ENTROPY_CACHE_SIZE = 4096;
+    const int DIGEST_KEY_SIZE = 32;
+
+    /*
+     * Entropy of recently checked passwords, indexed by the HMAC of the
+     * password so the cache never holds plaintext. The key is random and
+     * replaced whenever the cache is cleared.
+     */
+    struct EntropyCache
+    {
+        EntropyCache()
+            : entropies(ENTROPY_CACHE_SIZE)
+        {
+        }
+
+        // The mutex must be held by the caller
+        QByteArray digest(const QString& pwd)
+        {
+            if (key.isEmpty()) {
+                key = randomGen()->randomArray(DIGEST_KEY_SIZE);
+            }
+            return CryptoHash::hmac(pwd.toUtf8(), key, CryptoHash::Sha256);
+        }
+
+        QMutex mutex;
+        QByteArray key;
+        QCache<QByteArray, double> entropies;
+        quint64 generation = 0;
+    };
+
+    EntropyCache& entropyCache()
+    {
+        static EntropyCache cache;
+        return cache;
+    }
+
+    double passwordEntropy(const QString& pwd)
+    {
+        auto& cache = entropyCache();
+        QMutexLocker locker(&cache.mutex);
+        const auto digest = cache.digest(pwd);
+        if (const double* entropy = cache.entropies.object(digest)) {
+            return *entropy;
+        }
+        const auto generation = cache.generation;
+        locker.unlock();
+
+        // Don't block other threads while zxcvbn is running
+        const double entropy = ZxcvbnMatch(pwd.toLatin1(), nullptr, nullptr);
+
+        locker.relock();
+        if (cache.generation == generation) {
+            cache.entropies.insert(digest, new double(entropy));
+        }
+        return entropy;
+    }
+
+    /*
+     * Holds its own copy of the checker, so the evaluation
+     * can outlive the HealthChecker that started it.
+     */
+    struct Evaluator
+    {
+        typedef QSharedPointer<PasswordHealth> result_type;
+
+        HealthChecker checker;
+
+        result_type operator()(const Entry* entry) const
+        {
+            return checker.evaluate(entry);
+        }
+    };
+} // namespace
+
 PasswordHealth::PasswordHealth(double entropy)
     : m_score(entropy)
     , m_entropy(entropy)
@@ -50,8 +133,43 @@ PasswordHealth::PasswordHealth(double entropy)
 }
 
 PasswordHealth::PasswordHealth(QString pwd)
-    : PasswordHealth(ZxcvbnMatch(pwd.toLatin1(), nullptr, nullptr))
+    : PasswordHealth(passwordEntropy(pwd))
+{
+}
+
+void PasswordHealth::clearEntropyCache()
+{
+    auto& cache = entropyCache();
+    QMutexLocker locker(&cache.mutex);
+    cache.entropies.clear();
+    if (!cache.key.isEmpty()) {
+        sodium_memzero(cache.key.data(), static_cast<std::size_t>(cache.key.size()));
+        cache.key.clear();
+    }
+    ++cache.generation;
+}
+
+void PasswordHealth::removeFromEntropyCache(const QString& pwd)
+{
+    auto& cache = entropyCache();
+    QMutexLocker locker(&cache.mutex);
+    if (!cache.key.isEmpty()) {
+        cache.entropies.remove(cache.digest(pwd));
+    }
+}
+
+bool PasswordHealth::isEntropyCached(const QString& pwd)
+{
+    auto& cache = entropyCache();
+    QMutexLocker locker(&cache.mutex);
+    return !cache.key.isEmpty() && cache.entropies.contains(cache.digest(pwd));
+}
+
+int PasswordHealth::entropyCacheSize()
 {
+    auto& cache = entropyCache();
+    QMutexLocker locker(&cache.mutex);
+    return cache.entropies.size();
 }
 
 void PasswordHealth::setScore(int score)
@@ -103,16 +221,75 @@ PasswordHealth::Quality PasswordHealth::quality() const
  * than can be derived from the password itself (re-use, expiry).
  */
 HealthChecker::HealthChecker(QSharedPointer<Database> db)
+    : m_key(randomGen()->randomArray(DIGEST_KEY_SIZE))
 {
     // Build the cache of re-used passwords
     for (const auto* entry : db->rootGroup()->entriesRecursive()) {
-        if (!entry->isRecycled() && !entry->isAttributeReference("Password")) {
-            m_reuse[entry->password()]
-                << QApplication::tr("Used in %1/%2").arg(entry->group()->hierarchy().join('/'), entry->title());
+        if (isReuseCounted(entry)) {
+            const auto digest = passwordDigest(entry->password());
+            m_reuse[digest] << entry;
+            m_digests.insert(entry, digest);
         }
     }
 }
 
+QByteArray HealthChecker::passwordDigest(const QString& pwd) const
+{
+    return CryptoHash::hmac(pwd.toUtf8(), m_key, CryptoHash::Sha256);
+}
+
+bool HealthChecker::isReuseCounted(const Entry* entry) const
+{
+    return !entry->isRecycled() && !entry->isAttributeReference("Password");
+}
+
+/**
+ * Update the re-use information of an entry that was added
+ * to the database or modified.
+ *
+ * Returns the entries whose health may have changed, which
+ * are `entry` and the entries sharing its old or new password.
+ */
+QList<const Entry*> HealthChecker::updateEntry(const Entry* entry)
+{
+    const auto digest = isReuseCounted(entry) ? passwordDigest(entry->password()) : QByteArray();
+    if (digest == m_digests.value(entry)) {
+        // Same password, but the title or group shown in the details of the other entries may have changed
+        return digest.isNull() ? QList<const Entry*>{entry} : m_reuse.value(digest);
+    }
+
+    auto affected = removeEntry(entry);
+    if (!digest.isNull()) {
+        auto& used = m_reuse[digest];
+        affected.append(used);
+        used.append(entry);
+        m_digests.insert(entry, digest);
+    }
+    affected.append(entry);
+    return affected;
+}
+
+/**
+ * Remove an entry that is about to be removed from the database.
+ *
+ * Returns the entries that shared its password.
+ */
+QList<const Entry*> HealthChecker::removeEntry(const Entry* entry)
+{
+    const auto digest = m_digests.take(entry);
+    if (digest.isNull()) {
+        return {};
+    }
+
+    auto& used = m_reuse[digest];
+    used.removeOne(entry);
+    const auto affected = used;
+    if (used.isEmpty()) {
+        m_reuse.remove(digest);
+    }
+    return affected;
+}
+
 /**
  * Call operator of the Health Checker class.
  *
@@ -132,7 +309,7 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
 
     // Second, if the password is in the database more than once,
     // reduce the score accordingly
-    const auto& used = m_reuse[pwd];
+    const auto used = m_reuse.value(passwordDigest(pwd));
     const auto count = used.size();
     if (count > 1) {
         constexpr auto penalty = 15;
@@ -140,7 +317,8 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
         health->addScoreReason(QApplication::tr("Password is used %1 times").arg(QString::number(count)));
         // Add the first 20 uses of the password to prevent the details display from growing too large
         for (int i = 0; i < used.size(); ++i) {
-            health->addScoreDetails(used[i]);
+            health->addScoreDetails(
+                QApplication::tr("Used in %1/%2").arg(used[i]->group()->hierarchy().join('/'), used[i]->title()));
             if (i == 19) {
                 health->addScoreDetails("…");
                 break;
@@ -185,3 +363,15 @@ QSharedPointer<PasswordHealth> HealthChecker::evaluate(const Entry* entry) const
     // Return the result
     return health;
 }
+
+/**
+ * Evaluate a list of entries on the global thread pool.
+ *
+ * The results are in the order of `entries`. Use a QFutureWatcher
+ * to follow the progress, and cancel the future to stop early.
+ * The entries must not be deleted before the future has finished.
+ */
+QFuture<QSharedPointer<PasswordHealth>> HealthChecker::evaluateAll(const QList<const Entry*>& entries) const
+{
+    return QtConcurrent::mapped(entries, Evaluator{*this});
+}
@@ -18,6 +18,7 @@
 #ifndef KEEPASSX_PASSWORDHEALTH_H
 #define KEEPASSX_PASSWORDHEALTH_H
 
+#include <QFuture>
 #include <QHash>
 #include <QSharedPointer>
 #include <QStringList>
@@ -91,6 +92,16 @@ public:
      */
     static const QString OPTION_KNOWN_BAD;
 
+    /*
+     * The entropy of the passwords passed to the constructor is cached,
+     * identified by a keyed hash of the password. Clearing the cache
+     * also discards the key.
+     */
+    static void clearEntropyCache();
+    static void removeFromEntropyCache(const QString& pwd);
+    static bool isEntropyCached(const QString& pwd);
+    static int entropyCacheSize();
+
 private:
     int m_score = 0;
     double m_entropy = 0.0;
@@ -101,6 +112,10 @@ private:
 /**
  * Password health check for all entries of a database.
  *
+ * The checker keeps pointers to the entries of the database. Call
+ * updateEntry() and removeEntry() when entries are added, modified
+ * or removed, otherwise it must not be used after such changes.
+ *
  * @see PasswordHealth
  */
 class HealthChecker
@@ -110,10 +125,21 @@ public:
 
     // Get the health status of an entry in the database
     QSharedPointer<PasswordHealth> evaluate(const Entry* entry) const;
+    QFuture<QSharedPointer<PasswordHealth>> evaluateAll(const QList<const Entry*>& entries) const;
+
+    // Update the re-use information, both return the entries whose health may have changed
+    QList<const Entry*> updateEntry(const Entry* entry);
+    QList<const Entry*> removeEntry(const Entry* entry);
 
 private:
-    // To determine password re-use: first = password, second = entries that use it
-    QHash<QString, QStringList> m_reuse;
+    QByteArray passwordDigest(const QString& pwd) const;
+    bool isReuseCounted(const Entry* entry) const;
+
+    // Random key of the password digests, the checker never holds the passwords
+    QByteArray m_key;
+    // To determine password re-use: first = password digest, second = entries that use it
+    QHash<QByteArray, QList<const Entry*>> m_reuse;
+    QHash<const Entry*, QByteArray> m_digests;
 };
 
 #endif // KEEPASSX_PASSWORDHEALTH_H
@@ -0,0 +1,169 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Trace.h"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QVector>
+
+namespace
+{
+    struct Event
+    {
+        const char* category;
+        const char* name;
+        qint64 start;
+        qint64 duration;
+        int thread;
+    };
+
+    struct TraceState
+    {
+        TraceState()
+        {
+            timer.start();
+            outputFile = QString::fromLocal8Bit(qgetenv("KEEPASSXC_TRACE"));
+            enabled = !outputFile.isEmpty();
+            if (enabled) {
+                qAddPostRoutine([] { Trace::flush(); });
+            }
+        }
+
+        QMutex mutex;
+        QElapsedTimer timer;
+        QString outputFile;
+        QVector<Event> events;
+        bool enabled;
+    };
+
+    TraceState& state()
+    {
+        static TraceState instance;
+        return instance;
+    }
+
+    int currentThread()
+    {
+        static QAtomicInt nextThread(1);
+        thread_local int thread = nextThread.fetchAndAddRelaxed(1);
+        return thread;
+    }
+
+    void appendEscaped(QByteArray& json, const char* text)
+    {
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') {
+                json.append('\\');
+            }
+            json.append(*c);
+        }
+    }
+} // namespace
+
+namespace Trace
+{
+    bool isEnabled()
+    {
+        return state().enabled;
+    }
+
+    /**
+     * Enable tracing and set the file the events are written to on exit.
+     * Overrides the KEEPASSXC_TRACE environment variable.
+     */
+    void setOutputFile(const QString& fileName)
+    {
+        TraceState& s = state();
+        QMutexLocker locker(&s.mutex);
+        if (!s.enabled && !fileName.isEmpty()) {
+            qAddPostRoutine([] { Trace::flush(); });
+        }
+        s.outputFile = fileName;
+        s.enabled = !fileName.isEmpty();
+    }
+
+    /**
+     * Write all events recorded so far to the output file.
+     *
+     * @return true on success
+     */
+    bool flush()
+    {
+        TraceState& s = state();
+        QMutexLocker locker(&s.mutex);
+        if (!s.enabled) {
+            return false;
+        }
+
+        const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+        QByteArray json("{\"traceEvents\":[");
+        for (int i = 0; i < s.events.size(); ++i) {
+            const Event& event = s.events.at(i);
+            if (i > 0) {
+                json.append(",\n");
+            }
+            // timestamps are in microseconds
+            json.append("{\"name\":\"");
+            appendEscaped(json, event.name);
+            json.append("\",\"cat\":\"");
+            appendEscaped(json, event.category);
+            json.append("\",\"ph\":\"X\",\"ts\":");
+            json.append(QByteArray::number(event.start / 1000.0, 'f', 3));
+            json.append(",\"dur\":");
+            json.append(QByteArray::number(event.duration / 1000.0, 'f', 3));
+            json.append(",\"pid\":");
+            json.append(pid);
+            json.append(",\"tid\":");
+            json.append(QByteArray::number(event.thread));
+            json.append('}');
+        }
+        json.append("],\"displayTimeUnit\":\"ms\"}\n");
+
+        QSaveFile file(s.outputFile);
+        if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size() || !file.commit()) {
+            qWarning("Could not write trace file %s: %s", qPrintable(s.outputFile), qPrintable(file.errorString()));
+            return false;
+        }
+        return true;
+    }
+
+    Scope::Scope(const char* category, const char* name)
+        : m_category(category)
+        , m_name(name)
+        , m_start(isEnabled() ? state().timer.nsecsElapsed() : -1)
+    {
+    }
+
+    Scope::~Scope()
+    {
+        if (m_start < 0) {
+            return;
+        }
+
+        TraceState& s = state();
+        const qint64 end = s.timer.nsecsElapsed();
+        const int thread = currentThread();
+
+        QMutexLocker locker(&s.mutex);
+        s.events.append({m_category, m_name, m_start, end - m_start, thread});
+    }
+} // namespace Trace
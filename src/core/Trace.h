@@ -0,0 +1,72 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TRACE_H
+#define KEEPASSXC_TRACE_H
+
+#include "config-keepassx.h"
+
+/**
+ * Scoped trace points for expensive operations.
+ *
+ * Trace points are only compiled in if WITH_XC_TRACING is enabled. At runtime
+ * they stay inactive until an output file is set, either through the
+ * KEEPASSXC_TRACE environment variable or the --trace command line option.
+ * The recorded events are written in Chrome trace_event JSON format when the
+ * application exits and can be loaded in chrome://tracing or Perfetto.
+ *
+ * Usage: TRACE_SCOPE("kdbx", "readDatabase");
+ * Both arguments must be string literals or otherwise outlive the application.
+ */
+#ifdef WITH_XC_TRACING
+
+#include <QString>
+
+namespace Trace
+{
+    bool isEnabled();
+    void setOutputFile(const QString& fileName);
+    bool flush();
+
+    class Scope
+    {
+    public:
+        Scope(const char* category, const char* name);
+        ~Scope();
+
+    private:
+        Q_DISABLE_COPY(Scope)
+
+        const char* const m_category;
+        const char* const m_name;
+        const qint64 m_start;
+    };
+} // namespace Trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(category, name) const Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+
+#else
+
+#define TRACE_SCOPE(category, name)                                                                                    \
+    do {                                                                                                               \
+    } while (false)
+
+#endif // WITH_XC_TRACING
+
+#endif // KEEPASSXC_TRACE_H
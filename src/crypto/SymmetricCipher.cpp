@@ -75,6 +75,18 @@ bool SymmetricCipher::reset()
     return m_backend->reset();
 }
 
+/**
+ * Position the keystream of a counter mode or stream cipher at an
+ * absolute byte offset from the start of the IV.
+ *
+ * @param offset byte offset into the keystream
+ * @return false if the cipher is not position-addressable
+ */
+bool SymmetricCipher::seek(quint64 offset)
+{
+    return m_backend->seek(offset);
+}
+
 int SymmetricCipher::keySize() const
 {
     return m_backend->keySize();
@@ -78,6 +78,7 @@ public:
     }
 
     bool reset();
+    bool seek(quint64 offset);
     int keySize() const;
     int blockSize() const;
     QString errorString() const;
@@ -231,6 +231,59 @@ bool SymmetricCipherGcrypt::reset()
     return true;
 }
 
+bool SymmetricCipherGcrypt::seek(quint64 offset)
+{
+    gcry_error_t error;
+    quint64 blockLength;
+
+    if (m_mode == GCRY_CIPHER_MODE_CTR) {
+        // big-endian 128 bit counter
+        blockLength = static_cast<quint64>(blockSize());
+        QByteArray counter = m_iv;
+        quint64 carry = offset / blockLength;
+        for (int i = counter.size() - 1; i >= 0 && carry != 0; --i) {
+            carry += static_cast<quint8>(counter[i]);
+            counter[i] = static_cast<char>(carry & 0xFF);
+            carry >>= 8;
+        }
+        error = gcry_cipher_setctr(m_ctx, counter.constData(), counter.size());
+    } else if (m_algo == GCRY_CIPHER_CHACHA20 && (m_iv.size() == 8 || m_iv.size() == 12)) {
+        // 16 byte IV: little-endian block counter followed by the nonce
+        blockLength = 64;
+        quint64 block = offset / blockLength;
+        if (m_iv.size() == 12 && block > 0xFFFFFFFFULL) {
+            m_error = "Keystream offset out of range";
+            return false;
+        }
+        QByteArray counter;
+        for (int i = 0; i < 16 - m_iv.size(); ++i) {
+            counter.append(static_cast<char>((block >> (8 * i)) & 0xFF));
+        }
+        counter.append(m_iv);
+        error = gcry_cipher_setiv(m_ctx, counter.constData(), counter.size());
+    } else {
+        m_error = "Cipher does not support seeking";
+        return false;
+    }
+
+    if (error != 0) {
+        setError(error);
+        return false;
+    }
+
+    // discard the keystream up to the requested offset within the block
+    QByteArray skip(static_cast<int>(offset % blockLength), '\0');
+    if (!skip.isEmpty()) {
+        error = gcry_cipher_encrypt(m_ctx, skip.data(), skip.size(), nullptr, 0);
+        if (error != 0) {
+            setError(error);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int SymmetricCipherGcrypt::keySize() const
 {
     gcry_error_t error;
@@ -40,6 +40,7 @@ public:
     Q_REQUIRED_RESULT bool processInPlace(QByteArray& data, quint64 rounds);
 
     bool reset();
+    bool seek(quint64 offset);
     int keySize() const;
     int blockSize() const;
 
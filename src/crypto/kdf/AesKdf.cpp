@@ -19,6 +19,7 @@
 
 #include <QtConcurrent>
 
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 #include "format/KeePass2.h"
 
@@ -61,6 +62,7 @@ QVariantMap AesKdf::writeParameters()
 
 bool AesKdf::transform(const QByteArray& raw, QByteArray& result) const
 {
+    TRACE_SCOPE("kdf", "AesKdf::transform");
     QByteArray resultLeft;
     QByteArray resultRight;
 
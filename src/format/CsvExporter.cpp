@@ -23,6 +23,18 @@
 #include "core/Database.h"
 #include "core/Group.h"
 
+namespace
+{
+    QString childGroupPath(const Group* group, QString groupPath)
+    {
+        if (!groupPath.isEmpty()) {
+            groupPath.append("/");
+        }
+        groupPath.append(group->name());
+        return groupPath;
+    }
+} // namespace
+
 bool CsvExporter::exportDatabase(const QString& filename, const QSharedPointer<const Database>& db)
 {
     QFile file(filename);
@@ -40,12 +52,8 @@ bool CsvExporter::exportDatabase(QIODevice* device, const QSharedPointer<const D
         return false;
     }
 
-    if (device->write(exportGroup(db->rootGroup()).toUtf8()) == -1) {
-        m_error = device->errorString();
-        return false;
-    }
-
-    return true;
+    // Write one group at a time so the whole export is never held in memory
+    return writeGroup(device, db->rootGroup());
 }
 
 QString CsvExporter::exportDatabase(const QSharedPointer<const Database>& db)
@@ -76,12 +84,38 @@ QString CsvExporter::exportHeader()
 
 QString CsvExporter::exportGroup(const Group* group, QString groupPath)
 {
-    QString response;
-    if (!groupPath.isEmpty()) {
-        groupPath.append("/");
+    groupPath = childGroupPath(group, groupPath);
+    QString response = exportEntries(group, groupPath);
+
+    const QList<Group*>& children = group->children();
+    for (const Group* child : children) {
+        response.append(exportGroup(child, groupPath));
     }
-    groupPath.append(group->name());
 
+    return response;
+}
+
+bool CsvExporter::writeGroup(QIODevice* device, const Group* group, QString groupPath)
+{
+    groupPath = childGroupPath(group, groupPath);
+    if (device->write(exportEntries(group, groupPath).toUtf8()) == -1) {
+        m_error = device->errorString();
+        return false;
+    }
+
+    const QList<Group*>& children = group->children();
+    for (const Group* child : children) {
+        if (!writeGroup(device, child, groupPath)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QString CsvExporter::exportEntries(const Group* group, const QString& groupPath)
+{
+    QString response;
     const QList<Entry*>& entryList = group->entries();
     for (const Entry* entry : entryList) {
         QString line;
@@ -101,11 +135,6 @@ QString CsvExporter::exportGroup(const Group* group, QString groupPath)
         response.append(line);
     }
 
-    const QList<Group*>& children = group->children();
-    for (const Group* child : children) {
-        response.append(exportGroup(child, groupPath));
-    }
-
     return response;
 }
 
@@ -36,6 +36,8 @@ public:
 
 private:
     QString exportGroup(const Group* group, QString groupPath = QString());
+    QString exportEntries(const Group* group, const QString& groupPath);
+    bool writeGroup(QIODevice* device, const Group* group, QString groupPath = QString());
     QString exportHeader();
     void addColumn(QString& str, const QString& column);
 
@@ -19,6 +19,7 @@
 
 #include <QBuffer>
 #include <QFile>
+#include <QGuiApplication>
 
 #include "core/Database.h"
 #include "core/Global.h"
@@ -39,6 +40,12 @@ namespace
         pixmap.save(&buffer, "PNG");
         return QString("<img src=\"data:image/png;base64,") + a.toBase64() + "\"/>";
     }
+
+    // Icons are pixmaps and cannot be rendered without a GUI application (e.g. in the CLI)
+    bool canRenderIcons()
+    {
+        return qobject_cast<QGuiApplication*>(QCoreApplication::instance()) != nullptr;
+    }
 } // namespace
 
 bool HtmlExporter::exportDatabase(const QString& filename, const QSharedPointer<const Database>& db)
@@ -139,8 +146,10 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
 
         // Header line
         auto header = QString("<hr><h2>");
-        header.append(PixmapToHTML(group.iconPixmap(IconSize::Medium)));
-        header.append("&nbsp;");
+        if (canRenderIcons()) {
+            header.append(PixmapToHTML(group.iconPixmap(IconSize::Medium)));
+            header.append("&nbsp;");
+        }
         header.append(path);
         header.append("</h2>\n");
 
@@ -159,7 +168,10 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
     }
 
     // Begin the table for the entries in this group
-    auto table = QString("<table width=\"100%\">");
+    if (device.write("<table width=\"100%\">") == -1) {
+        m_error = device.errorString();
+        return false;
+    }
 
     // Output the entries in this group
     for (const auto entry : entries) {
@@ -235,18 +247,24 @@ bool HtmlExporter::writeGroup(QIODevice& device, const Group& group, QString pat
 
         // Output it into our table. First the left side with
         // icon and entry title ...
-        table += "<tr>";
-        table += "<td width=\"1%\">" + PixmapToHTML(entry->iconPixmap(IconSize::Medium)) + "</td>";
-        table += "<td width=\"19%\" valign=\"top\"><h3>" + entry->title().toHtmlEscaped() + "</h3></td>";
+        QString row = "<tr>";
+        const auto icon = canRenderIcons() ? PixmapToHTML(entry->iconPixmap(IconSize::Medium)) : QString();
+        row += "<td width=\"1%\">" + icon + "</td>";
+        row += "<td width=\"19%\" valign=\"top\"><h3>" + entry->title().toHtmlEscaped() + "</h3></td>";
 
         // ... then the right side with the data fields
-        table += "<td style=\"padding-bottom: 0.5em;\"><table width=\"100%\">" + item + "</table></td>";
-        table += "</tr>";
+        row += "<td style=\"padding-bottom: 0.5em;\"><table width=\"100%\">" + item + "</table></td>";
+        row += "</tr>";
+
+        // Write each entry as it is formatted to keep memory usage bounded
+        if (device.write(row.toUtf8()) == -1) {
+            m_error = device.errorString();
+            return false;
+        }
     }
 
-    // Output the complete table of this group
-    table.append("</table>\n");
-    if (device.write(table.toUtf8()) == -1) {
+    // Close the table of this group
+    if (device.write("</table>\n") == -1) {
         m_error = device.errorString();
         return false;
     }
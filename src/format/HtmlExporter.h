@@ -29,10 +29,10 @@ class HtmlExporter
 {
 public:
     bool exportDatabase(const QString& filename, const QSharedPointer<const Database>& db);
+    bool exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db);
     QString errorString() const;
 
 private:
-    bool exportDatabase(QIODevice* device, const QSharedPointer<const Database>& db);
     bool writeGroup(QIODevice& device, const Group& group, QString path = QString());
 
     QString m_error;
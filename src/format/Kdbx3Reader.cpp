@@ -21,6 +21,7 @@
 #include "core/AsyncTask.h"
 #include "core/Endian.h"
 #include "core/Group.h"
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2RandomStream.h"
@@ -35,6 +36,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
                                    QSharedPointer<const CompositeKey> key,
                                    Database* db)
 {
+    TRACE_SCOPE("kdbx", "readDatabaseImpl");
     Q_ASSERT(m_kdbxVersion <= KeePass2::FILE_VERSION_3_1);
 
     if (hasError()) {
@@ -135,7 +137,7 @@ bool Kdbx3Reader::readDatabaseImpl(QIODevice* device,
     return true;
 }
 
-bool Kdbx3Reader::readHeaderField(StoreDataStream& headerStream, Database* db)
+bool Kdbx3Reader::readHeaderField(QIODevice& headerStream, Database* db)
 {
     Q_UNUSED(db);
 
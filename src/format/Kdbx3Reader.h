@@ -35,7 +35,7 @@ public:
                           Database* db) override;
 
 protected:
-    bool readHeaderField(StoreDataStream& headerStream, Database* db) override;
+    bool readHeaderField(QIODevice& headerStream, Database* db) override;
 };
 
 #endif // KEEPASSX_KDBX3READER_H
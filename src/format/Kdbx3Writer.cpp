@@ -27,7 +27,6 @@
 #include "format/KeePass2.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HashedBlockStream.h"
-#include "streams/QtIOCompressor"
 #include "streams/SymmetricCipherStream.h"
 
 bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
@@ -111,13 +110,12 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     QIODevice* outputDevice = nullptr;
-    QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<QIODevice> ioCompressor;
 
     if (db->compressionAlgorithm() == Database::CompressionNone) {
         outputDevice = &hashedStream;
     } else {
-        ioCompressor.reset(new QtIOCompressor(&hashedStream));
-        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        ioCompressor.reset(createCompressor(&hashedStream, db));
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
             return false;
@@ -134,12 +132,13 @@ bool Kdbx3Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     KdbxXmlWriter xmlWriter(formatVersion());
+    xmlWriter.setParallelSerialization(true);
     xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
 
     // Explicitly close/reset streams so they are flushed and we can detect
     // errors. QIODevice::close() resets errorString() etc.
-    if (ioCompressor) {
-        ioCompressor->close();
+    if (ioCompressor && !closeCompressor(ioCompressor.data())) {
+        return false;
     }
     if (!hashedStream.reset()) {
         raiseError(hashedStream.errorString());
@@ -22,6 +22,7 @@
 #include "core/AsyncTask.h"
 #include "core/Endian.h"
 #include "core/Group.h"
+#include "core/Trace.h"
 #include "crypto/CryptoHash.h"
 #include "format/KdbxXmlReader.h"
 #include "format/KeePass2RandomStream.h"
@@ -34,6 +35,7 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
                                    QSharedPointer<const CompositeKey> key,
                                    Database* db)
 {
+    TRACE_SCOPE("kdbx", "readDatabaseImpl");
     Q_ASSERT(m_kdbxVersion == KeePass2::FILE_VERSION_4);
 
     m_binaryPool.clear();
@@ -140,7 +142,7 @@ bool Kdbx4Reader::readDatabaseImpl(QIODevice* device,
     return true;
 }
 
-bool Kdbx4Reader::readHeaderField(StoreDataStream& device, Database* db)
+bool Kdbx4Reader::readHeaderField(QIODevice& device, Database* db)
 {
     QByteArray fieldIDArray = device.read(1);
     if (fieldIDArray.size() != 1) {
@@ -37,7 +37,7 @@ public:
     QHash<QString, QByteArray> binaryPool() const;
 
 protected:
-    bool readHeaderField(StoreDataStream& headerStream, Database* db) override;
+    bool readHeaderField(QIODevice& headerStream, Database* db) override;
 
 private:
     bool readInnerHeaderField(QIODevice* device);
@@ -28,7 +28,6 @@
 #include "format/KdbxXmlWriter.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/HmacBlockStream.h"
-#include "streams/QtIOCompressor"
 #include "streams/SymmetricCipherStream.h"
 
 bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
@@ -47,6 +46,8 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
         return false;
     }
 
+    // Seed, IV and KDF salt are renewed on every save and the payload is always re-encrypted in full.
+    // Reusing unchanged blocks of the previous file would reuse the keystream for the changed ones.
     QByteArray masterSeed = randomGen()->randomArray(32);
     QByteArray encryptionIV = randomGen()->randomArray(ivSize);
     QByteArray protectedStreamKey = randomGen()->randomArray(64);
@@ -137,13 +138,12 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     QIODevice* outputDevice = nullptr;
-    QScopedPointer<QtIOCompressor> ioCompressor;
+    QScopedPointer<QIODevice> ioCompressor;
 
     if (db->compressionAlgorithm() == Database::CompressionNone) {
         outputDevice = cipherStream.data();
     } else {
-        ioCompressor.reset(new QtIOCompressor(cipherStream.data()));
-        ioCompressor->setStreamFormat(QtIOCompressor::GzipFormat);
+        ioCompressor.reset(createCompressor(cipherStream.data(), db));
         if (!ioCompressor->open(QIODevice::WriteOnly)) {
             raiseError(ioCompressor->errorString());
             return false;
@@ -172,12 +172,13 @@ bool Kdbx4Writer::writeDatabase(QIODevice* device, Database* db)
     }
 
     KdbxXmlWriter xmlWriter(formatVersion());
+    xmlWriter.setParallelSerialization(true);
     xmlWriter.writeDatabase(outputDevice, db, &randomStream, headerHash);
 
     // Explicitly close/reset streams so they are flushed and we can detect
     // errors. QIODevice::close() resets errorString() etc.
-    if (ioCompressor) {
-        ioCompressor->close();
+    if (ioCompressor && !closeCompressor(ioCompressor.data())) {
+        return false;
     }
     if (!cipherStream->reset()) {
         raiseError(cipherStream->errorString());
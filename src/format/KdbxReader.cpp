@@ -20,6 +20,8 @@
 #include "KdbxReader.h"
 #include "core/Database.h"
 #include "core/Endian.h"
+#include "core/Trace.h"
+#include "streams/StoreDataStream.h"
 
 #include <QBuffer>
 
@@ -63,6 +65,7 @@ bool KdbxReader::readMagicNumbers(QIODevice* device, quint32& sig1, quint32& sig
  */
 bool KdbxReader::readDatabase(QIODevice* device, QSharedPointer<const CompositeKey> key, Database* db)
 {
+    TRACE_SCOPE("kdbx", "readDatabase");
     device->seek(0);
 
     m_db = db;
@@ -71,12 +74,19 @@ bool KdbxReader::readDatabase(QIODevice* device, QSharedPointer<const CompositeK
     m_streamStartBytes.clear();
     m_protectedStreamKey.clear();
 
+    // in-memory and memory-mapped input is parsed in place, other devices
+    // go through a stream that keeps a copy of the header for the checksums
+    auto* buffer = qobject_cast<QBuffer*>(device);
     StoreDataStream headerStream(device);
-    headerStream.open(QIODevice::ReadOnly);
+    QIODevice* headerDevice = device;
+    if (!buffer) {
+        headerStream.open(QIODevice::ReadOnly);
+        headerDevice = &headerStream;
+    }
 
     // read KDBX magic numbers
     quint32 sig1, sig2;
-    if (!readMagicNumbers(&headerStream, sig1, sig2, m_kdbxVersion)) {
+    if (!readMagicNumbers(headerDevice, sig1, sig2, m_kdbxVersion)) {
         return false;
     }
     m_kdbxSignature = qMakePair(sig1, sig2);
@@ -85,17 +95,23 @@ bool KdbxReader::readDatabase(QIODevice* device, QSharedPointer<const CompositeK
     m_kdbxVersion &= KeePass2::FILE_VERSION_CRITICAL_MASK;
 
     // read header fields
-    while (readHeaderField(headerStream, m_db) && !hasError()) {
+    while (readHeaderField(*headerDevice, m_db) && !hasError()) {
     }
 
-    headerStream.close();
-
     if (hasError()) {
         return false;
     }
 
+    QByteArray headerData;
+    if (buffer) {
+        headerData = QByteArray::fromRawData(buffer->data().constData(), static_cast<int>(buffer->pos()));
+    } else {
+        headerStream.close();
+        headerData = headerStream.storedData();
+    }
+
     // read payload
-    return readDatabaseImpl(device, headerStream.storedData(), std::move(key), db);
+    return readDatabaseImpl(device, headerData, std::move(key), db);
 }
 
 bool KdbxReader::hasError() const
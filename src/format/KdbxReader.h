@@ -20,7 +20,6 @@
 
 #include "KeePass2.h"
 #include "keys/CompositeKey.h"
-#include "streams/StoreDataStream.h"
 
 #include <QCoreApplication>
 #include <QPointer>
@@ -69,7 +68,7 @@ protected:
      * @param database to read header field for
      * @return true if there are more header fields
      */
-    virtual bool readHeaderField(StoreDataStream& headerStream, Database* db) = 0;
+    virtual bool readHeaderField(QIODevice& headerStream, Database* db) = 0;
 
     virtual void setCipher(const QByteArray& data);
     virtual void setCompressionFlags(const QByteArray& data);
@@ -18,8 +18,12 @@
 #include "KdbxWriter.h"
 
 #include <QBuffer>
+#include <QThread>
 
+#include "core/Database.h"
 #include "format/KdbxXmlWriter.h"
+#include "streams/ParallelGzipStream.h"
+#include "streams/QtIOCompressor"
 
 bool KdbxWriter::hasError() const
 {
@@ -66,14 +70,76 @@ bool KdbxWriter::writeData(QIODevice* device, const QByteArray& data)
     return true;
 }
 
+/**
+ * Create a gzip stream on top of a device with the compression level
+ * and buffer size of the database. Multiple threads are used if the
+ * machine has more than one core.
+ *
+ * @param device device the compressed data is written to
+ * @param db database being written
+ * @return unopened compression stream, owned by the caller
+ */
+QIODevice* KdbxWriter::createCompressor(QIODevice* device, const Database* db)
+{
+    if (QThread::idealThreadCount() > 1) {
+        return new ParallelGzipStream(device, db->compressionLevel(), db->compressionBufferSize());
+    }
+
+    auto* compressor = new QtIOCompressor(device, db->compressionLevel(), db->compressionBufferSize());
+    compressor->setStreamFormat(QtIOCompressor::GzipFormat);
+    return compressor;
+}
+
+/**
+ * Flush and close a stream returned by createCompressor().
+ *
+ * The parallel compressor does most of its work while finishing, so its
+ * errors are checked here before close() discards them.
+ *
+ * @param compressor compression stream
+ * @return true on success
+ */
+bool KdbxWriter::closeCompressor(QIODevice* compressor)
+{
+    auto* parallelCompressor = qobject_cast<ParallelGzipStream*>(compressor);
+    if (parallelCompressor && !parallelCompressor->finish()) {
+        raiseError(parallelCompressor->errorString());
+        compressor->close();
+        return false;
+    }
+
+    compressor->close();
+    return true;
+}
+
 void KdbxWriter::extractDatabase(QByteArray& xmlOutput, Database* db)
 {
     QBuffer buffer;
     buffer.setBuffer(&xmlOutput);
     buffer.open(QIODevice::WriteOnly);
+    extractDatabase(&buffer, db);
+}
+
+/**
+ * Write the unencrypted XML representation of a database to a device.
+ *
+ * The XML is flushed to the device in chunks while it is generated,
+ * so memory usage does not grow with the size of the database.
+ *
+ * @param device output device
+ * @param db source database
+ * @return true on success
+ */
+bool KdbxWriter::extractDatabase(QIODevice* device, Database* db)
+{
     KdbxXmlWriter writer(formatVersion());
     writer.disableInnerStreamProtection(true);
-    writer.writeDatabase(&buffer, db);
+    writer.writeDatabase(device, db);
+    if (writer.hasError()) {
+        raiseError(writer.errorString());
+        return false;
+    }
+    return true;
 }
 
 /**
@@ -58,6 +58,7 @@ public:
     virtual quint32 formatVersion() = 0;
 
     void extractDatabase(QByteArray& xmlOutput, Database* db);
+    bool extractDatabase(QIODevice* device, Database* db);
 
     bool hasError() const;
     QString errorString() const;
@@ -87,6 +88,8 @@ protected:
     }
 
     bool writeData(QIODevice* device, const QByteArray& data);
+    QIODevice* createCompressor(QIODevice* device, const Database* db);
+    bool closeCompressor(QIODevice* compressor);
     void raiseError(const QString& errorMessage);
 
     bool m_error = false;
@@ -19,19 +19,294 @@
 #include "KeePass2RandomStream.h"
 #include "core/Clock.h"
 #include "core/DatabaseIcons.h"
-#include "core/Endian.h"
 #include "core/Entry.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "streams/QtIOCompressor"
 
 #include <QBuffer>
 #include <QFile>
+#include <QVector>
+#include <QtEndian>
+
+#include <algorithm>
 #include <utility>
 
 #define UUID_LENGTH 16
 
+namespace
+{
+    /**
+     * Tokens for the element names known to the reader. Elements are looked up
+     * once when they are entered, so dispatching on them does not need any
+     * string comparisons or allocations.
+     */
+    enum class Element
+    {
+        Unknown,
+        KeePassFile,
+        Meta,
+        Root,
+        Generator,
+        HeaderHash,
+        DatabaseName,
+        DatabaseNameChanged,
+        DatabaseDescription,
+        DatabaseDescriptionChanged,
+        DefaultUserName,
+        DefaultUserNameChanged,
+        MaintenanceHistoryDays,
+        Color,
+        MasterKeyChanged,
+        MasterKeyChangeRec,
+        MasterKeyChangeForce,
+        MemoryProtection,
+        CustomIcons,
+        RecycleBinEnabled,
+        RecycleBinUUID,
+        RecycleBinChanged,
+        EntryTemplatesGroup,
+        EntryTemplatesGroupChanged,
+        LastSelectedGroup,
+        LastTopVisibleGroup,
+        HistoryMaxItems,
+        HistoryMaxSize,
+        Binaries,
+        CustomData,
+        SettingsChanged,
+        ProtectTitle,
+        ProtectUserName,
+        ProtectPassword,
+        ProtectURL,
+        ProtectNotes,
+        Icon,
+        UUID,
+        Data,
+        Binary,
+        Item,
+        Key,
+        Value,
+        Group,
+        DeletedObjects,
+        Name,
+        Notes,
+        IconID,
+        CustomIconUUID,
+        Times,
+        IsExpanded,
+        DefaultAutoTypeSequence,
+        EnableAutoType,
+        EnableSearching,
+        LastTopVisibleEntry,
+        Entry,
+        DeletedObject,
+        DeletionTime,
+        ForegroundColor,
+        BackgroundColor,
+        OverrideURL,
+        Tags,
+        String,
+        AutoType,
+        History,
+        Enabled,
+        DataTransferObfuscation,
+        DefaultSequence,
+        Association,
+        Window,
+        KeystrokeSequence,
+        LastModificationTime,
+        CreationTime,
+        LastAccessTime,
+        ExpiryTime,
+        Expires,
+        UsageCount,
+        LocationChanged
+    };
+
+    struct ElementName
+    {
+        QLatin1String name;
+        Element element;
+    };
+
+    bool lessThan(const ElementName& lhs, const ElementName& rhs)
+    {
+        if (lhs.name.size() != rhs.name.size()) {
+            return lhs.name.size() < rhs.name.size();
+        }
+        return qstrncmp(lhs.name.data(), rhs.name.data(), lhs.name.size()) < 0;
+    }
+
+    /**
+     * Element name table, ordered by length first so most lookups are
+     * decided by comparing sizes.
+     */
+    const QVector<ElementName>& elementNames()
+    {
+        static const QVector<ElementName> names = [] {
+            QVector<ElementName> table{
+            {QLatin1String("KeePassFile"), Element::KeePassFile},
+            {QLatin1String("Meta"), Element::Meta},
+            {QLatin1String("Root"), Element::Root},
+            {QLatin1String("Generator"), Element::Generator},
+            {QLatin1String("HeaderHash"), Element::HeaderHash},
+            {QLatin1String("DatabaseName"), Element::DatabaseName},
+            {QLatin1String("DatabaseNameChanged"), Element::DatabaseNameChanged},
+            {QLatin1String("DatabaseDescription"), Element::DatabaseDescription},
+            {QLatin1String("DatabaseDescriptionChanged"), Element::DatabaseDescriptionChanged},
+            {QLatin1String("DefaultUserName"), Element::DefaultUserName},
+            {QLatin1String("DefaultUserNameChanged"), Element::DefaultUserNameChanged},
+            {QLatin1String("MaintenanceHistoryDays"), Element::MaintenanceHistoryDays},
+            {QLatin1String("Color"), Element::Color},
+            {QLatin1String("MasterKeyChanged"), Element::MasterKeyChanged},
+            {QLatin1String("MasterKeyChangeRec"), Element::MasterKeyChangeRec},
+            {QLatin1String("MasterKeyChangeForce"), Element::MasterKeyChangeForce},
+            {QLatin1String("MemoryProtection"), Element::MemoryProtection},
+            {QLatin1String("CustomIcons"), Element::CustomIcons},
+            {QLatin1String("RecycleBinEnabled"), Element::RecycleBinEnabled},
+            {QLatin1String("RecycleBinUUID"), Element::RecycleBinUUID},
+            {QLatin1String("RecycleBinChanged"), Element::RecycleBinChanged},
+            {QLatin1String("EntryTemplatesGroup"), Element::EntryTemplatesGroup},
+            {QLatin1String("EntryTemplatesGroupChanged"), Element::EntryTemplatesGroupChanged},
+            {QLatin1String("LastSelectedGroup"), Element::LastSelectedGroup},
+            {QLatin1String("LastTopVisibleGroup"), Element::LastTopVisibleGroup},
+            {QLatin1String("HistoryMaxItems"), Element::HistoryMaxItems},
+            {QLatin1String("HistoryMaxSize"), Element::HistoryMaxSize},
+            {QLatin1String("Binaries"), Element::Binaries},
+            {QLatin1String("CustomData"), Element::CustomData},
+            {QLatin1String("SettingsChanged"), Element::SettingsChanged},
+            {QLatin1String("ProtectTitle"), Element::ProtectTitle},
+            {QLatin1String("ProtectUserName"), Element::ProtectUserName},
+            {QLatin1String("ProtectPassword"), Element::ProtectPassword},
+            {QLatin1String("ProtectURL"), Element::ProtectURL},
+            {QLatin1String("ProtectNotes"), Element::ProtectNotes},
+            {QLatin1String("Icon"), Element::Icon},
+            {QLatin1String("UUID"), Element::UUID},
+            {QLatin1String("Data"), Element::Data},
+            {QLatin1String("Binary"), Element::Binary},
+            {QLatin1String("Item"), Element::Item},
+            {QLatin1String("Key"), Element::Key},
+            {QLatin1String("Value"), Element::Value},
+            {QLatin1String("Group"), Element::Group},
+            {QLatin1String("DeletedObjects"), Element::DeletedObjects},
+            {QLatin1String("Name"), Element::Name},
+            {QLatin1String("Notes"), Element::Notes},
+            {QLatin1String("IconID"), Element::IconID},
+            {QLatin1String("CustomIconUUID"), Element::CustomIconUUID},
+            {QLatin1String("Times"), Element::Times},
+            {QLatin1String("IsExpanded"), Element::IsExpanded},
+            {QLatin1String("DefaultAutoTypeSequence"), Element::DefaultAutoTypeSequence},
+            {QLatin1String("EnableAutoType"), Element::EnableAutoType},
+            {QLatin1String("EnableSearching"), Element::EnableSearching},
+            {QLatin1String("LastTopVisibleEntry"), Element::LastTopVisibleEntry},
+            {QLatin1String("Entry"), Element::Entry},
+            {QLatin1String("DeletedObject"), Element::DeletedObject},
+            {QLatin1String("DeletionTime"), Element::DeletionTime},
+            {QLatin1String("ForegroundColor"), Element::ForegroundColor},
+            {QLatin1String("BackgroundColor"), Element::BackgroundColor},
+            {QLatin1String("OverrideURL"), Element::OverrideURL},
+            {QLatin1String("Tags"), Element::Tags},
+            {QLatin1String("String"), Element::String},
+            {QLatin1String("AutoType"), Element::AutoType},
+            {QLatin1String("History"), Element::History},
+            {QLatin1String("Enabled"), Element::Enabled},
+            {QLatin1String("DataTransferObfuscation"), Element::DataTransferObfuscation},
+            {QLatin1String("DefaultSequence"), Element::DefaultSequence},
+            {QLatin1String("Association"), Element::Association},
+            {QLatin1String("Window"), Element::Window},
+            {QLatin1String("KeystrokeSequence"), Element::KeystrokeSequence},
+            {QLatin1String("LastModificationTime"), Element::LastModificationTime},
+            {QLatin1String("CreationTime"), Element::CreationTime},
+            {QLatin1String("LastAccessTime"), Element::LastAccessTime},
+            {QLatin1String("ExpiryTime"), Element::ExpiryTime},
+            {QLatin1String("Expires"), Element::Expires},
+            {QLatin1String("UsageCount"), Element::UsageCount},
+            {QLatin1String("LocationChanged"), Element::LocationChanged}};
+            std::sort(table.begin(), table.end(), lessThan);
+            return table;
+        }();
+        return names;
+    }
+
+    Element elementOf(const QStringRef& name)
+    {
+        const QVector<ElementName>& names = elementNames();
+        auto it = std::lower_bound(
+            names.cbegin(), names.cend(), name, [](const ElementName& item, const QStringRef& value) {
+                if (item.name.size() != value.size()) {
+                    return item.name.size() < value.size();
+                }
+                return value.compare(item.name) > 0;
+            });
+        if (it != names.cend() && it->name.size() == name.size() && name.compare(it->name) == 0) {
+            return it->element;
+        }
+        return Element::Unknown;
+    }
+
+    int base64Value(ushort c)
+    {
+        if (c >= 'A' && c <= 'Z') {
+            return c - 'A';
+        }
+        if (c >= 'a' && c <= 'z') {
+            return c - 'a' + 26;
+        }
+        if (c >= '0' && c <= '9') {
+            return c - '0' + 52;
+        }
+        if (c == '+') {
+            return 62;
+        }
+        if (c == '/') {
+            return 63;
+        }
+        return -1;
+    }
+
+    /**
+     * Decode strictly formatted base64 text without intermediate copies.
+     * At most maxLength bytes are written to out.
+     *
+     * @return total number of decoded bytes or -1 if the text is not base64
+     */
+    int decodeBase64(const QString& text, uchar* out, int maxLength)
+    {
+        const int length = text.size();
+        if (length % 4 != 0) {
+            return -1;
+        }
+
+        const QChar* data = text.constData();
+        int decoded = 0;
+        for (int i = 0; i < length; i += 4) {
+            quint32 bits = 0;
+            int padding = 0;
+            for (int j = 0; j < 4; ++j) {
+                const ushort c = data[i + j].unicode();
+                int value = base64Value(c);
+                if (c == '=' && i + 4 == length && j >= 2) {
+                    value = 0;
+                    ++padding;
+                } else if (value < 0 || padding > 0) {
+                    return -1;
+                }
+                bits = (bits << 6) | static_cast<quint32>(value);
+            }
+
+            for (int k = 0; k < 3 - padding; ++k) {
+                if (decoded < maxLength) {
+                    out[decoded] = static_cast<uchar>((bits >> (16 - 8 * k)) & 0xFF);
+                }
+                ++decoded;
+            }
+        }
+        return decoded;
+    }
+} // namespace
+
 /**
  * @param version KDBX version
  */
@@ -85,6 +360,7 @@ QSharedPointer<Database> KdbxXmlReader::readDatabase(QIODevice* device)
  */
 void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2RandomStream* randomStream)
 {
+    TRACE_SCOPE("kdbx", "readXml");
     m_error = false;
     m_errorStr.clear();
 
@@ -97,6 +373,7 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
 
     m_randomStream = randomStream;
     m_headerHash.clear();
+    m_stringPool.clear();
 
     m_tmpParent.reset(new Group());
 
@@ -107,7 +384,7 @@ void KdbxXmlReader::readDatabase(QIODevice* device, Database* db, KeePass2Random
         return;
     }
 
-    if (m_xml.readNextStartElement() && m_xml.name() == "KeePassFile") {
+    if (m_xml.readNextStartElement() && elementOf(m_xml.name()) == Element::KeePassFile) {
         rootGroupParsed = parseKeePassFile();
     }
 
@@ -214,12 +491,13 @@ bool KdbxXmlReader::parseKeePassFile()
     bool rootParsedSuccessfully = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Meta") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Meta) {
             parseMeta();
             continue;
         }
 
-        if (m_xml.name() == "Root") {
+        if (element == Element::Root) {
             if (rootElementFound) {
                 rootParsedSuccessfully = false;
                 qWarning("Multiple root elements");
@@ -241,69 +519,70 @@ void KdbxXmlReader::parseMeta()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Meta");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Generator") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Generator) {
             m_meta->setGenerator(readString());
-        } else if (m_xml.name() == "HeaderHash") {
+        } else if (element == Element::HeaderHash) {
             m_headerHash = readBinary();
-        } else if (m_xml.name() == "DatabaseName") {
+        } else if (element == Element::DatabaseName) {
             m_meta->setName(readString());
-        } else if (m_xml.name() == "DatabaseNameChanged") {
+        } else if (element == Element::DatabaseNameChanged) {
             m_meta->setNameChanged(readDateTime());
-        } else if (m_xml.name() == "DatabaseDescription") {
+        } else if (element == Element::DatabaseDescription) {
             m_meta->setDescription(readString());
-        } else if (m_xml.name() == "DatabaseDescriptionChanged") {
+        } else if (element == Element::DatabaseDescriptionChanged) {
             m_meta->setDescriptionChanged(readDateTime());
-        } else if (m_xml.name() == "DefaultUserName") {
+        } else if (element == Element::DefaultUserName) {
             m_meta->setDefaultUserName(readString());
-        } else if (m_xml.name() == "DefaultUserNameChanged") {
+        } else if (element == Element::DefaultUserNameChanged) {
             m_meta->setDefaultUserNameChanged(readDateTime());
-        } else if (m_xml.name() == "MaintenanceHistoryDays") {
+        } else if (element == Element::MaintenanceHistoryDays) {
             m_meta->setMaintenanceHistoryDays(readNumber());
-        } else if (m_xml.name() == "Color") {
+        } else if (element == Element::Color) {
             m_meta->setColor(readColor());
-        } else if (m_xml.name() == "MasterKeyChanged") {
+        } else if (element == Element::MasterKeyChanged) {
             m_meta->setDatabaseKeyChanged(readDateTime());
-        } else if (m_xml.name() == "MasterKeyChangeRec") {
+        } else if (element == Element::MasterKeyChangeRec) {
             m_meta->setMasterKeyChangeRec(readNumber());
-        } else if (m_xml.name() == "MasterKeyChangeForce") {
+        } else if (element == Element::MasterKeyChangeForce) {
             m_meta->setMasterKeyChangeForce(readNumber());
-        } else if (m_xml.name() == "MemoryProtection") {
+        } else if (element == Element::MemoryProtection) {
             parseMemoryProtection();
-        } else if (m_xml.name() == "CustomIcons") {
+        } else if (element == Element::CustomIcons) {
             parseCustomIcons();
-        } else if (m_xml.name() == "RecycleBinEnabled") {
+        } else if (element == Element::RecycleBinEnabled) {
             m_meta->setRecycleBinEnabled(readBool());
-        } else if (m_xml.name() == "RecycleBinUUID") {
+        } else if (element == Element::RecycleBinUUID) {
             m_meta->setRecycleBin(getGroup(readUuid()));
-        } else if (m_xml.name() == "RecycleBinChanged") {
+        } else if (element == Element::RecycleBinChanged) {
             m_meta->setRecycleBinChanged(readDateTime());
-        } else if (m_xml.name() == "EntryTemplatesGroup") {
+        } else if (element == Element::EntryTemplatesGroup) {
             m_meta->setEntryTemplatesGroup(getGroup(readUuid()));
-        } else if (m_xml.name() == "EntryTemplatesGroupChanged") {
+        } else if (element == Element::EntryTemplatesGroupChanged) {
             m_meta->setEntryTemplatesGroupChanged(readDateTime());
-        } else if (m_xml.name() == "LastSelectedGroup") {
+        } else if (element == Element::LastSelectedGroup) {
             m_meta->setLastSelectedGroup(getGroup(readUuid()));
-        } else if (m_xml.name() == "LastTopVisibleGroup") {
+        } else if (element == Element::LastTopVisibleGroup) {
             m_meta->setLastTopVisibleGroup(getGroup(readUuid()));
-        } else if (m_xml.name() == "HistoryMaxItems") {
+        } else if (element == Element::HistoryMaxItems) {
             int value = readNumber();
             if (value >= -1) {
                 m_meta->setHistoryMaxItems(value);
             } else {
                 qWarning("HistoryMaxItems invalid number");
             }
-        } else if (m_xml.name() == "HistoryMaxSize") {
+        } else if (element == Element::HistoryMaxSize) {
             int value = readNumber();
             if (value >= -1) {
                 m_meta->setHistoryMaxSize(value);
             } else {
                 qWarning("HistoryMaxSize invalid number");
             }
-        } else if (m_xml.name() == "Binaries") {
+        } else if (element == Element::Binaries) {
             parseBinaries();
-        } else if (m_xml.name() == "CustomData") {
+        } else if (element == Element::CustomData) {
             parseCustomData(m_meta->customData());
-        } else if (m_xml.name() == "SettingsChanged") {
+        } else if (element == Element::SettingsChanged) {
             m_meta->setSettingsChanged(readDateTime());
         } else {
             skipCurrentElement();
@@ -316,15 +595,16 @@ void KdbxXmlReader::parseMemoryProtection()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "MemoryProtection");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "ProtectTitle") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::ProtectTitle) {
             m_meta->setProtectTitle(readBool());
-        } else if (m_xml.name() == "ProtectUserName") {
+        } else if (element == Element::ProtectUserName) {
             m_meta->setProtectUsername(readBool());
-        } else if (m_xml.name() == "ProtectPassword") {
+        } else if (element == Element::ProtectPassword) {
             m_meta->setProtectPassword(readBool());
-        } else if (m_xml.name() == "ProtectURL") {
+        } else if (element == Element::ProtectURL) {
             m_meta->setProtectUrl(readBool());
-        } else if (m_xml.name() == "ProtectNotes") {
+        } else if (element == Element::ProtectNotes) {
             m_meta->setProtectNotes(readBool());
         } else {
             skipCurrentElement();
@@ -334,10 +614,12 @@ void KdbxXmlReader::parseMemoryProtection()
 
 void KdbxXmlReader::parseCustomIcons()
 {
+    TRACE_SCOPE("kdbx", "parseCustomIcons");
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "CustomIcons");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Icon") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Icon) {
             parseIcon();
         } else {
             skipCurrentElement();
@@ -350,16 +632,18 @@ void KdbxXmlReader::parseIcon()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Icon");
 
     QUuid uuid;
-    QImage icon;
+    QByteArray icon;
     bool uuidSet = false;
     bool iconSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::UUID) {
             uuid = readUuid();
             uuidSet = !uuid.isNull();
-        } else if (m_xml.name() == "Data") {
-            icon.loadFromData(readBinary());
+        } else if (element == Element::Data) {
+            // decoding is deferred until the icon is displayed
+            icon = readBinary();
             iconSet = true;
         } else {
             skipCurrentElement();
@@ -383,7 +667,8 @@ void KdbxXmlReader::parseBinaries()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "Binaries");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() != "Binary") {
+        const Element element = elementOf(m_xml.name());
+        if (element != Element::Binary) {
             skipCurrentElement();
             continue;
         }
@@ -405,7 +690,8 @@ void KdbxXmlReader::parseCustomData(CustomData* customData)
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "CustomData");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Item") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Item) {
             parseCustomDataItem(customData);
             continue;
         }
@@ -423,10 +709,11 @@ void KdbxXmlReader::parseCustomDataItem(CustomData* customData)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Key) {
             key = readString();
             keySet = true;
-        } else if (m_xml.name() == "Value") {
+        } else if (element == Element::Value) {
             value = readString();
             valueSet = true;
         } else {
@@ -450,7 +737,8 @@ bool KdbxXmlReader::parseRoot()
     bool groupParsedSuccessfully = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Group") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Group) {
             if (groupElementFound) {
                 groupParsedSuccessfully = false;
                 raiseError(tr("Multiple group elements"));
@@ -466,7 +754,7 @@ bool KdbxXmlReader::parseRoot()
             }
 
             groupElementFound = true;
-        } else if (m_xml.name() == "DeletedObjects") {
+        } else if (element == Element::DeletedObjects) {
             parseDeletedObjects();
         } else {
             skipCurrentElement();
@@ -485,7 +773,8 @@ Group* KdbxXmlReader::parseGroup()
     QList<Group*> children;
     QList<Entry*> entries;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::UUID) {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -498,15 +787,15 @@ Group* KdbxXmlReader::parseGroup()
             }
             continue;
         }
-        if (m_xml.name() == "Name") {
+        if (element == Element::Name) {
             group->setName(readString());
             continue;
         }
-        if (m_xml.name() == "Notes") {
+        if (element == Element::Notes) {
             group->setNotes(readString());
             continue;
         }
-        if (m_xml.name() == "IconID") {
+        if (element == Element::IconID) {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -521,26 +810,26 @@ Group* KdbxXmlReader::parseGroup()
             group->setIcon(iconId);
             continue;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        if (element == Element::CustomIconUUID) {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 group->setIcon(uuid);
             }
             continue;
         }
-        if (m_xml.name() == "Times") {
+        if (element == Element::Times) {
             group->setTimeInfo(parseTimes());
             continue;
         }
-        if (m_xml.name() == "IsExpanded") {
+        if (element == Element::IsExpanded) {
             group->setExpanded(readBool());
             continue;
         }
-        if (m_xml.name() == "DefaultAutoTypeSequence") {
+        if (element == Element::DefaultAutoTypeSequence) {
             group->setDefaultAutoTypeSequence(readString());
             continue;
         }
-        if (m_xml.name() == "EnableAutoType") {
+        if (element == Element::EnableAutoType) {
             QString str = readString();
 
             if (str.compare("null", Qt::CaseInsensitive) == 0) {
@@ -554,7 +843,7 @@ Group* KdbxXmlReader::parseGroup()
             }
             continue;
         }
-        if (m_xml.name() == "EnableSearching") {
+        if (element == Element::EnableSearching) {
             QString str = readString();
 
             if (str.compare("null", Qt::CaseInsensitive) == 0) {
@@ -568,25 +857,25 @@ Group* KdbxXmlReader::parseGroup()
             }
             continue;
         }
-        if (m_xml.name() == "LastTopVisibleEntry") {
+        if (element == Element::LastTopVisibleEntry) {
             group->setLastTopVisibleEntry(getEntry(readUuid()));
             continue;
         }
-        if (m_xml.name() == "Group") {
+        if (element == Element::Group) {
             Group* newGroup = parseGroup();
             if (newGroup) {
                 children.append(newGroup);
             }
             continue;
         }
-        if (m_xml.name() == "Entry") {
+        if (element == Element::Entry) {
             Entry* newEntry = parseEntry(false);
             if (newEntry) {
                 entries.append(newEntry);
             }
             continue;
         }
-        if (m_xml.name() == "CustomData") {
+        if (element == Element::CustomData) {
             parseCustomData(group->customData());
             continue;
         }
@@ -624,7 +913,8 @@ void KdbxXmlReader::parseDeletedObjects()
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "DeletedObjects");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "DeletedObject") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::DeletedObject) {
             parseDeletedObject();
         } else {
             skipCurrentElement();
@@ -639,7 +929,8 @@ void KdbxXmlReader::parseDeletedObject()
     DeletedObject delObj{{}, {}};
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::UUID) {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -651,7 +942,7 @@ void KdbxXmlReader::parseDeletedObject()
             delObj.uuid = uuid;
             continue;
         }
-        if (m_xml.name() == "DeletionTime") {
+        if (element == Element::DeletionTime) {
             delObj.deletionTime = readDateTime();
             continue;
         }
@@ -678,7 +969,8 @@ Entry* KdbxXmlReader::parseEntry(bool history)
     QList<StringPair> binaryRefs;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "UUID") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::UUID) {
             QUuid uuid = readUuid();
             if (uuid.isNull()) {
                 if (m_strictMode) {
@@ -691,7 +983,7 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             }
             continue;
         }
-        if (m_xml.name() == "IconID") {
+        if (element == Element::IconID) {
             int iconId = readNumber();
             if (iconId < 0) {
                 if (m_strictMode) {
@@ -702,49 +994,49 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             entry->setIcon(iconId);
             continue;
         }
-        if (m_xml.name() == "CustomIconUUID") {
+        if (element == Element::CustomIconUUID) {
             QUuid uuid = readUuid();
             if (!uuid.isNull()) {
                 entry->setIcon(uuid);
             }
             continue;
         }
-        if (m_xml.name() == "ForegroundColor") {
+        if (element == Element::ForegroundColor) {
             entry->setForegroundColor(readColor());
             continue;
         }
-        if (m_xml.name() == "BackgroundColor") {
+        if (element == Element::BackgroundColor) {
             entry->setBackgroundColor(readColor());
             continue;
         }
-        if (m_xml.name() == "OverrideURL") {
+        if (element == Element::OverrideURL) {
             entry->setOverrideUrl(readString());
             continue;
         }
-        if (m_xml.name() == "Tags") {
-            entry->setTags(readString());
+        if (element == Element::Tags) {
+            entry->setTags(internString(readString()));
             continue;
         }
-        if (m_xml.name() == "Times") {
+        if (element == Element::Times) {
             entry->setTimeInfo(parseTimes());
             continue;
         }
-        if (m_xml.name() == "String") {
+        if (element == Element::String) {
             parseEntryString(entry);
             continue;
         }
-        if (m_xml.name() == "Binary") {
+        if (element == Element::Binary) {
             QPair<QString, QString> ref = parseEntryBinary(entry);
             if (!ref.first.isEmpty() && !ref.second.isEmpty()) {
                 binaryRefs.append(ref);
             }
             continue;
         }
-        if (m_xml.name() == "AutoType") {
+        if (element == Element::AutoType) {
             parseAutoType(entry);
             continue;
         }
-        if (m_xml.name() == "History") {
+        if (element == Element::History) {
             if (history) {
                 raiseError(tr("History element in history entry"));
             } else {
@@ -752,7 +1044,7 @@ Entry* KdbxXmlReader::parseEntry(bool history)
             }
             continue;
         }
-        if (m_xml.name() == "CustomData") {
+        if (element == Element::CustomData) {
             parseCustomData(entry->customData());
             continue;
         }
@@ -808,14 +1100,14 @@ void KdbxXmlReader::parseEntryString(Entry* entry)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
-            key = readString();
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Key) {
+            key = internString(readString());
             keySet = true;
             continue;
         }
 
-        if (m_xml.name() == "Value") {
-            QXmlStreamAttributes attr = m_xml.attributes();
+        if (element == Element::Value) {
             bool isProtected;
             bool protectInMemory;
             value = readString(isProtected, protectInMemory);
@@ -852,12 +1144,13 @@ QPair<QString, QString> KdbxXmlReader::parseEntryBinary(Entry* entry)
     bool valueSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Key") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Key) {
             key = readString();
             keySet = true;
             continue;
         }
-        if (m_xml.name() == "Value") {
+        if (element == Element::Value) {
             QXmlStreamAttributes attr = m_xml.attributes();
 
             if (attr.hasAttribute("Ref")) {
@@ -894,13 +1187,14 @@ void KdbxXmlReader::parseAutoType(Entry* entry)
     Q_ASSERT(m_xml.isStartElement() && m_xml.name() == "AutoType");
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Enabled") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Enabled) {
             entry->setAutoTypeEnabled(readBool());
-        } else if (m_xml.name() == "DataTransferObfuscation") {
+        } else if (element == Element::DataTransferObfuscation) {
             entry->setAutoTypeObfuscation(readNumber());
-        } else if (m_xml.name() == "DefaultSequence") {
+        } else if (element == Element::DefaultSequence) {
             entry->setDefaultAutoTypeSequence(readString());
-        } else if (m_xml.name() == "Association") {
+        } else if (element == Element::Association) {
             parseAutoTypeAssoc(entry);
         } else {
             skipCurrentElement();
@@ -917,10 +1211,11 @@ void KdbxXmlReader::parseAutoTypeAssoc(Entry* entry)
     bool sequenceSet = false;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Window") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Window) {
             assoc.window = readString();
             windowSet = true;
-        } else if (m_xml.name() == "KeystrokeSequence") {
+        } else if (element == Element::KeystrokeSequence) {
             assoc.sequence = readString();
             sequenceSet = true;
         } else {
@@ -942,7 +1237,8 @@ QList<Entry*> KdbxXmlReader::parseEntryHistory()
     QList<Entry*> historyItems;
 
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "Entry") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::Entry) {
             historyItems.append(parseEntry(true));
         } else {
             skipCurrentElement();
@@ -958,19 +1254,20 @@ TimeInfo KdbxXmlReader::parseTimes()
 
     TimeInfo timeInfo;
     while (!m_xml.hasError() && m_xml.readNextStartElement()) {
-        if (m_xml.name() == "LastModificationTime") {
+        const Element element = elementOf(m_xml.name());
+        if (element == Element::LastModificationTime) {
             timeInfo.setLastModificationTime(readDateTime());
-        } else if (m_xml.name() == "CreationTime") {
+        } else if (element == Element::CreationTime) {
             timeInfo.setCreationTime(readDateTime());
-        } else if (m_xml.name() == "LastAccessTime") {
+        } else if (element == Element::LastAccessTime) {
             timeInfo.setLastAccessTime(readDateTime());
-        } else if (m_xml.name() == "ExpiryTime") {
+        } else if (element == Element::ExpiryTime) {
             timeInfo.setExpiryTime(readDateTime());
-        } else if (m_xml.name() == "Expires") {
+        } else if (element == Element::Expires) {
             timeInfo.setExpires(readBool());
-        } else if (m_xml.name() == "UsageCount") {
+        } else if (element == Element::UsageCount) {
             timeInfo.setUsageCount(readNumber());
-        } else if (m_xml.name() == "LocationChanged") {
+        } else if (element == Element::LocationChanged) {
             timeInfo.setLocationChanged(readDateTime());
         } else {
             skipCurrentElement();
@@ -996,16 +1293,14 @@ QString KdbxXmlReader::readString(bool& isProtected, bool& protectInMemory)
     QString value = m_xml.readElementText();
 
     if (isProtected && !value.isEmpty()) {
-        QByteArray ciphertext = QByteArray::fromBase64(value.toLatin1());
-        bool ok;
-        QByteArray plaintext = m_randomStream->process(ciphertext, &ok);
-        if (!ok) {
+        QByteArray data = QByteArray::fromBase64(value.toLatin1());
+        if (!m_randomStream->processInPlace(data)) {
             value.clear();
             raiseError(m_randomStream->errorString());
             return value;
         }
 
-        value = QString::fromUtf8(plaintext);
+        value = QString::fromUtf8(data);
     }
 
     return value;
@@ -1030,11 +1325,16 @@ bool KdbxXmlReader::readBool()
 
 QDateTime KdbxXmlReader::readDateTime()
 {
+    static const QDateTime epoch(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC);
+
     QString str = readString();
-    if (Tools::isBase64(str.toLatin1())) {
-        QByteArray secsBytes = QByteArray::fromBase64(str.toUtf8()).leftJustified(8, '\0', true).left(8);
-        qint64 secs = Endian::bytesToSizedInt<quint64>(secsBytes, KeePass2::BYTEORDER);
-        return QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).addSecs(secs);
+
+    // KDBX 4 stores the seconds since year 1 as base64 encoded 64 bit integer
+    uchar secsBytes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    if (decodeBase64(str, secsBytes, sizeof(secsBytes)) >= 0) {
+        Q_STATIC_ASSERT(KeePass2::BYTEORDER == QSysInfo::LittleEndian);
+        qint64 secs = static_cast<qint64>(qFromLittleEndian<quint64>(secsBytes));
+        return epoch.addSecs(secs);
     }
 
     QDateTime dt = Clock::parse(str, Qt::ISODate);
@@ -1091,7 +1391,22 @@ int KdbxXmlReader::readNumber()
 
 QUuid KdbxXmlReader::readUuid()
 {
-    QByteArray uuidBin = readBinary();
+    if (!isTrueValue(m_xml.attributes().value("Protected"))) {
+        // fast path, decode the text straight into the uuid bytes
+        const QString value = m_xml.readElementText();
+        uchar uuidBytes[UUID_LENGTH];
+        if (decodeBase64(value, uuidBytes, UUID_LENGTH) == UUID_LENGTH) {
+            return QUuid::fromRfc4122(
+                QByteArray::fromRawData(reinterpret_cast<const char*>(uuidBytes), UUID_LENGTH));
+        }
+        return uuidFromBinary(QByteArray::fromBase64(value.toLatin1()));
+    }
+
+    return uuidFromBinary(readBinary());
+}
+
+QUuid KdbxXmlReader::uuidFromBinary(const QByteArray& uuidBin)
+{
     if (uuidBin.isEmpty()) {
         return QUuid();
     }
@@ -1112,15 +1427,11 @@ QByteArray KdbxXmlReader::readBinary()
     QByteArray data = QByteArray::fromBase64(value.toLatin1());
 
     if (isProtected && !data.isEmpty()) {
-        bool ok;
-        QByteArray plaintext = m_randomStream->process(data, &ok);
-        if (!ok) {
+        if (!m_randomStream->processInPlace(data)) {
             data.clear();
             raiseError(m_randomStream->errorString());
             return data;
         }
-
-        data = plaintext;
     }
 
     return data;
@@ -1145,6 +1456,25 @@ QByteArray KdbxXmlReader::readCompressedBinary()
     return result;
 }
 
+/**
+ * Return a shared copy of a string that occurs many times in a database,
+ * such as attribute keys and tags, so equal values share their storage.
+ */
+QString KdbxXmlReader::internString(const QString& value)
+{
+    if (value.isEmpty()) {
+        return value;
+    }
+
+    auto it = m_stringPool.constFind(value);
+    if (it != m_stringPool.constEnd()) {
+        return it.value();
+    }
+
+    m_stringPool.insert(value, value);
+    return value;
+}
+
 Group* KdbxXmlReader::getGroup(const QUuid& uuid)
 {
     if (uuid.isNull()) {
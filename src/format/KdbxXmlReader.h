@@ -86,11 +86,14 @@ protected:
     virtual QString readColor();
     virtual int readNumber();
     virtual QUuid readUuid();
+    QUuid uuidFromBinary(const QByteArray& uuidBin);
     virtual QByteArray readBinary();
     virtual QByteArray readCompressedBinary();
 
     virtual void skipCurrentElement();
 
+    QString internString(const QString& value);
+
     virtual Group* getGroup(const QUuid& uuid);
     virtual Entry* getEntry(const QUuid& uuid);
 
@@ -112,6 +115,7 @@ protected:
 
     QHash<QString, QByteArray> m_binaryPool;
     QHash<QString, QPair<Entry*, QString>> m_binaryMap;
+    QHash<QString, QString> m_stringPool;
     QByteArray m_headerHash;
 
     bool m_error = false;
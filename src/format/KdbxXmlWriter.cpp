@@ -19,12 +19,37 @@
 
 #include <QBuffer>
 #include <QFile>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <algorithm>
+#include <sodium.h>
 
-#include "core/Endian.h"
 #include "core/Metadata.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/QtIOCompressor"
 
+namespace
+{
+    // XML is collected in chunks of this size before it is handed to the
+    // output device, so compression and encryption see large writes
+    const int OutputChunkSize = 1024 * 1024;
+
+    // below this many entries (including history) the thread handoff costs
+    // more than serializing the group subtrees in parallel saves
+    const int ParallelSerializationMinEntries = 2000;
+
+    bool isInvalidXml10Char(ushort uc)
+    {
+        return (uc < 0x20 && uc != 0x09 && uc != 0x0A && uc != 0x0D) // control characters
+               || (uc >= 0x7F && uc <= 0x84) // control characters, valid but discouraged by XML
+               || (uc >= 0x86 && uc <= 0x9F) // control characters, valid but discouraged by XML
+               || (uc > 0xFFFD) // noncharacter
+               || QChar::isSurrogate(uc); // single surrogate, valid pairs are handled by the caller
+    }
+} // namespace
+
 /**
  * @param version KDBX version
  */
@@ -42,6 +67,7 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
     m_meta = db->metadata();
     m_randomStream = randomStream;
     m_headerHash = headerHash;
+    m_device = device;
 
     m_xml.setAutoFormatting(true);
     m_xml.setAutoFormattingIndent(-1); // 1 tab
@@ -49,9 +75,14 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
 
     generateIdMap();
 
-    m_xml.setDevice(device);
+    m_outputData.clear();
+    m_outputData.reserve(OutputChunkSize + OutputChunkSize / 4);
+    m_outputBuffer.setBuffer(&m_outputData);
+    m_outputBuffer.open(QIODevice::WriteOnly);
+
+    m_xml.setDevice(&m_outputBuffer);
     m_xml.writeStartDocument("1.0", true);
-    m_xml.writeStartElement("KeePassFile");
+    m_xml.writeStartElement(QStringLiteral("KeePassFile"));
 
     writeMetadata();
     writeRoot();
@@ -59,7 +90,12 @@ void KdbxXmlWriter::writeDatabase(QIODevice* device,
     m_xml.writeEndElement();
     m_xml.writeEndDocument();
 
-    if (m_xml.hasError()) {
+    flushOutput(true);
+    m_xml.setDevice(nullptr);
+    m_outputBuffer.close();
+    m_outputData.clear();
+
+    if (m_xml.hasError() && !m_error) {
         raiseError(device->errorString());
     }
 }
@@ -81,10 +117,31 @@ QString KdbxXmlWriter::errorString()
     return m_errorStr;
 }
 
+/**
+ * Pass the collected XML on to the output device once a full chunk is
+ * available, or unconditionally if force is set.
+ */
+void KdbxXmlWriter::flushOutput(bool force)
+{
+    // subtree writers keep everything in memory until it is merged
+    if (!m_device || m_outputData.isEmpty() || (!force && m_outputData.size() < OutputChunkSize)) {
+        return;
+    }
+
+    if (!m_error && m_device->write(m_outputData) != m_outputData.size()) {
+        raiseError(m_device->errorString());
+    }
+
+    // keeps the reserved capacity for the next chunk
+    m_outputData.resize(0);
+    m_outputBuffer.seek(0);
+}
+
 void KdbxXmlWriter::generateIdMap()
 {
     const QList<Entry*> allEntries = m_db->rootGroup()->entriesRecursive(true);
     int nextId = 0;
+    m_entryCount = allEntries.size();
 
     for (Entry* entry : allEntries) {
         const QList<QString> attachmentKeys = entry->attachments()->keys();
@@ -99,35 +156,35 @@ void KdbxXmlWriter::generateIdMap()
 
 void KdbxXmlWriter::writeMetadata()
 {
-    m_xml.writeStartElement("Meta");
-    writeString("Generator", m_meta->generator());
+    m_xml.writeStartElement(QStringLiteral("Meta"));
+    writeString(QStringLiteral("Generator"), m_meta->generator());
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4 && !m_headerHash.isEmpty()) {
-        writeBinary("HeaderHash", m_headerHash);
-    }
-    writeString("DatabaseName", m_meta->name());
-    writeDateTime("DatabaseNameChanged", m_meta->nameChanged());
-    writeString("DatabaseDescription", m_meta->description());
-    writeDateTime("DatabaseDescriptionChanged", m_meta->descriptionChanged());
-    writeString("DefaultUserName", m_meta->defaultUserName());
-    writeDateTime("DefaultUserNameChanged", m_meta->defaultUserNameChanged());
-    writeNumber("MaintenanceHistoryDays", m_meta->maintenanceHistoryDays());
-    writeString("Color", m_meta->color());
-    writeDateTime("MasterKeyChanged", m_meta->databaseKeyChanged());
-    writeNumber("MasterKeyChangeRec", m_meta->databaseKeyChangeRec());
-    writeNumber("MasterKeyChangeForce", m_meta->databaseKeyChangeForce());
+        writeBinary(QStringLiteral("HeaderHash"), m_headerHash);
+    }
+    writeString(QStringLiteral("DatabaseName"), m_meta->name());
+    writeDateTime(QStringLiteral("DatabaseNameChanged"), m_meta->nameChanged());
+    writeString(QStringLiteral("DatabaseDescription"), m_meta->description());
+    writeDateTime(QStringLiteral("DatabaseDescriptionChanged"), m_meta->descriptionChanged());
+    writeString(QStringLiteral("DefaultUserName"), m_meta->defaultUserName());
+    writeDateTime(QStringLiteral("DefaultUserNameChanged"), m_meta->defaultUserNameChanged());
+    writeNumber(QStringLiteral("MaintenanceHistoryDays"), m_meta->maintenanceHistoryDays());
+    writeString(QStringLiteral("Color"), m_meta->color());
+    writeDateTime(QStringLiteral("MasterKeyChanged"), m_meta->databaseKeyChanged());
+    writeNumber(QStringLiteral("MasterKeyChangeRec"), m_meta->databaseKeyChangeRec());
+    writeNumber(QStringLiteral("MasterKeyChangeForce"), m_meta->databaseKeyChangeForce());
     writeMemoryProtection();
     writeCustomIcons();
-    writeBool("RecycleBinEnabled", m_meta->recycleBinEnabled());
-    writeUuid("RecycleBinUUID", m_meta->recycleBin());
-    writeDateTime("RecycleBinChanged", m_meta->recycleBinChanged());
-    writeUuid("EntryTemplatesGroup", m_meta->entryTemplatesGroup());
-    writeDateTime("EntryTemplatesGroupChanged", m_meta->entryTemplatesGroupChanged());
-    writeUuid("LastSelectedGroup", m_meta->lastSelectedGroup());
-    writeUuid("LastTopVisibleGroup", m_meta->lastTopVisibleGroup());
-    writeNumber("HistoryMaxItems", m_meta->historyMaxItems());
-    writeNumber("HistoryMaxSize", m_meta->historyMaxSize());
+    writeBool(QStringLiteral("RecycleBinEnabled"), m_meta->recycleBinEnabled());
+    writeUuid(QStringLiteral("RecycleBinUUID"), m_meta->recycleBin());
+    writeDateTime(QStringLiteral("RecycleBinChanged"), m_meta->recycleBinChanged());
+    writeUuid(QStringLiteral("EntryTemplatesGroup"), m_meta->entryTemplatesGroup());
+    writeDateTime(QStringLiteral("EntryTemplatesGroupChanged"), m_meta->entryTemplatesGroupChanged());
+    writeUuid(QStringLiteral("LastSelectedGroup"), m_meta->lastSelectedGroup());
+    writeUuid(QStringLiteral("LastTopVisibleGroup"), m_meta->lastTopVisibleGroup());
+    writeNumber(QStringLiteral("HistoryMaxItems"), m_meta->historyMaxItems());
+    writeNumber(QStringLiteral("HistoryMaxSize"), m_meta->historyMaxSize());
     if (m_kdbxVersion >= KeePass2::FILE_VERSION_4) {
-        writeDateTime("SettingsChanged", m_meta->settingsChanged());
+        writeDateTime(QStringLiteral("SettingsChanged"), m_meta->settingsChanged());
     }
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4) {
         writeBinaries();
@@ -139,59 +196,52 @@ void KdbxXmlWriter::writeMetadata()
 
 void KdbxXmlWriter::writeMemoryProtection()
 {
-    m_xml.writeStartElement("MemoryProtection");
+    m_xml.writeStartElement(QStringLiteral("MemoryProtection"));
 
-    writeBool("ProtectTitle", m_meta->protectTitle());
-    writeBool("ProtectUserName", m_meta->protectUsername());
-    writeBool("ProtectPassword", m_meta->protectPassword());
-    writeBool("ProtectURL", m_meta->protectUrl());
-    writeBool("ProtectNotes", m_meta->protectNotes());
+    writeBool(QStringLiteral("ProtectTitle"), m_meta->protectTitle());
+    writeBool(QStringLiteral("ProtectUserName"), m_meta->protectUsername());
+    writeBool(QStringLiteral("ProtectPassword"), m_meta->protectPassword());
+    writeBool(QStringLiteral("ProtectURL"), m_meta->protectUrl());
+    writeBool(QStringLiteral("ProtectNotes"), m_meta->protectNotes());
 
     m_xml.writeEndElement();
 }
 
 void KdbxXmlWriter::writeCustomIcons()
 {
-    m_xml.writeStartElement("CustomIcons");
+    m_xml.writeStartElement(QStringLiteral("CustomIcons"));
 
     const QList<QUuid> customIconsOrder = m_meta->customIconsOrder();
     for (const QUuid& uuid : customIconsOrder) {
-        writeIcon(uuid, m_meta->customIcon(uuid));
+        writeIcon(uuid, m_meta->customIconData(uuid));
     }
 
     m_xml.writeEndElement();
 }
 
-void KdbxXmlWriter::writeIcon(const QUuid& uuid, const QImage& icon)
+void KdbxXmlWriter::writeIcon(const QUuid& uuid, const QByteArray& iconData)
 {
-    m_xml.writeStartElement("Icon");
-
-    writeUuid("UUID", uuid);
+    m_xml.writeStartElement(QStringLiteral("Icon"));
 
-    QByteArray ba;
-    QBuffer buffer(&ba);
-    buffer.open(QIODevice::WriteOnly);
-    // TODO: check !icon.save()
-    icon.save(&buffer, "PNG");
-    buffer.close();
-    writeBinary("Data", ba);
+    writeUuid(QStringLiteral("UUID"), uuid);
+    writeBinary(QStringLiteral("Data"), iconData);
 
     m_xml.writeEndElement();
 }
 
 void KdbxXmlWriter::writeBinaries()
 {
-    m_xml.writeStartElement("Binaries");
+    m_xml.writeStartElement(QStringLiteral("Binaries"));
 
     QHash<QByteArray, int>::const_iterator i;
     for (i = m_idMap.constBegin(); i != m_idMap.constEnd(); ++i) {
-        m_xml.writeStartElement("Binary");
+        m_xml.writeStartElement(QStringLiteral("Binary"));
 
-        m_xml.writeAttribute("ID", QString::number(i.value()));
+        m_xml.writeAttribute(QStringLiteral("ID"), QString::number(i.value()));
 
         QByteArray data;
         if (m_db->compressionAlgorithm() == Database::CompressionGZip) {
-            m_xml.writeAttribute("Compressed", "True");
+            m_xml.writeAttribute(QStringLiteral("Compressed"), QStringLiteral("True"));
 
             QBuffer buffer;
             buffer.open(QIODevice::ReadWrite);
@@ -215,6 +265,7 @@ void KdbxXmlWriter::writeBinaries()
             m_xml.writeCharacters(QString::fromLatin1(data.toBase64()));
         }
         m_xml.writeEndElement();
+        flushOutput();
     }
 
     m_xml.writeEndElement();
@@ -225,7 +276,7 @@ void KdbxXmlWriter::writeCustomData(const CustomData* customData)
     if (customData->isEmpty()) {
         return;
     }
-    m_xml.writeStartElement("CustomData");
+    m_xml.writeStartElement(QStringLiteral("CustomData"));
 
     const QList<QString> keyList = customData->keys();
     for (const QString& key : keyList) {
@@ -237,10 +288,10 @@ void KdbxXmlWriter::writeCustomData(const CustomData* customData)
 
 void KdbxXmlWriter::writeCustomDataItem(const QString& key, const QString& value)
 {
-    m_xml.writeStartElement("Item");
+    m_xml.writeStartElement(QStringLiteral("Item"));
 
-    writeString("Key", key);
-    writeString("Value", value);
+    writeString(QStringLiteral("Key"), key);
+    writeString(QStringLiteral("Value"), value);
 
     m_xml.writeEndElement();
 }
@@ -249,7 +300,7 @@ void KdbxXmlWriter::writeRoot()
 {
     Q_ASSERT(m_db->rootGroup());
 
-    m_xml.writeStartElement("Root");
+    m_xml.writeStartElement(QStringLiteral("Root"));
 
     writeGroup(m_db->rootGroup());
     writeDeletedObjects();
@@ -261,25 +312,25 @@ void KdbxXmlWriter::writeGroup(const Group* group)
 {
     Q_ASSERT(!group->uuid().isNull());
 
-    m_xml.writeStartElement("Group");
+    m_xml.writeStartElement(QStringLiteral("Group"));
 
-    writeUuid("UUID", group->uuid());
-    writeString("Name", group->name());
-    writeString("Notes", group->notes());
-    writeNumber("IconID", group->iconNumber());
+    writeUuid(QStringLiteral("UUID"), group->uuid());
+    writeString(QStringLiteral("Name"), group->name());
+    writeString(QStringLiteral("Notes"), group->notes());
+    writeNumber(QStringLiteral("IconID"), group->iconNumber());
 
     if (!group->iconUuid().isNull()) {
-        writeUuid("CustomIconUUID", group->iconUuid());
+        writeUuid(QStringLiteral("CustomIconUUID"), group->iconUuid());
     }
     writeTimes(group->timeInfo());
-    writeBool("IsExpanded", group->isExpanded());
-    writeString("DefaultAutoTypeSequence", group->defaultAutoTypeSequence());
+    writeBool(QStringLiteral("IsExpanded"), group->isExpanded());
+    writeString(QStringLiteral("DefaultAutoTypeSequence"), group->defaultAutoTypeSequence());
 
-    writeTriState("EnableAutoType", group->autoTypeEnabled());
+    writeTriState(QStringLiteral("EnableAutoType"), group->autoTypeEnabled());
 
-    writeTriState("EnableSearching", group->searchingEnabled());
+    writeTriState(QStringLiteral("EnableSearching"), group->searchingEnabled());
 
-    writeUuid("LastTopVisibleEntry", group->lastTopVisibleEntry());
+    writeUuid(QStringLiteral("LastTopVisibleEntry"), group->lastTopVisibleEntry());
 
     if (m_kdbxVersion >= KeePass2::FILE_VERSION_4) {
         writeCustomData(group->customData());
@@ -291,31 +342,131 @@ void KdbxXmlWriter::writeGroup(const Group* group)
     }
 
     const QList<Group*>& children = group->children();
-    for (const Group* child : children) {
-        writeGroup(child);
+    if (m_parallelSerialization && group == m_db->rootGroup() && children.size() > 1
+        && m_entryCount >= ParallelSerializationMinEntries && QThreadPool::globalInstance()->maxThreadCount() > 1) {
+        writeGroupsParallel(children);
+    } else {
+        for (const Group* child : children) {
+            writeGroup(child);
+        }
     }
 
     m_xml.writeEndElement();
+    flushOutput();
+}
+
+/**
+ * Serialize the given sibling groups on the global thread pool and write
+ * them to the output in their original order.
+ *
+ * Protected values have to be encrypted with the inner random stream in
+ * document order, so the subtree writers only leave placeholders. The
+ * keystream is applied here, subtree by subtree, before the XML is merged.
+ */
+void KdbxXmlWriter::writeGroupsParallel(const QList<Group*>& groups)
+{
+    // the subtrees are filled in place, so no other copies of the
+    // protected values are left behind in the futures
+    QVector<Subtree> subtrees(groups.size());
+    Subtree* const results = subtrees.data();
+    QList<QFuture<void>> futures;
+    for (int i = 0; i < groups.size(); ++i) {
+        const Group* group = groups.at(i);
+        Subtree* subtree = results + i;
+        futures.append(QtConcurrent::run([this, group, subtree] { serializeSubtree(group, *subtree); }));
+    }
+
+    for (int i = 0; i < futures.size(); ++i) {
+        futures[i].waitForFinished();
+        Subtree& subtree = results[i];
+        if (m_error) {
+            continue;
+        }
+        if (subtree.error) {
+            raiseError(subtree.errorString);
+            continue;
+        }
+
+        char* xml = subtree.xml.data();
+        for (DeferredValue& value : subtree.protectedValues) {
+            if (!m_randomStream->processInPlace(value.data)) {
+                raiseError(m_randomStream->errorString());
+                break;
+            }
+            const QByteArray encoded = value.data.toBase64();
+            std::copy(encoded.constBegin(), encoded.constEnd(), xml + value.offset);
+        }
+
+        // the previous element is always complete at this point, so the
+        // raw XML can go straight to the buffer behind the stream writer
+        m_outputBuffer.write(subtree.xml);
+        flushOutput();
+    }
+}
+
+/**
+ * Serialize a child group of the root group into a separate buffer.
+ * Runs on a worker thread and only reads from the database.
+ */
+void KdbxXmlWriter::serializeSubtree(const Group* group, Subtree& subtree) const
+{
+    KdbxXmlWriter writer(m_kdbxVersion);
+    writer.m_db = m_db;
+    writer.m_meta = m_meta;
+    writer.m_randomStream = m_randomStream;
+    writer.m_innerStreamProtectionDisabled = m_innerStreamProtectionDisabled;
+    writer.m_idMap = m_idMap;
+    writer.m_deferredValues = &subtree.protectedValues;
+
+    writer.m_outputBuffer.setBuffer(&writer.m_outputData);
+    writer.m_outputBuffer.open(QIODevice::WriteOnly);
+    writer.m_xml.setAutoFormatting(true);
+    writer.m_xml.setAutoFormattingIndent(-1); // 1 tab
+    writer.m_xml.setCodec("UTF-8");
+    writer.m_xml.setDevice(&writer.m_outputBuffer);
+
+    // open the same elements as the main writer so indentation matches
+    writer.m_xml.writeStartElement(QStringLiteral("KeePassFile"));
+    writer.m_xml.writeStartElement(QStringLiteral("Root"));
+    writer.m_xml.writeStartElement(QStringLiteral("Group"));
+    // +1 for the '>' still pending on the open start tag
+    const int start = writer.m_outputData.size() + 1;
+    writer.writeGroup(group);
+    const int end = writer.m_outputData.size();
+
+    subtree.xml = writer.m_outputData.mid(start, end - start);
+    for (DeferredValue& value : subtree.protectedValues) {
+        value.offset -= start;
+    }
+    subtree.error = writer.m_error;
+    subtree.errorString = writer.m_errorStr;
+}
+
+KdbxXmlWriter::Subtree::~Subtree()
+{
+    for (DeferredValue& value : protectedValues) {
+        sodium_memzero(value.data.data(), static_cast<std::size_t>(value.data.size()));
+    }
 }
 
 void KdbxXmlWriter::writeTimes(const TimeInfo& ti)
 {
-    m_xml.writeStartElement("Times");
+    m_xml.writeStartElement(QStringLiteral("Times"));
 
-    writeDateTime("LastModificationTime", ti.lastModificationTime());
-    writeDateTime("CreationTime", ti.creationTime());
-    writeDateTime("LastAccessTime", ti.lastAccessTime());
-    writeDateTime("ExpiryTime", ti.expiryTime());
-    writeBool("Expires", ti.expires());
-    writeNumber("UsageCount", ti.usageCount());
-    writeDateTime("LocationChanged", ti.locationChanged());
+    writeDateTime(QStringLiteral("LastModificationTime"), ti.lastModificationTime());
+    writeDateTime(QStringLiteral("CreationTime"), ti.creationTime());
+    writeDateTime(QStringLiteral("LastAccessTime"), ti.lastAccessTime());
+    writeDateTime(QStringLiteral("ExpiryTime"), ti.expiryTime());
+    writeBool(QStringLiteral("Expires"), ti.expires());
+    writeNumber(QStringLiteral("UsageCount"), ti.usageCount());
+    writeDateTime(QStringLiteral("LocationChanged"), ti.locationChanged());
 
     m_xml.writeEndElement();
 }
 
 void KdbxXmlWriter::writeDeletedObjects()
 {
-    m_xml.writeStartElement("DeletedObjects");
+    m_xml.writeStartElement(QStringLiteral("DeletedObjects"));
 
     const QList<DeletedObject> delObjList = m_db->deletedObjects();
     for (const DeletedObject& delObj : delObjList) {
@@ -327,10 +478,10 @@ void KdbxXmlWriter::writeDeletedObjects()
 
 void KdbxXmlWriter::writeDeletedObject(const DeletedObject& delObj)
 {
-    m_xml.writeStartElement("DeletedObject");
+    m_xml.writeStartElement(QStringLiteral("DeletedObject"));
 
-    writeUuid("UUID", delObj.uuid);
-    writeDateTime("DeletionTime", delObj.deletionTime);
+    writeUuid(QStringLiteral("UUID"), delObj.uuid);
+    writeDateTime(QStringLiteral("DeletionTime"), delObj.deletionTime);
 
     m_xml.writeEndElement();
 }
@@ -339,48 +490,56 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
 {
     Q_ASSERT(!entry->uuid().isNull());
 
-    m_xml.writeStartElement("Entry");
+    m_xml.writeStartElement(QStringLiteral("Entry"));
 
-    writeUuid("UUID", entry->uuid());
-    writeNumber("IconID", entry->iconNumber());
+    writeUuid(QStringLiteral("UUID"), entry->uuid());
+    writeNumber(QStringLiteral("IconID"), entry->iconNumber());
     if (!entry->iconUuid().isNull()) {
-        writeUuid("CustomIconUUID", entry->iconUuid());
+        writeUuid(QStringLiteral("CustomIconUUID"), entry->iconUuid());
     }
-    writeString("ForegroundColor", entry->foregroundColor());
-    writeString("BackgroundColor", entry->backgroundColor());
-    writeString("OverrideURL", entry->overrideUrl());
-    writeString("Tags", entry->tags());
+    writeString(QStringLiteral("ForegroundColor"), entry->foregroundColor());
+    writeString(QStringLiteral("BackgroundColor"), entry->backgroundColor());
+    writeString(QStringLiteral("OverrideURL"), entry->overrideUrl());
+    writeString(QStringLiteral("Tags"), entry->tags());
     writeTimes(entry->timeInfo());
 
     const QList<QString> attributesKeyList = entry->attributes()->keys();
     for (const QString& key : attributesKeyList) {
-        m_xml.writeStartElement("String");
+        m_xml.writeStartElement(QStringLiteral("String"));
 
         // clang-format off
         bool protect =
-            (((key == "Title") && m_meta->protectTitle()) || ((key == "UserName") && m_meta->protectUsername())
-            || ((key == "Password") && m_meta->protectPassword())
-            || ((key == "URL") && m_meta->protectUrl())
-            || ((key == "Notes") && m_meta->protectNotes())
+            (((key == EntryAttributes::TitleKey) && m_meta->protectTitle())
+            || ((key == EntryAttributes::UserNameKey) && m_meta->protectUsername())
+            || ((key == EntryAttributes::PasswordKey) && m_meta->protectPassword())
+            || ((key == EntryAttributes::URLKey) && m_meta->protectUrl())
+            || ((key == EntryAttributes::NotesKey) && m_meta->protectNotes())
             || entry->attributes()->isProtected(key));
         // clang-format on
 
-        writeString("Key", key);
+        writeString(QStringLiteral("Key"), key);
 
-        m_xml.writeStartElement("Value");
+        m_xml.writeStartElement(QStringLiteral("Value"));
         QString value;
 
         if (protect) {
             if (!m_innerStreamProtectionDisabled && m_randomStream) {
-                m_xml.writeAttribute("Protected", "True");
-                bool ok;
-                QByteArray rawData = m_randomStream->process(entry->attributes()->value(key).toUtf8(), &ok);
-                if (!ok) {
+                m_xml.writeAttribute(QStringLiteral("Protected"), QStringLiteral("True"));
+                QByteArray rawData = entry->attributes()->value(key).toUtf8();
+                if (m_deferredValues) {
+                    // the keystream is applied in document order once all subtrees are done
+                    if (!rawData.isEmpty()) {
+                        const int encodedSize = (rawData.size() + 2) / 3 * 4;
+                        m_xml.writeCharacters(QString(encodedSize, QLatin1Char('A')));
+                        m_deferredValues->append({m_outputData.size() - encodedSize, rawData});
+                    }
+                } else if (!m_randomStream->processInPlace(rawData)) {
                     raiseError(m_randomStream->errorString());
+                } else {
+                    value = QString::fromLatin1(rawData.toBase64());
                 }
-                value = QString::fromLatin1(rawData.toBase64());
             } else {
-                m_xml.writeAttribute("ProtectInMemory", "True");
+                m_xml.writeAttribute(QStringLiteral("ProtectInMemory"), QStringLiteral("True"));
                 value = entry->attributes()->value(key);
             }
         } else {
@@ -397,12 +556,12 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
 
     const QList<QString> attachmentsKeyList = entry->attachments()->keys();
     for (const QString& key : attachmentsKeyList) {
-        m_xml.writeStartElement("Binary");
+        m_xml.writeStartElement(QStringLiteral("Binary"));
 
-        writeString("Key", key);
+        writeString(QStringLiteral("Key"), key);
 
-        m_xml.writeStartElement("Value");
-        m_xml.writeAttribute("Ref", QString::number(m_idMap[entry->attachments()->value(key)]));
+        m_xml.writeStartElement(QStringLiteral("Value"));
+        m_xml.writeAttribute(QStringLiteral("Ref"), QString::number(m_idMap.value(entry->attachments()->value(key))));
         m_xml.writeEndElement();
 
         m_xml.writeEndElement();
@@ -420,15 +579,16 @@ void KdbxXmlWriter::writeEntry(const Entry* entry)
     }
 
     m_xml.writeEndElement();
+    flushOutput();
 }
 
 void KdbxXmlWriter::writeAutoType(const Entry* entry)
 {
-    m_xml.writeStartElement("AutoType");
+    m_xml.writeStartElement(QStringLiteral("AutoType"));
 
-    writeBool("Enabled", entry->autoTypeEnabled());
-    writeNumber("DataTransferObfuscation", entry->autoTypeObfuscation());
-    writeString("DefaultSequence", entry->defaultAutoTypeSequence());
+    writeBool(QStringLiteral("Enabled"), entry->autoTypeEnabled());
+    writeNumber(QStringLiteral("DataTransferObfuscation"), entry->autoTypeObfuscation());
+    writeString(QStringLiteral("DefaultSequence"), entry->defaultAutoTypeSequence());
 
     const QList<AutoTypeAssociations::Association> autoTypeAssociations = entry->autoTypeAssociations()->getAll();
     for (const AutoTypeAssociations::Association& assoc : autoTypeAssociations) {
@@ -440,17 +600,17 @@ void KdbxXmlWriter::writeAutoType(const Entry* entry)
 
 void KdbxXmlWriter::writeAutoTypeAssoc(const AutoTypeAssociations::Association& assoc)
 {
-    m_xml.writeStartElement("Association");
+    m_xml.writeStartElement(QStringLiteral("Association"));
 
-    writeString("Window", assoc.window);
-    writeString("KeystrokeSequence", assoc.sequence);
+    writeString(QStringLiteral("Window"), assoc.window);
+    writeString(QStringLiteral("KeystrokeSequence"), assoc.sequence);
 
     m_xml.writeEndElement();
 }
 
 void KdbxXmlWriter::writeEntryHistory(const Entry* entry)
 {
-    m_xml.writeStartElement("History");
+    m_xml.writeStartElement(QStringLiteral("History"));
 
     const QList<Entry*>& historyItems = entry->historyItems();
     for (const Entry* item : historyItems) {
@@ -469,18 +629,53 @@ void KdbxXmlWriter::writeString(const QString& qualifiedName, const QString& str
     }
 }
 
+/**
+ * Write the contents of the value buffer, which only ever holds
+ * characters that are valid in XML.
+ */
+void KdbxXmlWriter::writeValueBuffer(const QString& qualifiedName)
+{
+    if (m_valueBuffer.isEmpty()) {
+        m_xml.writeEmptyElement(qualifiedName);
+    } else {
+        m_xml.writeTextElement(qualifiedName, m_valueBuffer);
+    }
+}
+
+/**
+ * Resize the reusable value buffer. Its capacity is kept between calls,
+ * so formatting values does not allocate in the common case.
+ */
+QChar* KdbxXmlWriter::valueBuffer(int size)
+{
+    m_valueBuffer.resize(size);
+    return m_valueBuffer.data();
+}
+
 void KdbxXmlWriter::writeNumber(const QString& qualifiedName, int number)
 {
-    writeString(qualifiedName, QString::number(number));
+    QChar digits[12];
+    int pos = sizeof(digits) / sizeof(digits[0]);
+    quint32 value = number < 0 ? 0u - static_cast<quint32>(number) : static_cast<quint32>(number);
+    do {
+        digits[--pos] = QLatin1Char(static_cast<char>('0' + value % 10));
+        value /= 10;
+    } while (value != 0);
+    if (number < 0) {
+        digits[--pos] = QLatin1Char('-');
+    }
+
+    const int length = static_cast<int>(sizeof(digits) / sizeof(digits[0])) - pos;
+    std::copy(digits + pos, digits + pos + length, valueBuffer(length));
+    writeValueBuffer(qualifiedName);
 }
 
 void KdbxXmlWriter::writeBool(const QString& qualifiedName, bool b)
 {
-    if (b) {
-        writeString(qualifiedName, "True");
-    } else {
-        writeString(qualifiedName, "False");
-    }
+    static const QString trueValue = QStringLiteral("True");
+    static const QString falseValue = QStringLiteral("False");
+
+    m_xml.writeTextElement(qualifiedName, b ? trueValue : falseValue);
 }
 
 void KdbxXmlWriter::writeDateTime(const QString& qualifiedName, const QDateTime& dateTime)
@@ -488,25 +683,33 @@ void KdbxXmlWriter::writeDateTime(const QString& qualifiedName, const QDateTime&
     Q_ASSERT(dateTime.isValid());
     Q_ASSERT(dateTime.timeSpec() == Qt::UTC);
 
-    QString dateTimeStr;
     if (m_kdbxVersion < KeePass2::FILE_VERSION_4) {
-        dateTimeStr = dateTime.toString(Qt::ISODate);
+        QString dateTimeStr = dateTime.toString(Qt::ISODate);
 
         // Qt < 4.8 doesn't append a 'Z' at the end
         if (!dateTimeStr.isEmpty() && dateTimeStr[dateTimeStr.size() - 1] != 'Z') {
             dateTimeStr.append('Z');
         }
+        writeString(qualifiedName, dateTimeStr);
     } else {
-        qint64 secs = QDateTime(QDate(1, 1, 1), QTime(0, 0, 0, 0), Qt::UTC).secsTo(dateTime);
-        QByteArray secsBytes = Endian::sizedIntToBytes(secs, KeePass2::BYTEORDER);
-        dateTimeStr = QString::fromLatin1(secsBytes.toBase64());
+        // milliseconds between 0001-01-01T00:00:00Z and the Unix epoch
+        const qint64 epochOffset = Q_INT64_C(62135596800000);
+        qint64 secs = (dateTime.toMSecsSinceEpoch() + epochOffset) / 1000;
+        uchar secsBytes[8];
+        Q_STATIC_ASSERT(KeePass2::BYTEORDER == QSysInfo::LittleEndian);
+        qToLittleEndian<quint64>(static_cast<quint64>(secs), secsBytes);
+        writeBase64(qualifiedName, secsBytes, sizeof(secsBytes));
     }
-    writeString(qualifiedName, dateTimeStr);
 }
 
 void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const QUuid& uuid)
 {
-    writeString(qualifiedName, uuid.toRfc4122().toBase64());
+    uchar uuidBytes[16];
+    qToBigEndian(uuid.data1, uuidBytes);
+    qToBigEndian(uuid.data2, uuidBytes + 4);
+    qToBigEndian(uuid.data3, uuidBytes + 6);
+    std::copy(uuid.data4, uuid.data4 + 8, uuidBytes + 8);
+    writeBase64(qualifiedName, uuidBytes, sizeof(uuidBytes));
 }
 
 void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Group* group)
@@ -529,22 +732,50 @@ void KdbxXmlWriter::writeUuid(const QString& qualifiedName, const Entry* entry)
 
 void KdbxXmlWriter::writeBinary(const QString& qualifiedName, const QByteArray& ba)
 {
-    writeString(qualifiedName, QString::fromLatin1(ba.toBase64()));
+    writeBase64(qualifiedName, reinterpret_cast<const uchar*>(ba.constData()), ba.size());
+}
+
+/**
+ * Base64 encode data straight into the value buffer and write it.
+ */
+void KdbxXmlWriter::writeBase64(const QString& qualifiedName, const uchar* data, int size)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    QChar* out = valueBuffer((size + 2) / 3 * 4);
+    int i = 0;
+    for (; i + 2 < size; i += 3) {
+        const quint32 bits = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        *out++ = QLatin1Char(alphabet[(bits >> 18) & 0x3F]);
+        *out++ = QLatin1Char(alphabet[(bits >> 12) & 0x3F]);
+        *out++ = QLatin1Char(alphabet[(bits >> 6) & 0x3F]);
+        *out++ = QLatin1Char(alphabet[bits & 0x3F]);
+    }
+    if (i < size) {
+        const bool twoBytes = i + 1 < size;
+        const quint32 bits = (data[i] << 16) | (twoBytes ? data[i + 1] << 8 : 0);
+        *out++ = QLatin1Char(alphabet[(bits >> 18) & 0x3F]);
+        *out++ = QLatin1Char(alphabet[(bits >> 12) & 0x3F]);
+        *out++ = twoBytes ? QLatin1Char(alphabet[(bits >> 6) & 0x3F]) : QLatin1Char('=');
+        *out++ = QLatin1Char('=');
+    }
+
+    writeValueBuffer(qualifiedName);
 }
 
 void KdbxXmlWriter::writeTriState(const QString& qualifiedName, Group::TriState triState)
 {
-    QString value;
+    static const QString inheritValue = QStringLiteral("null");
+    static const QString enableValue = QStringLiteral("true");
+    static const QString disableValue = QStringLiteral("false");
 
     if (triState == Group::Inherit) {
-        value = "null";
+        m_xml.writeTextElement(qualifiedName, inheritValue);
     } else if (triState == Group::Enable) {
-        value = "true";
+        m_xml.writeTextElement(qualifiedName, enableValue);
     } else {
-        value = "false";
+        m_xml.writeTextElement(qualifiedName, disableValue);
     }
-
-    writeString(qualifiedName, value);
 }
 
 QString KdbxXmlWriter::colorPartToString(int value)
@@ -557,28 +788,51 @@ QString KdbxXmlWriter::colorPartToString(int value)
     return str;
 }
 
-QString KdbxXmlWriter::stripInvalidXml10Chars(QString str)
+/**
+ * Remove characters that are not allowed in XML 1.0. Strings are scanned
+ * first and only copied if they actually contain invalid characters.
+ */
+QString KdbxXmlWriter::stripInvalidXml10Chars(const QString& str)
 {
-    for (int i = str.size() - 1; i >= 0; i--) {
-        const QChar ch = str.at(i);
-        const ushort uc = ch.unicode();
+    const QChar* data = str.constData();
+    const int size = str.size();
 
-        if (ch.isLowSurrogate() && i != 0 && str.at(i - 1).isHighSurrogate()) {
+    int i = 0;
+    for (; i < size; ++i) {
+        const ushort uc = data[i].unicode();
+        if (uc >= 0x20 && uc < 0x7F) {
+            continue;
+        }
+        if (QChar::isHighSurrogate(uc) && i + 1 < size && QChar::isLowSurrogate(data[i + 1].unicode())) {
             // keep valid surrogate pair
-            i--;
-        } else if ((uc < 0x20 && uc != 0x09 && uc != 0x0A && uc != 0x0D) // control characters
-                   || (uc >= 0x7F && uc <= 0x84) // control characters, valid but discouraged by XML
-                   || (uc >= 0x86 && uc <= 0x9F) // control characters, valid but discouraged by XML
-                   || (uc > 0xFFFD) // noncharacter
-                   || ch.isLowSurrogate() // single low surrogate
-                   || ch.isHighSurrogate()) // single high surrogate
-        {
+            ++i;
+            continue;
+        }
+        if (isInvalidXml10Char(uc)) {
+            break;
+        }
+    }
+
+    if (i == size) {
+        return str;
+    }
+
+    QString result;
+    result.reserve(size - 1);
+    result.append(data, i);
+    for (; i < size; ++i) {
+        const ushort uc = data[i].unicode();
+        if (QChar::isHighSurrogate(uc) && i + 1 < size && QChar::isLowSurrogate(data[i + 1].unicode())) {
+            result.append(data + i, 2);
+            ++i;
+        } else if (isInvalidXml10Char(uc)) {
             qWarning("Stripping invalid XML 1.0 codepoint %x", uc);
-            str.remove(i, 1);
+        } else {
+            result.append(data[i]);
         }
     }
 
-    return str;
+    return result;
 }
 
 void KdbxXmlWriter::raiseError(const QString& errorMessage)
@@ -599,6 +853,23 @@ void KdbxXmlWriter::disableInnerStreamProtection(bool disable)
     m_innerStreamProtectionDisabled = disable;
 }
 
+/**
+ * Serialize the child groups of the root group on multiple threads.
+ * Only takes effect for large databases, the output is identical to
+ * the sequential writer.
+ *
+ * @param enable true to allow parallel serialization
+ */
+void KdbxXmlWriter::setParallelSerialization(bool enable)
+{
+    m_parallelSerialization = enable;
+}
+
+bool KdbxXmlWriter::parallelSerialization() const
+{
+    return m_parallelSerialization;
+}
+
 /**
  * @return true if inner stream protection is disabled and protected
  *         fields will be saved in plaintext
@@ -18,8 +18,9 @@
 #ifndef KEEPASSX_KDBXXMLWRITER_H
 #define KEEPASSX_KDBXXMLWRITER_H
 
+#include <QBuffer>
 #include <QDateTime>
-#include <QImage>
+#include <QVector>
 #include <QXmlStreamWriter>
 
 #include "core/Database.h"
@@ -42,21 +43,51 @@ public:
     void writeDatabase(const QString& filename, Database* db);
     void disableInnerStreamProtection(bool disable);
     bool innerStreamProtectionDisabled() const;
+    void setParallelSerialization(bool enable);
+    bool parallelSerialization() const;
     bool hasError();
     QString errorString();
 
 private:
+    /**
+     * Protected value of a subtree serialized on a worker thread. The
+     * keystream has not been applied yet, the XML only contains a
+     * placeholder of the final base64 length at offset.
+     */
+    struct DeferredValue
+    {
+        int offset;
+        QByteArray data;
+    };
+
+    /**
+     * Output of a subtree writer. The plaintext of the protected values is
+     * wiped when the subtree is destroyed.
+     */
+    struct Subtree
+    {
+        ~Subtree();
+
+        QByteArray xml;
+        QVector<DeferredValue> protectedValues;
+        bool error = false;
+        QString errorString;
+    };
+
+    void flushOutput(bool force = false);
     void generateIdMap();
 
     void writeMetadata();
     void writeMemoryProtection();
     void writeCustomIcons();
-    void writeIcon(const QUuid& uuid, const QImage& icon);
+    void writeIcon(const QUuid& uuid, const QByteArray& iconData);
     void writeBinaries();
     void writeCustomData(const CustomData* customData);
     void writeCustomDataItem(const QString& key, const QString& value);
     void writeRoot();
     void writeGroup(const Group* group);
+    void writeGroupsParallel(const QList<Group*>& groups);
+    void serializeSubtree(const Group* group, Subtree& subtree) const;
     void writeTimes(const TimeInfo& ti);
     void writeDeletedObjects();
     void writeDeletedObject(const DeletedObject& delObj);
@@ -74,20 +105,30 @@ private:
     void writeUuid(const QString& qualifiedName, const Entry* entry);
     void writeBinary(const QString& qualifiedName, const QByteArray& ba);
     void writeTriState(const QString& qualifiedName, Group::TriState triState);
+    void writeBase64(const QString& qualifiedName, const uchar* data, int size);
+    void writeValueBuffer(const QString& qualifiedName);
+    QChar* valueBuffer(int size);
     QString colorPartToString(int value);
-    QString stripInvalidXml10Chars(QString str);
+    QString stripInvalidXml10Chars(const QString& str);
 
     void raiseError(const QString& errorMessage);
 
     const quint32 m_kdbxVersion;
 
     bool m_innerStreamProtectionDisabled = false;
+    bool m_parallelSerialization = false;
 
     QXmlStreamWriter m_xml;
+    QIODevice* m_device = nullptr;
+    QByteArray m_outputData;
+    QBuffer m_outputBuffer;
+    QString m_valueBuffer;
     QPointer<const Database> m_db;
     QPointer<const Metadata> m_meta;
     KeePass2RandomStream* m_randomStream = nullptr;
     QHash<QByteArray, int> m_idMap;
+    int m_entryCount = 0;
+    QVector<DeferredValue>* m_deferredValues = nullptr;
     QByteArray m_headerHash;
 
     bool m_error = false;
@@ -21,10 +21,13 @@
 #include <QImage>
 #include <QTextCodec>
 
+#include <climits>
+
 #include "core/Database.h"
 #include "core/Endian.h"
 #include "core/Entry.h"
 #include "core/Group.h"
+#include "core/ImportTask.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/CryptoHash.h"
@@ -52,6 +55,7 @@ KeePass1Reader::KeePass1Reader()
     , m_device(nullptr)
     , m_encryptionFlags(0)
     , m_transformRounds(0)
+    , m_importTask(nullptr)
     , m_error(false)
 {
 }
@@ -171,22 +175,37 @@ KeePass1Reader::readDatabase(QIODevice* device, const QString& password, QIODevi
         return {};
     }
 
+    const int total = static_cast<int>(qMin<quint64>(quint64(numGroups) + numEntries, INT_MAX));
+    int progress = 0;
+
     QList<Group*> groups;
     for (quint32 i = 0; i < numGroups; i++) {
+        if (isCanceled()) {
+            return {};
+        }
         Group* group = readGroup(cipherStream.data());
         if (!group) {
             return {};
         }
         groups.append(group);
+        if (m_importTask) {
+            m_importTask->setProgress(++progress, total);
+        }
     }
 
     QList<Entry*> entries;
     for (quint32 i = 0; i < numEntries; i++) {
+        if (isCanceled()) {
+            return {};
+        }
         Entry* entry = readEntry(cipherStream.data());
         if (!entry) {
             return {};
         }
         entries.append(entry);
+        if (m_importTask) {
+            m_importTask->setProgress(++progress, total);
+        }
     }
 
     if (!constructGroupTree(groups)) {
@@ -328,6 +347,11 @@ KeePass1Reader::testKeys(const QString& password, const QByteArray& keyfileData,
             }
         }
 
+        // every attempt runs the key transformation again
+        if (isCanceled()) {
+            return nullptr;
+        }
+
         QByteArray finalKey = key(passwordData, keyfileData);
         if (finalKey.isEmpty()) {
             return nullptr;
@@ -912,6 +936,23 @@ void KeePass1Reader::raiseError(const QString& errorMessage)
     m_errorStr = errorMessage;
 }
 
+/**
+ * Report progress to and check for cancellation of the import task, if any.
+ */
+void KeePass1Reader::setImportTask(ImportTask* task)
+{
+    m_importTask = task;
+}
+
+bool KeePass1Reader::isCanceled()
+{
+    if (m_importTask && m_importTask->isCanceled()) {
+        raiseError(tr("Import was canceled."));
+        return true;
+    }
+    return false;
+}
+
 QDateTime KeePass1Reader::dateFromPackedStruct(const QByteArray& data)
 {
     Q_ASSERT(data.size() == 5);
@@ -26,6 +26,7 @@
 class Database;
 class Entry;
 class Group;
+class ImportTask;
 class SymmetricCipherStream;
 class QIODevice;
 
@@ -40,6 +41,7 @@ public:
     QSharedPointer<Database> readDatabase(const QString& filename, const QString& password, const QString& keyfileName);
     bool hasError();
     QString errorString();
+    void setImportTask(ImportTask* task);
 
 private:
     enum PasswordEncoding
@@ -60,6 +62,7 @@ private:
     bool parseGroupTreeState(const QByteArray& data);
     bool parseCustomIcons4(const QByteArray& data);
     void raiseError(const QString& errorMessage);
+    bool isCanceled();
     static QByteArray readKeyfile(QIODevice* device);
     static QDateTime dateFromPackedStruct(const QByteArray& data);
     static bool isMetaStream(const Entry* entry);
@@ -77,6 +80,7 @@ private:
     QHash<Group*, quint32> m_groupLevels;
     QHash<QByteArray, Entry*> m_entryUuids;
     QHash<Entry*, quint32> m_entryGroupIds;
+    ImportTask* m_importTask;
 
     bool m_error;
     QString m_errorStr;
@@ -20,6 +20,8 @@
 #include "crypto/CryptoHash.h"
 #include "format/KeePass2.h"
 
+const int KeePass2RandomStream::KeystreamBlockSize = 4096;
+
 KeePass2RandomStream::KeePass2RandomStream(KeePass2::ProtectedStreamAlgo algo)
     : m_cipher(mapAlgo(algo), SymmetricCipher::Stream, SymmetricCipher::Encrypt)
     , m_offset(0)
@@ -44,59 +46,53 @@ bool KeePass2RandomStream::init(const QByteArray& key)
 
 QByteArray KeePass2RandomStream::randomBytes(int size, bool* ok)
 {
-    QByteArray result;
-
-    int bytesRemaining = size;
-
-    while (bytesRemaining > 0) {
-        if (m_buffer.size() == m_offset) {
-            if (!loadBlock()) {
-                *ok = false;
-                return QByteArray();
-            }
-        }
-
-        int bytesToCopy = qMin(bytesRemaining, m_buffer.size() - m_offset);
-        result.append(m_buffer.mid(m_offset, bytesToCopy));
-        m_offset += bytesToCopy;
-        bytesRemaining -= bytesToCopy;
+    QByteArray result(size, '\0');
+    *ok = processInPlace(result.data(), result.size());
+    if (!*ok) {
+        return QByteArray();
     }
-
-    *ok = true;
     return result;
 }
 
 QByteArray KeePass2RandomStream::process(const QByteArray& data, bool* ok)
 {
-    bool randomBytesOk;
-
-    QByteArray randomData = randomBytes(data.size(), &randomBytesOk);
-    if (!randomBytesOk) {
-        *ok = false;
+    QByteArray result = data;
+    *ok = processInPlace(result);
+    if (!*ok) {
         return QByteArray();
     }
-
-    QByteArray result;
-    result.resize(data.size());
-
-    for (int i = 0; i < data.size(); i++) {
-        result[i] = data[i] ^ randomData[i];
-    }
-
-    *ok = true;
     return result;
 }
 
 bool KeePass2RandomStream::processInPlace(QByteArray& data)
 {
-    bool ok;
-    QByteArray randomData = randomBytes(data.size(), &ok);
-    if (!ok) {
-        return false;
-    }
+    return processInPlace(data.data(), data.size());
+}
+
+/**
+ * XOR the next bytes of the keystream into the given buffer.
+ *
+ * The keystream is generated ahead in blocks of KeystreamBlockSize bytes,
+ * which yields the same sequence as generating it byte by byte.
+ */
+bool KeePass2RandomStream::processInPlace(char* data, int size)
+{
+    int offset = 0;
 
-    for (int i = 0; i < data.size(); i++) {
-        data[i] = data[i] ^ randomData[i];
+    while (offset < size) {
+        if (m_buffer.size() == m_offset) {
+            if (!loadBlock()) {
+                return false;
+            }
+        }
+
+        const int bytesToProcess = qMin(size - offset, m_buffer.size() - m_offset);
+        const char* keystream = m_buffer.constData() + m_offset;
+        for (int i = 0; i < bytesToProcess; ++i) {
+            data[offset + i] ^= keystream[i];
+        }
+        m_offset += bytesToProcess;
+        offset += bytesToProcess;
     }
 
     return true;
@@ -111,7 +107,7 @@ bool KeePass2RandomStream::loadBlock()
 {
     Q_ASSERT(m_offset == m_buffer.size());
 
-    m_buffer.fill('\0', m_cipher.blockSize());
+    m_buffer.fill('\0', KeystreamBlockSize);
     if (!m_cipher.processInPlace(m_buffer)) {
         return false;
     }
@@ -32,11 +32,14 @@ public:
     QByteArray randomBytes(int size, bool* ok);
     QByteArray process(const QByteArray& data, bool* ok);
     Q_REQUIRED_RESULT bool processInPlace(QByteArray& data);
+    Q_REQUIRED_RESULT bool processInPlace(char* data, int size);
     QString errorString() const;
 
 private:
     bool loadBlock();
 
+    static const int KeystreamBlockSize;
+
     SymmetricCipher m_cipher;
     QByteArray m_buffer;
     int m_offset;
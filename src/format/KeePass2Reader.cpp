@@ -19,6 +19,7 @@
 #include "format/Kdbx3Reader.h"
 #include "format/Kdbx4Reader.h"
 #include "format/KeePass1.h"
+#include "streams/MappedFileBuffer.h"
 
 #include <QFile>
 
@@ -38,7 +39,10 @@ bool KeePass2Reader::readDatabase(const QString& filename, QSharedPointer<const
         return false;
     }
 
-    bool ok = readDatabase(&file, std::move(key), db);
+    MappedFileBuffer mappedFile;
+    QIODevice* device = mappedFile.map(&file) ? static_cast<QIODevice*>(&mappedFile) : &file;
+    bool ok = readDatabase(device, std::move(key), db);
+    mappedFile.unmap();
 
     if (file.error() != QFile::NoError) {
         raiseError(file.errorString());
@@ -15,6 +15,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QBuffer>
 #include <QFile>
 #include <QIODevice>
 
@@ -109,6 +110,21 @@ bool KeePass2Writer::writeDatabase(QIODevice* device, Database* db)
 }
 
 void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
+{
+    QBuffer buffer;
+    buffer.setBuffer(&xmlOutput);
+    buffer.open(QIODevice::WriteOnly);
+    extractDatabase(db, &buffer);
+}
+
+/**
+ * Write the unencrypted XML representation of a database to a device.
+ *
+ * @param db source database
+ * @param device output device
+ * @return true on success
+ */
+bool KeePass2Writer::extractDatabase(Database* db, QIODevice* device)
 {
     m_error = false;
     m_errorStr.clear();
@@ -121,7 +137,7 @@ void KeePass2Writer::extractDatabase(Database* db, QByteArray& xmlOutput)
         m_writer.reset(new Kdbx4Writer());
     }
 
-    m_writer->extractDatabase(xmlOutput, db);
+    return m_writer->extractDatabase(device, db);
 }
 
 bool KeePass2Writer::hasError() const
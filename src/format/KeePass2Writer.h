@@ -34,6 +34,7 @@ public:
     bool writeDatabase(const QString& filename, Database* db);
     bool writeDatabase(QIODevice* device, Database* db);
     void extractDatabase(Database* db, QByteArray& xmlOutput);
+    bool extractDatabase(Database* db, QIODevice* device);
 
     QSharedPointer<KdbxWriter> writer() const;
     quint32 version() const;
@@ -19,6 +19,7 @@
 #include "OpData01.h"
 
 #include "core/Group.h"
+#include "core/ImportTask.h"
 #include "core/Tools.h"
 #include "crypto/CryptoHash.h"
 #include "crypto/SymmetricCipher.h"
@@ -28,10 +29,12 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QUuid>
+#include <QtConcurrent>
 #include <gcrypt.h>
 
 OpVaultReader::OpVaultReader(QObject* parent)
     : QObject(parent)
+    , m_importTask(nullptr)
     , m_error(false)
 {
 }
@@ -109,39 +112,63 @@ Database* OpVaultReader::readDatabase(QDir& opdataDir, const QString& password)
 
     const QString bandChars("0123456789ABCDEF");
     QString bandPattern("band_%1.js");
+    // Attachment files are named after the item they belong to, list them once instead of per item
+    QHash<QString, QStringList> attachmentFiles;
+    const auto attachmentInfoList = defaultDir.entryInfoList(QStringList() << "*.attachment", QDir::Files, QDir::Name);
+    for (const QFileInfo& info : attachmentInfoList) {
+        attachmentFiles[info.fileName().section('_', 0, 0).toUpper()] << info.absoluteFilePath();
+    }
+
+    // Parse the band files and decrypt their items on the thread pool. The entries are created
+    // afterwards on this thread in band and item order, so the resulting tree is deterministic.
+    QList<QFuture<QList<QJsonObject>>> bands;
     for (QChar ch : bandChars) {
-        QFile bandFile(defaultDir.filePath(bandPattern.arg(ch)));
-        if (!bandFile.exists()) {
-            continue;
+        const QString bandFile = defaultDir.filePath(bandPattern.arg(ch));
+        if (QFile::exists(bandFile)) {
+            bands.append(QtConcurrent::run([this, bandFile] {
+                return isCanceled() ? QList<QJsonObject>() : readBandFile(bandFile);
+            }));
         }
-        // https://support.1password.com/opvault-design/#band-files
-        QJsonObject bandJs = readAndAssertJsonFile(bandFile, "ld(", ");");
-        const QStringList keys = bandJs.keys();
-        for (const QString& entryKey : keys) {
-            const QJsonObject bandEnt = bandJs[entryKey].toObject();
-            const QString uuid = bandEnt["uuid"].toString();
-            if (entryKey != uuid) {
-                qWarning() << QString("Mismatched Entry UUID, its JSON key <<%1>> and its UUID <<%2>>")
-                                  .arg(entryKey)
-                                  .arg(uuid);
-            }
-            QStringList requiredKeys({"d", "k", "hmac"});
-            bool ok = true;
-            for (const QString& requiredKey : asConst(requiredKeys)) {
-                if (!bandEnt.contains(requiredKey)) {
-                    qCritical() << "Skipping malformed Entry UUID " << uuid << " without key " << requiredKey;
-                    ok = false;
-                    break;
-                }
-            }
-            if (!ok) {
-                continue;
-            }
-            // https://support.1password.com/opvault-design/#items
-            auto entry = processBandEntry(bandEnt, defaultDir, rootGroup);
-            if (!entry) {
-                qWarning() << "Unable to process Band Entry " << uuid;
-            }
+    }
+
+    // one step per band file and, once their number is known, per item
+    QVector<DecryptedBandEntry> items;
+    for (int i = 0; i < bands.size(); ++i) {
+        const QList<QJsonObject> bandEntries = bands[i].result();
+        if (m_importTask) {
+            m_importTask->setProgress(i + 1, bands.size() * 2);
+        }
+        for (const QJsonObject& bandEntry : bandEntries) {
+            DecryptedBandEntry item;
+            item.bandEntry = bandEntry;
+            const auto uuid = Tools::hexToUuid(bandEntry.value("uuid").toString());
+            item.attachmentFiles = attachmentFiles.value(Tools::uuidToHex(uuid).toUpper());
+            items.append(item);
+        }
+    }
+    if (checkCanceled()) {
+        zeroKeys();
+        return nullptr;
+    }
+    QtConcurrent::blockingMap(items, [this](DecryptedBandEntry& item) {
+        if (!isCanceled()) {
+            decryptBandEntry(item);
+        }
+    });
+    if (checkCanceled()) {
+        zeroKeys();
+        return nullptr;
+    }
+
+    for (int i = 0; i < items.size(); ++i) {
+        const DecryptedBandEntry& item = items.at(i);
+        // https://support.1password.com/opvault-design/#items
+        auto entry = processBandEntry(item, rootGroup);
+        if (!entry) {
+            qWarning() << "Unable to process Band Entry " << item.bandEntry.value("uuid").toString();
+        }
+        if (m_importTask) {
+            m_importTask->setProgress(bands.size() + i + 1, bands.size() + items.size());
         }
     }
 
@@ -166,6 +193,29 @@ QString OpVaultReader::errorString()
     return m_errorStr;
 }
 
+/*!
+ * Report progress to and check for cancellation of the import task, if any.
+ */
+void OpVaultReader::setImportTask(ImportTask* task)
+{
+    m_importTask = task;
+}
+
+bool OpVaultReader::isCanceled() const
+{
+    return m_importTask && m_importTask->isCanceled();
+}
+
+bool OpVaultReader::checkCanceled()
+{
+    if (!isCanceled()) {
+        return false;
+    }
+    m_error = true;
+    m_errorStr = tr("Import was canceled.");
+    return true;
+}
+
 bool OpVaultReader::processProfileJson(QJsonObject& profileJson, const QString& password, Group* rootGroup)
 {
     unsigned long iterations = profileJson["iterations"].toInt();
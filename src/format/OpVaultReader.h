@@ -19,10 +19,13 @@
 #define OPVAULT_READER_H_
 
 #include <QDir>
+#include <QJsonObject>
 
 #include "core/Database.h"
 #include "core/Metadata.h"
 
+class ImportTask;
+
 /*!
  * Imports a directory in the 1Password \c opvault format into a \c Database.
  * \sa https://support.1password.com/opvault-overview/
@@ -42,6 +45,7 @@ public:
 
     bool hasError();
     QString errorString();
+    void setImportTask(ImportTask* task);
 
 private:
     struct DerivedKeyHMAC
@@ -52,6 +56,20 @@ private:
         QString errorStr;
     };
 
+    /*!
+     * A band item after its overview, details and attachments were decrypted on a worker thread.
+     * The \c Entry itself is created afterwards on the thread that reads the database.
+     */
+    struct DecryptedBandEntry
+    {
+        QJsonObject bandEntry;
+        QStringList attachmentFiles;
+        QJsonObject overview;
+        QJsonObject data;
+        QList<QPair<QString, QByteArray>> attachments;
+        bool ok = false;
+    };
+
     QJsonObject readAndAssertJsonFile(QFile& file, const QString& stripLeading, const QString& stripTrailing);
 
     DerivedKeyHMAC* deriveKeysFromPassPhrase(QByteArray& salt, const QString& password, unsigned long iterations);
@@ -79,23 +97,28 @@ private:
      * @returns \c nullptr if unable to do the decryption, otherwise the interior object and its keys
      */
     bool decryptBandEntry(const QJsonObject& bandEntry, QJsonObject& data, QByteArray& key, QByteArray& hmacKey);
-    Entry* processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup);
+    /*!
+     * Decrypts everything a band item needs to become an \c Entry. Only reads the keys of this
+     * reader, so several items can be decrypted at once on the thread pool.
+     */
+    void decryptBandEntry(DecryptedBandEntry& item);
+    Entry* processBandEntry(const DecryptedBandEntry& item, Group* rootGroup);
+    QList<QJsonObject> readBandFile(const QString& filePath);
 
     bool readAttachment(const QString& filePath,
                         const QByteArray& itemKey,
                         const QByteArray& itemHmacKey,
                         QJsonObject& metadata,
                         QByteArray& payload);
-    void fillAttachment(Entry* entry,
-                        const QFileInfo& attachmentFileInfo,
-                        const QByteArray& entryKey,
-                        const QByteArray& entryHmacKey);
-    void fillAttachments(Entry* entry,
-                         const QDir& attachmentDir,
-                         const QByteArray& entryKey,
-                         const QByteArray& entryHmacKey);
+    bool decryptAttachment(const QFileInfo& attachmentFileInfo,
+                           const QByteArray& entryKey,
+                           const QByteArray& entryHmacKey,
+                           QString& name,
+                           QByteArray& payload);
+    void decryptAttachments(DecryptedBandEntry& item, const QByteArray& entryKey, const QByteArray& entryHmacKey);
 
-    bool fillAttributes(Entry* entry, const QJsonObject& bandEntry);
+    bool decryptOverview(const QJsonObject& bandEntry, QJsonObject& overview);
+    void fillAttributes(Entry* entry, const QJsonObject& overview);
 
     void fillFromSection(Entry* entry, const QJsonObject& section);
     void fillFromSectionField(Entry* entry, const QString& sectionName, QJsonObject& field);
@@ -104,7 +127,11 @@ private:
     void populateCategoryGroups(Group* rootGroup);
     /*! Used to blank the memory after the keys have been used. */
     void zeroKeys();
+    /*! Safe to call from the worker threads, unlike \c checkCanceled(). */
+    bool isCanceled() const;
+    bool checkCanceled();
 
+    ImportTask* m_importTask;
     bool m_error;
     QString m_errorStr;
     QByteArray m_masterKey;
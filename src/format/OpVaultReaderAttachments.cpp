@@ -137,47 +137,44 @@ bool OpVaultReader::readAttachment(const QString& filePath,
 }
 
 /*!
+ * Attachment files are named with the UUID of the item that they are attached to followed by an underscore
+ * and then followed by the UUID of the attachment itself. The file is then given the extension .attachment.
+ * The files of an item are collected into \c item.attachmentFiles before it gets decrypted.
  * \sa https://support.1password.com/opvault-design/#attachments
  */
-void OpVaultReader::fillAttachments(Entry* entry,
-                                    const QDir& attachmentDir,
-                                    const QByteArray& entryKey,
-                                    const QByteArray& entryHmacKey)
+void OpVaultReader::decryptAttachments(DecryptedBandEntry& item,
+                                       const QByteArray& entryKey,
+                                       const QByteArray& entryHmacKey)
 {
-    /*!
-     * Attachment files are named with the UUID of the item that they are attached to followed by an underscore
-     * and then followed by the UUID of the attachment itself. The file is then given the extension .attachment.
-     */
-    auto fileFilter = QString("%1_*.attachment").arg(entry->uuidToHex().toUpper());
-    const auto& attachInfoList = attachmentDir.entryInfoList(QStringList() << fileFilter, QDir::Files);
-    int attachmentCount = attachInfoList.size();
-    if (attachmentCount == 0) {
-        return;
-    }
-
-    for (const auto& info : attachInfoList) {
+    for (const QString& filePath : asConst(item.attachmentFiles)) {
+        QFileInfo info(filePath);
         if (!info.isReadable()) {
             qCritical() << QString("Attachment file \"%1\" is not readable").arg(info.absoluteFilePath());
             continue;
         }
-        fillAttachment(entry, info, entryKey, entryHmacKey);
+        QString name;
+        QByteArray payload;
+        if (decryptAttachment(info, entryKey, entryHmacKey, name, payload)) {
+            item.attachments.append(qMakePair(name, payload));
+        }
     }
 }
 
-void OpVaultReader::fillAttachment(Entry* entry,
-                                   const QFileInfo& info,
-                                   const QByteArray& entryKey,
-                                   const QByteArray& entryHmacKey)
+bool OpVaultReader::decryptAttachment(const QFileInfo& info,
+                                      const QByteArray& entryKey,
+                                      const QByteArray& entryHmacKey,
+                                      QString& name,
+                                      QByteArray& payload)
 {
     QJsonObject attachMetadata;
     QByteArray attachPayload;
     if (!readAttachment(info.absoluteFilePath(), entryKey, entryHmacKey, attachMetadata, attachPayload)) {
-        return;
+        return false;
     }
 
     if (!attachMetadata.contains("overview")) {
         qWarning() << "Expected \"overview\" in attachment metadata";
-        return;
+        return false;
     }
 
     const QString& overB64 = attachMetadata["overview"].toString();
@@ -205,8 +202,8 @@ void OpVaultReader::fillAttachment(Entry* entry,
             << QString("Unable to decode attach.overview for \"%1\": %2").arg(info.fileName(), over01.errorString());
     }
 
-    QByteArray payload;
-    payload.append(QString("attachment file is actually %1 bytes\n").arg(info.size()).toUtf8());
+    QByteArray metadataText;
+    metadataText.append(QString("attachment file is actually %1 bytes\n").arg(info.size()).toUtf8());
     for (QString& key : attachMetadata.keys()) {
         const QJsonValueRef& value = attachMetadata[key];
         QByteArray valueBytes;
@@ -219,7 +216,7 @@ void OpVaultReader::fillAttachment(Entry* entry,
         } else {
             valueBytes = QString("Unexpected metadata type in attachment: %1").arg(value.type()).toUtf8();
         }
-        payload.append(key.toUtf8()).append(":=").append(valueBytes).append("\n");
+        metadataText.append(key.toUtf8()).append(":=").append(valueBytes).append("\n");
     }
 
     QString attachKey = info.baseName();
@@ -232,5 +229,7 @@ void OpVaultReader::fillAttachment(Entry* entry,
         }
     }
 
-    entry->attachments()->set(attachKey, attachPayload);
+    name = attachKey;
+    payload = attachPayload;
+    return true;
 }
@@ -105,14 +105,71 @@ bool OpVaultReader::decryptBandEntry(const QJsonObject& bandEntry,
     return true;
 }
 
-Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir& attachmentDir, Group* rootGroup)
+/*!
+ * Reads the items of a band file, skipping the ones that lack the keys needed to decrypt them.
+ * \sa https://support.1password.com/opvault-design/#band-files
+ */
+QList<QJsonObject> OpVaultReader::readBandFile(const QString& filePath)
+{
+    QList<QJsonObject> result;
+    QFile bandFile(filePath);
+    QJsonObject bandJs = readAndAssertJsonFile(bandFile, "ld(", ");");
+    const QStringList keys = bandJs.keys();
+    for (const QString& entryKey : keys) {
+        const QJsonObject bandEnt = bandJs[entryKey].toObject();
+        const QString uuid = bandEnt["uuid"].toString();
+        if (entryKey != uuid) {
+            qWarning() << QString("Mismatched Entry UUID, its JSON key <<%1>> and its UUID <<%2>>")
+                              .arg(entryKey)
+                              .arg(uuid);
+        }
+        QStringList requiredKeys({"d", "k", "hmac"});
+        bool ok = true;
+        for (const QString& requiredKey : asConst(requiredKeys)) {
+            if (!bandEnt.contains(requiredKey)) {
+                qCritical() << "Skipping malformed Entry UUID " << uuid << " without key " << requiredKey;
+                ok = false;
+                break;
+            }
+        }
+        if (ok) {
+            result << bandEnt;
+        }
+    }
+    return result;
+}
+
+void OpVaultReader::decryptBandEntry(DecryptedBandEntry& item)
 {
+    const QJsonObject& bandEntry = item.bandEntry;
     const QString uuid = bandEntry.value("uuid").toString();
     if (!(uuid.size() == 32 || uuid.size() == 36)) {
         qWarning() << QString("Skipping suspicious band UUID <<%1>> with length %2").arg(uuid).arg(uuid.size());
+        return;
+    }
+
+    if (!decryptOverview(bandEntry, item.overview)) {
+        return;
+    }
+
+    QByteArray entryKey;
+    QByteArray entryHmacKey;
+    if (!decryptBandEntry(bandEntry, item.data, entryKey, entryHmacKey)) {
+        return;
+    }
+
+    decryptAttachments(item, entryKey, entryHmacKey);
+    item.ok = true;
+}
+
+Entry* OpVaultReader::processBandEntry(const DecryptedBandEntry& item, Group* rootGroup)
+{
+    if (!item.ok) {
         return nullptr;
     }
 
+    const QJsonObject& bandEntry = item.bandEntry;
+    const QString uuid = bandEntry.value("uuid").toString();
     QScopedPointer<Entry> entry(new Entry());
 
     if (bandEntry.contains("trashed") && bandEntry["trashed"].toBool()) {
@@ -166,18 +223,9 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
     }
     entry->setUuid(Tools::hexToUuid(uuid));
 
-    if (!fillAttributes(entry.data(), bandEntry)) {
-        return nullptr;
-    }
-
-    QJsonObject data;
-    QByteArray entryKey;
-    QByteArray entryHmacKey;
-
-    if (!decryptBandEntry(bandEntry, data, entryKey, entryHmacKey)) {
-        return nullptr;
-    }
+    fillAttributes(entry.data(), item.overview);
 
+    const QJsonObject& data = item.data;
     if (data.contains("notesPlain")) {
         entry->setNotes(data.value("notesPlain").toString());
     }
@@ -214,24 +262,29 @@ Entry* OpVaultReader::processBandEntry(const QJsonObject& bandEntry, const QDir&
         fillFromSection(entry.data(), section);
     }
 
-    fillAttachments(entry.data(), attachmentDir, entryKey, entryHmacKey);
+    for (const auto& attachment : item.attachments) {
+        entry->attachments()->set(attachment.first, attachment.second);
+    }
     return entry.take();
 }
 
-bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
+bool OpVaultReader::decryptOverview(const QJsonObject& bandEntry, QJsonObject& overview)
 {
     const QString overviewStr = bandEntry.value("o").toString();
     OpData01 entOver01;
     if (!entOver01.decodeBase64(overviewStr, m_overviewKey, m_overviewHmacKey)) {
-        qCritical() << "Unable to decipher 'o' in UUID \"" << entry->uuid() << "\"\n"
+        qCritical() << "Unable to decipher 'o' in UUID \"" << bandEntry.value("uuid").toString() << "\"\n"
                     << ": " << entOver01.errorString();
         return false;
     }
 
     auto overviewJsonBytes = entOver01.getClearText();
-    auto overviewDoc = QJsonDocument::fromJson(overviewJsonBytes);
-    auto overviewJson = overviewDoc.object();
+    overview = QJsonDocument::fromJson(overviewJsonBytes).object();
+    return true;
+}
 
+void OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& overviewJson)
+{
     QString title = overviewJson.value("title").toString();
     entry->setTitle(title);
 
@@ -258,6 +311,4 @@ bool OpVaultReader::fillAttributes(Entry* entry, const QJsonObject& bandEntry)
         }
     }
     entry->setTags(tagsList.join(','));
-
-    return true;
 }
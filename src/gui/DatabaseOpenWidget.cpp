@@ -36,6 +36,7 @@
 
 #include <QDesktopServices>
 #include <QFont>
+#include <QProgressDialog>
 #include <QSharedPointer>
 
 namespace
@@ -178,6 +179,31 @@ void DatabaseOpenWidget::clearForms()
     m_db.reset();
 }
 
+/**
+ * Run an importer in the background and show its progress.
+ * The widget stays disabled until the returned task has finished.
+ */
+ImportTask* DatabaseOpenWidget::startImport(const ImportTask::Importer& importer)
+{
+    auto task = new ImportTask(importer, this);
+    auto progress = new QProgressDialog(tr("Importing database…"), tr("Abort"), 0, 0, this);
+    progress->setWindowModality(Qt::WindowModal);
+    connect(progress, &QProgressDialog::canceled, task, &ImportTask::cancel);
+    connect(task, &ImportTask::progressChanged, progress, [progress](int value, int maximum) {
+        progress->setMaximum(maximum);
+        progress->setValue(value);
+    });
+    connect(task, &ImportTask::finished, this, [this, task, progress] {
+        progress->deleteLater();
+        task->deleteLater();
+        setEnabled(true);
+    });
+
+    setEnabled(false);
+    task->start();
+    return task;
+}
+
 QSharedPointer<Database> DatabaseOpenWidget::database()
 {
     return m_db;
@@ -22,6 +22,7 @@
 #include <QScopedPointer>
 #include <QTimer>
 
+#include "core/ImportTask.h"
 #include "gui/DialogyWidget.h"
 #include "keys/CompositeKey.h"
 
@@ -53,6 +54,7 @@ protected:
     void showEvent(QShowEvent* event) override;
     void hideEvent(QHideEvent* event) override;
     QSharedPointer<CompositeKey> buildDatabaseKey();
+    ImportTask* startImport(const ImportTask::Importer& importer);
 
     const QScopedPointer<Ui::DatabaseOpenWidget> m_ui;
     QSharedPointer<Database> m_db;
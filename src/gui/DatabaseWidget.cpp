@@ -41,6 +41,7 @@
 #include "core/Group.h"
 #include "core/Merger.h"
 #include "core/Metadata.h"
+#include "core/PasswordHealth.h"
 #include "core/Resources.h"
 #include "core/Tools.h"
 #include "format/KeePass2Reader.h"
@@ -1621,6 +1622,7 @@ bool DatabaseWidget::lock()
 
     auto newDb = QSharedPointer<Database>::create(m_db->filePath());
     replaceDatabase(newDb);
+    PasswordHealth::clearEntropyCache();
 
     emit databaseLocked();
 
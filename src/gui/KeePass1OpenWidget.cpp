@@ -18,7 +18,6 @@
 #include "KeePass1OpenWidget.h"
 #include "ui_DatabaseOpenWidget.h"
 
-#include <QFile>
 #include <QFileInfo>
 
 #include "core/Database.h"
@@ -34,8 +33,6 @@ KeePass1OpenWidget::KeePass1OpenWidget(QWidget* parent)
 
 void KeePass1OpenWidget::openDatabase()
 {
-    KeePass1Reader reader;
-
     QString password;
     QString keyFileName = m_ui->keyFileLineEdit->text();
 
@@ -43,23 +40,26 @@ void KeePass1OpenWidget::openDatabase()
         password = m_ui->editPassword->text();
     }
 
-    QFile file(m_filename);
-    if (!file.open(QIODevice::ReadOnly)) {
-        m_ui->messageWidget->showMessage(tr("Unable to open the database.").append("\n").append(file.errorString()),
-                                         MessageWidget::Error);
-        return;
-    }
-
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    m_db = reader.readDatabase(&file, password, keyFileName);
-    QApplication::restoreOverrideCursor();
+    const QString filename = m_filename;
+    auto task = startImport([filename, password, keyFileName](ImportTask* importTask, QString* error) {
+        KeePass1Reader reader;
+        reader.setImportTask(importTask);
+        auto db = reader.readDatabase(filename, password, keyFileName);
+        if (!db) {
+            *error = reader.errorString();
+        }
+        return db;
+    });
 
-    if (m_db) {
-        m_db->metadata()->setName(QFileInfo(m_filename).completeBaseName());
-        emit dialogFinished(true);
-        clearForms();
-    } else {
-        m_ui->messageWidget->showMessage(tr("Unable to open the database.").append("\n").append(reader.errorString()),
-                                         MessageWidget::Error);
-    }
+    connect(task, &ImportTask::finished, this, [this, task] {
+        m_db = task->database();
+        if (m_db) {
+            m_db->metadata()->setName(QFileInfo(m_filename).completeBaseName());
+            emit dialogFinished(true);
+            clearForms();
+        } else if (!task->isCanceled()) {
+            m_ui->messageWidget->showMessage(
+                tr("Unable to open the database.").append("\n").append(task->errorString()), MessageWidget::Error);
+        }
+    });
 }
@@ -33,22 +33,32 @@ OpVaultOpenWidget::OpVaultOpenWidget(QWidget* parent)
 
 void OpVaultOpenWidget::openDatabase()
 {
-    OpVaultReader reader;
-
     QString password;
     password = m_ui->editPassword->text();
 
-    QDir opVaultDir(m_filename);
-
-    QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
-    m_db.reset(reader.readDatabase(opVaultDir, password));
-    QApplication::restoreOverrideCursor();
+    const QString filename = m_filename;
+    auto task = startImport([filename, password](ImportTask* importTask, QString* error) {
+        OpVaultReader reader;
+        reader.setImportTask(importTask);
+        QDir opVaultDir(filename);
+        QSharedPointer<Database> db(reader.readDatabase(opVaultDir, password));
+        if (!db) {
+            *error = reader.errorString();
+        }
+        return db;
+    });
 
-    if (m_db) {
-        emit dialogFinished(true);
-    } else {
-        m_ui->messageWidget->showMessage(tr("Read Database did not produce an instance\n%1").arg(reader.errorString()),
-                                         MessageWidget::Error);
-        m_ui->editPassword->clear();
-    }
+    connect(task, &ImportTask::finished, this, [this, task] {
+        m_db = task->database();
+        if (m_db) {
+            emit dialogFinished(true);
+        } else {
+            if (!task->isCanceled()) {
+                m_ui->messageWidget->showMessage(
+                    tr("Read Database did not produce an instance\n%1").arg(task->errorString()),
+                    MessageWidget::Error);
+            }
+            m_ui->editPassword->clear();
+        }
+    });
 }
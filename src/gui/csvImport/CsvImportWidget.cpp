@@ -21,9 +21,11 @@
 
 #include <QFile>
 #include <QFileInfo>
+#include <QProgressDialog>
 #include <QSpacerItem>
 
 #include "core/Clock.h"
+#include "core/ImportTask.h"
 #include "format/KeePass2Writer.h"
 #include "gui/MessageBox.h"
 #include "gui/MessageWidget.h"
@@ -93,6 +95,11 @@ void CsvImportWidget::skippedChanged(int rows)
 
 CsvImportWidget::~CsvImportWidget()
 {
+    // the task waits for the importer, before the children it was started from are gone
+    if (m_importTask) {
+        m_importTask->cancel();
+        delete m_importTask;
+    }
 }
 
 void CsvImportWidget::configParser()
@@ -193,57 +200,116 @@ QString CsvImportWidget::formatStatusText() const
 
 void CsvImportWidget::writeDatabase()
 {
-    setRootGroup();
-    for (int r = 0; r < m_parserModel->rowCount(); ++r) {
-        // use validity of second column as a GO/NOGO for all others fields
-        if (not m_parserModel->data(m_parserModel->index(r, 1)).isValid()) {
-            continue;
-        }
-        Entry* entry = new Entry();
-        entry->setUuid(QUuid::createUuid());
-        entry->setGroup(splitGroups(m_parserModel->data(m_parserModel->index(r, 0)).toString()));
-        entry->setTitle(m_parserModel->data(m_parserModel->index(r, 1)).toString());
-        entry->setUsername(m_parserModel->data(m_parserModel->index(r, 2)).toString());
-        entry->setPassword(m_parserModel->data(m_parserModel->index(r, 3)).toString());
-        entry->setUrl(m_parserModel->data(m_parserModel->index(r, 4)).toString());
-        entry->setNotes(m_parserModel->data(m_parserModel->index(r, 5)).toString());
-
-        if (m_parserModel->data(m_parserModel->index(r, 6)).isValid()) {
-            auto totp = Totp::parseSettings(m_parserModel->data(m_parserModel->index(r, 6)).toString());
-            entry->setTotp(totp);
+    // The entries are created in a detached database on a worker thread
+    // and moved into the new database once the whole file has been read.
+    // The importer only uses a snapshot of the parser settings, never the widget.
+    const int rows = qMax(0, m_parserModel->getCsvRows() - m_ui->spinBoxSkip->value());
+    const CsvParserModel::RowReader reader = m_parserModel->rowReader();
+    auto task = new ImportTask(
+        [reader, rows](ImportTask* importTask, QString*) {
+            auto db = QSharedPointer<Database>::create();
+            Group* root = db->rootGroup();
+            setRootGroup(root, reader);
+
+            int row = 0;
+            reader.importRows([&](const QStringList& fields) {
+                if (importTask->isCanceled()) {
+                    return false;
+                }
+                importEntry(root, fields);
+                importTask->setProgress(++row, rows);
+                return true;
+            });
+            return db;
+        },
+        this);
+    m_importTask = task;
+
+    auto progress = new QProgressDialog(tr("Importing CSV file…"), tr("Abort"), 0, rows, this);
+    progress->setWindowModality(Qt::WindowModal);
+    connect(progress, &QProgressDialog::canceled, task, &ImportTask::cancel);
+    connect(task, &ImportTask::progressChanged, progress, &QProgressDialog::setValue);
+    connect(task, &ImportTask::finished, this, [this, task, progress] {
+        progress->deleteLater();
+        task->deleteLater();
+        setEnabled(true);
+
+        auto imported = task->database();
+        if (imported) {
+            moveImportedTree(imported->rootGroup());
+            checkDatabase();
         }
+    });
 
-        bool ok;
-        int icon = m_parserModel->data(m_parserModel->index(r, 7)).toInt(&ok);
-        if (ok) {
-            entry->setIcon(icon);
-        }
+    setEnabled(false);
+    task->start();
+}
 
-        TimeInfo timeInfo;
-        if (m_parserModel->data(m_parserModel->index(r, 8)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 8)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                timeInfo.setLastModificationTime(Clock::datetimeUtc(datetime.toLongLong() * 1000));
-            } else {
-                auto lastModified = QDateTime::fromString(datetime, Qt::ISODate);
-                if (lastModified.isValid()) {
-                    timeInfo.setLastModificationTime(lastModified);
-                }
+void CsvImportWidget::importEntry(Group* root, const QStringList& fields)
+{
+    Entry* entry = new Entry();
+    entry->setUuid(QUuid::createUuid());
+    entry->setGroup(splitGroups(root, fields.at(0)));
+    entry->setTitle(fields.at(1));
+    entry->setUsername(fields.at(2));
+    entry->setPassword(fields.at(3));
+    entry->setUrl(fields.at(4));
+    entry->setNotes(fields.at(5));
+
+    if (!fields.at(6).isEmpty()) {
+        auto totp = Totp::parseSettings(fields.at(6));
+        entry->setTotp(totp);
+    }
+
+    bool ok;
+    int icon = fields.at(7).toInt(&ok);
+    if (ok) {
+        entry->setIcon(icon);
+    }
+
+    TimeInfo timeInfo;
+    if (!fields.at(8).isEmpty()) {
+        auto datetime = fields.at(8);
+        if (datetime.contains(QRegularExpression("^\\d+$"))) {
+            timeInfo.setLastModificationTime(Clock::datetimeUtc(datetime.toLongLong() * 1000));
+        } else {
+            auto lastModified = QDateTime::fromString(datetime, Qt::ISODate);
+            if (lastModified.isValid()) {
+                timeInfo.setLastModificationTime(lastModified);
             }
         }
-        if (m_parserModel->data(m_parserModel->index(r, 9)).isValid()) {
-            auto datetime = m_parserModel->data(m_parserModel->index(r, 9)).toString();
-            if (datetime.contains(QRegularExpression("^\\d+$"))) {
-                timeInfo.setCreationTime(Clock::datetimeUtc(datetime.toLongLong() * 1000));
-            } else {
-                auto created = QDateTime::fromString(datetime, Qt::ISODate);
-                if (created.isValid()) {
-                    timeInfo.setCreationTime(created);
-                }
+    }
+    if (!fields.at(9).isEmpty()) {
+        auto datetime = fields.at(9);
+        if (datetime.contains(QRegularExpression("^\\d+$"))) {
+            timeInfo.setCreationTime(Clock::datetimeUtc(datetime.toLongLong() * 1000));
+        } else {
+            auto created = QDateTime::fromString(datetime, Qt::ISODate);
+            if (created.isValid()) {
+                timeInfo.setCreationTime(created);
             }
         }
-        entry->setTimeInfo(timeInfo);
     }
+    entry->setTimeInfo(timeInfo);
+}
+
+void CsvImportWidget::moveImportedTree(Group* importedRoot)
+{
+    Group* root = m_db->rootGroup();
+    root->setName(importedRoot->name());
+
+    const QList<Group*> groups = importedRoot->children();
+    for (Group* group : groups) {
+        group->setParent(root);
+    }
+    const QList<Entry*> entries = importedRoot->entries();
+    for (Entry* entry : entries) {
+        entry->setGroup(root);
+    }
+}
+
+void CsvImportWidget::checkDatabase()
+{
     QBuffer buffer;
     buffer.open(QBuffer::ReadWrite);
 
@@ -259,7 +325,7 @@ void CsvImportWidget::writeDatabase()
     emit editFinished(true);
 }
 
-void CsvImportWidget::setRootGroup()
+void CsvImportWidget::setRootGroup(Group* root, const CsvParserModel::RowReader& reader)
 {
     QString groupLabel;
     QStringList groupList;
@@ -267,12 +333,8 @@ void CsvImportWidget::setRootGroup()
     bool is_empty = false;
     bool is_label = false;
 
-    for (int r = 0; r < m_parserModel->rowCount(); ++r) {
-        // use validity of second column as a GO/NOGO for all others fields
-        if (not m_parserModel->data(m_parserModel->index(r, 1)).isValid()) {
-            continue;
-        }
-        groupLabel = m_parserModel->data(m_parserModel->index(r, 0)).toString();
+    reader.importRows([&](const QStringList& fields) {
+        groupLabel = fields.at(0);
         // check if group name is either "root", "" (empty) or some other label
         groupList = groupLabel.split("/", QString::SkipEmptyParts);
         if (groupList.isEmpty()) {
@@ -286,26 +348,27 @@ void CsvImportWidget::setRootGroup()
         }
 
         groupList.clear();
-    }
+        return true;
+    });
 
     if ((is_empty and is_root) or (is_label and not is_empty and is_root)) {
-        m_db->rootGroup()->setName("CSV IMPORTED");
+        root->setName("CSV IMPORTED");
     } else {
-        m_db->rootGroup()->setName("Root");
+        root->setName("Root");
     }
 }
 
-Group* CsvImportWidget::splitGroups(const QString& label)
+Group* CsvImportWidget::splitGroups(Group* root, const QString& label)
 {
     // extract group names from nested path provided in "label"
-    Group* current = m_db->rootGroup();
+    Group* current = root;
     if (label.isEmpty()) {
         return current;
     }
 
     QStringList groupList = label.split("/", QString::SkipEmptyParts);
     // avoid the creation of a subgroup with the same name as Root
-    if (m_db->rootGroup()->name() == "Root" && groupList.first() == "Root") {
+    if (root->name() == "Root" && !groupList.isEmpty() && groupList.first() == "Root") {
         groupList.removeFirst();
     }
 
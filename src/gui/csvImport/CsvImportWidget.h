@@ -21,6 +21,7 @@
 
 #include <QComboBox>
 #include <QList>
+#include <QPointer>
 #include <QPushButton>
 #include <QScopedPointer>
 #include <QStackedWidget>
@@ -35,6 +36,8 @@ namespace Ui
     class CsvImportWidget;
 }
 
+class ImportTask;
+
 class CsvImportWidget : public QWidget
 {
     Q_OBJECT
@@ -53,7 +56,6 @@ private slots:
     void skippedChanged(int rows);
     void writeDatabase();
     void updatePreview();
-    void setRootGroup();
     void reject();
 
 private:
@@ -63,13 +65,18 @@ private:
     QStringListModel* const m_comboModel;
     QList<QComboBox*> m_combos;
     Database* m_db;
+    QPointer<ImportTask> m_importTask;
 
     const QStringList m_columnHeader;
     QStringList m_fieldSeparatorList;
     void configParser();
     void updateTableview();
-    Group* splitGroups(const QString& label);
-    Group* hasChildren(Group* current, const QString& groupName);
+    static void setRootGroup(Group* root, const CsvParserModel::RowReader& reader);
+    static void importEntry(Group* root, const QStringList& fields);
+    void moveImportedTree(Group* importedRoot);
+    void checkDatabase();
+    static Group* splitGroups(Group* root, const QString& label);
+    static Group* hasChildren(Group* current, const QString& groupName);
     QString formatStatusText() const;
 };
 
@@ -20,6 +20,13 @@
 
 #include <utility>
 
+namespace
+{
+    // Only the beginning of the file is kept in memory for the preview,
+    // the import streams the whole file again
+    const int MaxPreviewRows = 1000;
+} // namespace
+
 CsvParserModel::CsvParserModel(QObject* parent)
     : QAbstractTableModel(parent)
     , m_skipped(0)
@@ -46,15 +53,17 @@ QString CsvParserModel::getFileInfo()
 
 bool CsvParserModel::parse()
 {
-    bool r;
     beginResetModel();
     m_columnMap.clear();
-    if (CsvParser::isFileLoaded()) {
-        r = CsvParser::reparse();
-    } else {
-        QFile csv(m_filename);
-        r = CsvParser::parse(&csv);
-    }
+    m_table.clear();
+    QFile csv(m_filename);
+    bool r = CsvParser::parse(&csv, [this](const CsvRow& row) {
+        if (m_table.size() < MaxPreviewRows) {
+            m_table.append(row);
+        }
+        return true;
+    });
+    fillColumns();
     for (int i = 0; i < columnCount(); ++i) {
         m_columnMap.insert(i, 0);
     }
@@ -63,6 +72,56 @@ bool CsvParserModel::parse()
     return r;
 }
 
+/**
+ * Parse the whole file again and pass the fields of each row, mapped to
+ * the database columns, to callback. Skipped rows are left out. Parsing
+ * stops when callback returns false.
+ *
+ * @return true if the file was parsed without errors
+ */
+bool CsvParserModel::importRows(const std::function<bool(const QStringList&)>& callback) const
+{
+    return rowReader().importRows(callback);
+}
+
+/**
+ * Take a copy of everything importRows() needs. The reader uses a
+ * separate parser and can run on a worker thread, even after the model
+ * is gone.
+ */
+CsvParserModel::RowReader CsvParserModel::rowReader() const
+{
+    RowReader reader;
+    reader.m_parser.reset(new CsvParser());
+    reader.m_parser->copyOptions(*this);
+    reader.m_filename = m_filename;
+    reader.m_columnMap = m_columnMap;
+    reader.m_columns = m_columnHeader.size();
+    reader.m_skipped = m_skipped;
+    return reader;
+}
+
+/**
+ * @see CsvParserModel::importRows()
+ */
+bool CsvParserModel::RowReader::importRows(const std::function<bool(const QStringList&)>& callback) const
+{
+    QFile csv(m_filename);
+    int row = 0;
+    return m_parser->parse(&csv, [&](const CsvRow& csvRow) {
+        if (row++ < m_skipped) {
+            return true;
+        }
+        QStringList fields;
+        for (int column = 0; column < m_columns; ++column) {
+            // mapped columns count the empty "not present" column
+            const int csvColumn = m_columnMap.value(column) - 1;
+            fields.append(csvColumn >= 0 && csvColumn < csvRow.size() ? csvRow.at(csvColumn) : QString());
+        }
+        return callback(fields);
+    });
+}
+
 void CsvParserModel::addEmptyColumn()
 {
     for (int i = 0; i < m_table.size(); ++i) {
@@ -105,7 +164,7 @@ int CsvParserModel::rowCount(const QModelIndex& parent) const
     if (parent.isValid()) {
         return 0;
     }
-    return getCsvRows();
+    return m_table.size();
 }
 
 int CsvParserModel::columnCount(const QModelIndex& parent) const
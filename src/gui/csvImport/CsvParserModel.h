@@ -21,6 +21,7 @@
 
 #include <QAbstractTableModel>
 #include <QMap>
+#include <QSharedPointer>
 
 #include "core/CsvParser.h"
 #include "core/Group.h"
@@ -30,11 +31,32 @@ class CsvParserModel : public QAbstractTableModel, public CsvParser
     Q_OBJECT
 
 public:
+    /**
+     * Snapshot of the parser options, file and column mapping that reads
+     * the rows again without referring to the model.
+     */
+    class RowReader
+    {
+    public:
+        bool importRows(const std::function<bool(const QStringList&)>& callback) const;
+
+    private:
+        friend class CsvParserModel;
+
+        QSharedPointer<CsvParser> m_parser;
+        QString m_filename;
+        QMap<int, int> m_columnMap;
+        int m_columns = 0;
+        int m_skipped = 0;
+    };
+
     explicit CsvParserModel(QObject* parent = nullptr);
     ~CsvParserModel();
     void setFilename(const QString& filename);
     QString getFileInfo();
     bool parse();
+    bool importRows(const std::function<bool(const QStringList&)>& callback) const;
+    RowReader rowReader() const;
 
     void setHeaderLabels(const QStringList& labels);
     void mapColumns(int csvColumn, int dbColumn);
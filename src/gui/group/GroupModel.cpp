@@ -25,6 +25,7 @@
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "keeshare/KeeShare.h"
 
 GroupModel::GroupModel(Database* db, QObject* parent)
@@ -36,6 +37,7 @@ GroupModel::GroupModel(Database* db, QObject* parent)
 
 void GroupModel::changeDatabase(Database* newDb)
 {
+    TRACE_SCOPE("gui", "GroupModel::changeDatabase");
     beginResetModel();
 
     m_db = newDb;
@@ -300,7 +302,7 @@ bool GroupModel::dropMimeData(const QMimeData* data,
             QUuid customIcon = entry->iconUuid();
 
             if (sourceDb != targetDb && !customIcon.isNull() && !targetDb->metadata()->hasCustomIcon(customIcon)) {
-                targetDb->metadata()->addCustomIcon(customIcon, sourceDb->metadata()->customIcon(customIcon));
+                targetDb->metadata()->addCustomIcon(customIcon, sourceDb->metadata()->customIconData(customIcon));
             }
 
             entry->setGroup(parentGroup);
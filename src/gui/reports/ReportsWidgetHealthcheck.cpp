@@ -18,7 +18,6 @@
 #include "ReportsWidgetHealthcheck.h"
 #include "ui_ReportsWidgetHealthcheck.h"
 
-#include "core/AsyncTask.h"
 #include "core/Database.h"
 #include "core/Global.h"
 #include "core/Group.h"
@@ -26,13 +25,21 @@
 #include "core/Resources.h"
 #include "gui/styles/StateColorPalette.h"
 
+#include <QFutureWatcher>
 #include <QMenu>
+#include <QSet>
 #include <QSharedPointer>
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
 
 namespace
 {
+    bool isKnownBad(const Entry* entry)
+    {
+        return entry->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
+               && entry->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR;
+    }
+
     class Health
     {
     public:
@@ -47,8 +54,7 @@ namespace
                 : group(g)
                 , entry(e)
                 , health(h)
-                , knownBad(e->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
-                           && e->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR)
+                , knownBad(isKnownBad(e))
             {
             }
 
@@ -58,23 +64,22 @@ namespace
             }
         };
 
-        explicit Health(QSharedPointer<Database>);
+        Health(const QList<QPair<QPointer<const Group>, QPointer<const Entry>>>& entries,
+               const QFuture<QSharedPointer<PasswordHealth>>& results);
 
         const QList<QSharedPointer<Item>>& items() const
         {
             return m_items;
         }
 
-        bool anyKnownBad() const
+        const QSet<const Entry*>& knownBad() const
         {
-            return m_anyKnownBad;
+            return m_knownBad;
         }
 
     private:
-        QSharedPointer<Database> m_db;
-        HealthChecker m_checker;
         QList<QSharedPointer<Item>> m_items;
-        bool m_anyKnownBad = false;
+        QSet<const Entry*> m_knownBad;
     };
 
     class ReportSortProxyModel : public QSortFilterProxyModel
@@ -99,36 +104,25 @@ namespace
     };
 } // namespace
 
-Health::Health(QSharedPointer<Database> db)
-    : m_db(db)
-    , m_checker(db)
+Health::Health(const QList<QPair<QPointer<const Group>, QPointer<const Entry>>>& entries,
+               const QFuture<QSharedPointer<PasswordHealth>>& results)
 {
-    for (const auto* group : db->rootGroup()->groupsRecursive(true)) {
-        // Skip recycle bin
-        if (group->isRecycled()) {
+    for (int i = 0; i < entries.size(); ++i) {
+        const auto& group = entries[i].first;
+        const auto& entry = entries[i].second;
+        // Skip entries that were deleted while they were evaluated
+        if (!group || !entry) {
             continue;
         }
 
-        for (const auto* entry : group->entries()) {
-            if (entry->isRecycled()) {
-                continue;
-            }
-
-            // Skip entries with empty password
-            if (entry->password().isEmpty()) {
-                continue;
-            }
-
-            // Evaluate this entry
-            const auto item = QSharedPointer<Item>(new Item(group, entry, m_checker.evaluate(entry)));
-            if (item->knownBad) {
-                m_anyKnownBad = true;
-            }
+        const auto item = QSharedPointer<Item>(new Item(group, entry, results.resultAt(i)));
+        if (item->knownBad) {
+            m_knownBad.insert(entry);
+        }
 
-            // Add entry if its password isn't at least "good"
-            if (item->health->quality() < PasswordHealth::Quality::Good) {
-                m_items.append(item);
-            }
+        // Add entry if its password isn't at least "good"
+        if (item->health->quality() < PasswordHealth::Quality::Good) {
+            m_items.append(item);
         }
     }
 
@@ -160,6 +154,7 @@ ReportsWidgetHealthcheck::ReportsWidgetHealthcheck(QWidget* parent)
 
 ReportsWidgetHealthcheck::~ReportsWidgetHealthcheck()
 {
+    cancelHealthCheck();
 }
 
 void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> health,
@@ -229,8 +224,23 @@ void ReportsWidgetHealthcheck::addHealthRow(QSharedPointer<PasswordHealth> healt
 
 void ReportsWidgetHealthcheck::loadSettings(QSharedPointer<Database> db)
 {
+    if (db == m_db && m_healthCalculated) {
+        // The report is kept up to date while the database is modified
+        return;
+    }
+
+    cancelHealthCheck();
+    disconnectDatabase();
     m_db = std::move(db);
     m_healthCalculated = false;
+    m_healthReady = false;
+    m_checker.reset();
+    m_changedEntries.clear();
+    showPleaseWait();
+}
+
+void ReportsWidgetHealthcheck::showPleaseWait()
+{
     m_referencesModel->clear();
     m_rowToEntry.clear();
 
@@ -239,6 +249,20 @@ void ReportsWidgetHealthcheck::loadSettings(QSharedPointer<Database> db)
     m_referencesModel->appendRow(row);
 }
 
+/**
+ * Release the watcher of the last health check. If the check is
+ * still running, it is canceled and its results are not shown.
+ */
+void ReportsWidgetHealthcheck::cancelHealthCheck()
+{
+    if (m_healthWatcher) {
+        m_healthWatcher->disconnect(this);
+        m_healthWatcher->cancel();
+        m_healthWatcher->waitForFinished();
+        m_healthWatcher->deleteLater();
+    }
+}
+
 void ReportsWidgetHealthcheck::showEvent(QShowEvent* event)
 {
     QWidget::showEvent(event);
@@ -252,17 +276,182 @@ void ReportsWidgetHealthcheck::showEvent(QShowEvent* event)
 
 void ReportsWidgetHealthcheck::calculateHealth()
 {
-    m_referencesModel->clear();
+    cancelHealthCheck();
+    disconnectDatabase();
+    showPleaseWait();
+    m_healthReady = false;
+    m_refreshScheduled = false;
+    m_changedEntries.clear();
+
+    QList<QPair<QPointer<const Group>, QPointer<const Entry>>> evaluated;
+    QList<const Entry*> entries;
+    for (const auto* group : m_db->rootGroup()->groupsRecursive(true)) {
+        // Skip recycle bin
+        if (group->isRecycled()) {
+            continue;
+        }
+
+        for (const auto* entry : group->entries()) {
+            // Skip entries with empty password
+            if (entry->isRecycled() || entry->password().isEmpty()) {
+                continue;
+            }
+            evaluated.append({group, entry});
+            entries.append(entry);
+        }
+    }
+
+    // Perform the health check on the thread pool, the table is filled once all entries are done
+    auto watcher = new QFutureWatcher<QSharedPointer<PasswordHealth>>(this);
+    connect(watcher, &QFutureWatcherBase::progressValueChanged, this, [this, watcher](int progress) {
+        const int maximum = watcher->progressMaximum();
+        if (maximum > 0 && m_referencesModel->rowCount() == 1) {
+            m_referencesModel->item(0)->setText(
+                tr("Please wait, health data is being calculated... %1%").arg(progress * 100 / maximum));
+        }
+    });
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, evaluated] {
+        showHealth(evaluated, watcher->future());
+        m_healthReady = true;
+    });
+    m_healthWatcher = watcher;
+    m_checker.reset(new HealthChecker(m_db));
+    connectDatabase();
+    watcher->setFuture(m_checker->evaluateAll(entries));
+}
+
+/**
+ * Follow the modifications of the database, so that only
+ * the affected entries are evaluated again.
+ */
+void ReportsWidgetHealthcheck::connectDatabase()
+{
+    // Structural changes of the groups affect the path or the recycle bin state of many entries at once
+    connect(m_db.data(), &Database::groupAboutToAdd, this, &ReportsWidgetHealthcheck::scheduleFullRefresh);
+    connect(m_db.data(), &Database::groupAboutToRemove, this, &ReportsWidgetHealthcheck::scheduleFullRefresh);
+    connect(m_db.data(), &Database::groupAboutToMove, this, &ReportsWidgetHealthcheck::scheduleFullRefresh);
+    connect(m_db.data(), &Database::groupDataChanged, this, &ReportsWidgetHealthcheck::scheduleFullRefresh);
+
+    for (const auto* group : m_db->rootGroup()->groupsRecursive(true)) {
+        connect(group, &Group::entryAdded, this, &ReportsWidgetHealthcheck::entryAdded);
+        connect(group, &Group::entryAboutToRemove, this, &ReportsWidgetHealthcheck::entryAboutToRemove);
+        for (const auto* entry : group->entries()) {
+            connectEntry(entry);
+        }
+    }
+}
 
-    // Perform the health check
-    const QScopedPointer<Health> health(AsyncTask::runAndWaitForFuture([this] { return new Health(m_db); }));
+void ReportsWidgetHealthcheck::disconnectDatabase()
+{
+    if (!m_db) {
+        return;
+    }
+
+    m_db->disconnect(this);
+    for (const auto* group : m_db->rootGroup()->groupsRecursive(true)) {
+        group->disconnect(this);
+        for (const auto* entry : group->entries()) {
+            entry->disconnect(this);
+        }
+    }
+}
+
+void ReportsWidgetHealthcheck::connectEntry(const Entry* entry)
+{
+    connect(entry, &Entry::entryModified, this, [this, entry] { markEntryChanged(entry); });
+}
+
+void ReportsWidgetHealthcheck::entryAdded(Entry* entry)
+{
+    connectEntry(entry);
+    markEntryChanged(entry);
+}
+
+void ReportsWidgetHealthcheck::entryAboutToRemove(Entry* entry)
+{
+    entry->disconnect(this);
+    m_changedEntries.remove(entry);
+    if (!m_healthReady) {
+        // The entry may still be evaluated on the thread pool
+        scheduleFullRefresh();
+        return;
+    }
+
+    removeHealthRow(entry);
+    m_knownBad.remove(entry);
+    for (const auto* affected : m_checker->removeEntry(entry)) {
+        markEntryChanged(affected);
+    }
+    updateHeader();
+}
+
+void ReportsWidgetHealthcheck::markEntryChanged(const Entry* entry)
+{
+    if (!m_healthReady) {
+        scheduleFullRefresh();
+        return;
+    }
+
+    // Collect the changes of one event loop iteration, an entry is often modified several times in a row
+    if (m_changedEntries.isEmpty()) {
+        QTimer::singleShot(0, this, SLOT(processChanges()));
+    }
+    m_changedEntries.insert(entry);
+}
+
+void ReportsWidgetHealthcheck::processChanges()
+{
+    const auto changed = m_changedEntries;
+    m_changedEntries.clear();
+    if (!m_healthReady || changed.isEmpty()) {
+        return;
+    }
+
+    QSet<const Entry*> affected;
+    for (const auto* entry : changed) {
+        for (const auto* reused : m_checker->updateEntry(entry)) {
+            affected.insert(reused);
+        }
+    }
+    for (const auto* entry : affected) {
+        updateHealthRow(entry);
+    }
+    updateHeader();
+}
+
+/**
+ * Evaluate the whole database again. Used for changes that
+ * affect too many entries to update them one by one.
+ */
+void ReportsWidgetHealthcheck::scheduleFullRefresh()
+{
+    cancelHealthCheck();
+    m_healthReady = false;
+    m_changedEntries.clear();
+
+    if (!isVisible()) {
+        // Recalculate when the report is shown again
+        disconnectDatabase();
+        m_healthCalculated = false;
+    } else if (!m_refreshScheduled) {
+        m_refreshScheduled = true;
+        QTimer::singleShot(0, this, SLOT(calculateHealth()));
+    }
+}
+
+void ReportsWidgetHealthcheck::showHealth(const QList<QPair<QPointer<const Group>, QPointer<const Entry>>>& entries,
+                                          const QFuture<QSharedPointer<PasswordHealth>>& results)
+{
+    const Health health(entries, results);
+    m_referencesModel->clear();
+    m_rowToEntry.clear();
+    m_knownBad = health.knownBad();
 
     // Display entries that are marked as "known bad"?
     const auto showKnownBad = m_ui->showKnownBadCheckBox->isChecked();
 
     // Display the entries
-    m_rowToEntry.clear();
-    for (const auto& item : health->items()) {
+    for (const auto& item : health.items()) {
         if (item->knownBad && !showKnownBad) {
             // Exclude this entry from the report
             continue;
@@ -272,26 +461,69 @@ void ReportsWidgetHealthcheck::calculateHealth()
         addHealthRow(item->health, item->group, item->entry, item->knownBad);
     }
 
+    updateHeader();
+    if (m_referencesModel->rowCount() > 0) {
+        m_ui->healthcheckTableView->sortByColumn(0, Qt::AscendingOrder);
+    }
+}
+
+void ReportsWidgetHealthcheck::updateHeader()
+{
     // Set the table header
     if (m_referencesModel->rowCount() == 0) {
+        m_referencesModel->clear();
         m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("Congratulations, everything is healthy!"));
     } else {
         m_referencesModel->setHorizontalHeaderLabels(QStringList() << tr("") << tr("Title") << tr("Path") << tr("Score")
                                                                    << tr("Reason"));
-        m_ui->healthcheckTableView->sortByColumn(0, Qt::AscendingOrder);
     }
 
     m_ui->healthcheckTableView->resizeRowsToContents();
 
     // Show the "show known bad entries" checkbox if there's any known
     // bad entry in the database.
-    if (health->anyKnownBad()) {
+    if (!m_knownBad.isEmpty()) {
         m_ui->showKnownBadCheckBox->show();
     } else {
         m_ui->showKnownBadCheckBox->hide();
     }
 }
 
+/**
+ * Evaluate a single entry again and replace its row in the table.
+ */
+void ReportsWidgetHealthcheck::updateHealthRow(const Entry* entry)
+{
+    removeHealthRow(entry);
+    m_knownBad.remove(entry);
+
+    // Skip entries in the recycle bin and entries with empty password
+    if (entry->isRecycled() || entry->password().isEmpty()) {
+        return;
+    }
+
+    const bool knownBad = isKnownBad(entry);
+    if (knownBad) {
+        m_knownBad.insert(entry);
+    }
+
+    const auto health = m_checker->evaluate(entry);
+    if (health->quality() < PasswordHealth::Quality::Good && (!knownBad || m_ui->showKnownBadCheckBox->isChecked())) {
+        addHealthRow(health, entry->group(), entry, knownBad);
+    }
+}
+
+void ReportsWidgetHealthcheck::removeHealthRow(const Entry* entry)
+{
+    for (int i = 0; i < m_rowToEntry.size(); ++i) {
+        if (m_rowToEntry[i].second == entry) {
+            m_referencesModel->removeRow(i);
+            m_rowToEntry.removeAt(i);
+            return;
+        }
+    }
+}
+
 void ReportsWidgetHealthcheck::emitEntryActivated(const QModelIndex& index)
 {
     if (!index.isValid()) {
@@ -303,7 +535,7 @@ void ReportsWidgetHealthcheck::emitEntryActivated(const QModelIndex& index)
     const auto group = row.first;
     const auto entry = row.second;
     if (group && entry) {
-        emit entryActivated(const_cast<Entry*>(entry));
+        emit entryActivated(const_cast<Entry*>(entry.data()));
     }
 }
 
@@ -316,7 +548,7 @@ void ReportsWidgetHealthcheck::customMenuRequested(QPoint pos)
         return;
     }
     auto mappedIndex = m_modelProxy->mapToSource(index);
-    m_contextmenuEntry = const_cast<Entry*>(m_rowToEntry[mappedIndex.row()].second);
+    m_contextmenuEntry = const_cast<Entry*>(m_rowToEntry[mappedIndex.row()].second.data());
     if (!m_contextmenuEntry) {
         return;
     }
@@ -354,9 +586,8 @@ void ReportsWidgetHealthcheck::toggleKnownBad(bool isKnownBad)
         return;
     }
 
+    // The modification of the entry updates the report
     m_contextmenuEntry->customData()->set(PasswordHealth::OPTION_KNOWN_BAD, isKnownBad ? TRUE_STR : FALSE_STR);
-
-    calculateHealth();
 }
 
 void ReportsWidgetHealthcheck::saveSettings()
@@ -19,15 +19,20 @@
 #define KEEPASSXC_REPORTSWIDGETHEALTHCHECK_H
 
 #include "gui/entry/EntryModel.h"
+#include <QFuture>
 #include <QHash>
 #include <QIcon>
 #include <QPair>
+#include <QPointer>
+#include <QSet>
 #include <QWidget>
 
 class Database;
 class Entry;
 class Group;
+class HealthChecker;
 class PasswordHealth;
+class QFutureWatcherBase;
 class QSortFilterProxyModel;
 class QStandardItemModel;
 
@@ -59,18 +64,42 @@ public slots:
     void editFromContextmenu();
     void toggleKnownBad(bool);
 
+private slots:
+    void processChanges();
+
 private:
     void addHealthRow(QSharedPointer<PasswordHealth>, const Group*, const Entry*, bool knownBad);
+    void updateHealthRow(const Entry* entry);
+    void removeHealthRow(const Entry* entry);
+    void updateHeader();
+    void showHealth(const QList<QPair<QPointer<const Group>, QPointer<const Entry>>>& entries,
+                    const QFuture<QSharedPointer<PasswordHealth>>& results);
+    void showPleaseWait();
+    void cancelHealthCheck();
+
+    void connectDatabase();
+    void disconnectDatabase();
+    void connectEntry(const Entry* entry);
+    void entryAdded(Entry* entry);
+    void entryAboutToRemove(Entry* entry);
+    void markEntryChanged(const Entry* entry);
+    void scheduleFullRefresh();
 
     QScopedPointer<Ui::ReportsWidgetHealthcheck> m_ui;
 
     bool m_healthCalculated = false;
+    bool m_healthReady = false;
+    bool m_refreshScheduled = false;
     QIcon m_errorIcon;
     QScopedPointer<QStandardItemModel> m_referencesModel;
     QScopedPointer<QSortFilterProxyModel> m_modelProxy;
     QSharedPointer<Database> m_db;
-    QList<QPair<const Group*, const Entry*>> m_rowToEntry;
+    QList<QPair<QPointer<const Group>, QPointer<const Entry>>> m_rowToEntry;
     Entry* m_contextmenuEntry = nullptr;
+    QPointer<QFutureWatcherBase> m_healthWatcher;
+    QSharedPointer<HealthChecker> m_checker;
+    QSet<const Entry*> m_changedEntries;
+    QSet<const Entry*> m_knownBad;
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETHEALTHCHECK_H
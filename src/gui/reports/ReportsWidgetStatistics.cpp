@@ -18,7 +18,6 @@
 #include "ReportsWidgetStatistics.h"
 #include "ui_ReportsWidgetStatistics.h"
 
-#include "core/AsyncTask.h"
 #include "core/Database.h"
 #include "core/Global.h"
 #include "core/Group.h"
@@ -27,132 +26,131 @@
 #include "core/Resources.h"
 
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QStandardItemModel>
 
-namespace
+class ReportsWidgetStatistics::Stats
 {
-    class Stats
+public:
+    // The statistics we collect:
+    QDateTime modified; // File modification time
+    int nGroups = 0; // Number of groups in the database
+    int nEntries = 0; // Number of entries (across all groups)
+    int nExpired = 0; // Number of expired entries
+    int nPwdsWeak = 0; // Number of weak or poor passwords
+    int nPwdsShort = 0; // Number of passwords 8 characters or less in size
+    int nPwdsUnique = 0; // Number of unique passwords
+    int nPwdsReused = 0; // Number of non-unique passwords
+    int nKnownBad = 0; // Number of known bad entries
+    int pwdTotalLen = 0; // Total length of all passwords
+
+    // Entries that are checked for weak passwords, nPwdsWeak is set from their health
+    QList<const Entry*> weakCandidates;
+
+    // Ctor does all the work except for the health check
+    explicit Stats(QSharedPointer<Database> db)
+        : modified(QFileInfo(db->filePath()).lastModified())
+        , m_db(db)
     {
-    public:
-        // The statistics we collect:
-        QDateTime modified; // File modification time
-        int nGroups = 0; // Number of groups in the database
-        int nEntries = 0; // Number of entries (across all groups)
-        int nExpired = 0; // Number of expired entries
-        int nPwdsWeak = 0; // Number of weak or poor passwords
-        int nPwdsShort = 0; // Number of passwords 8 characters or less in size
-        int nPwdsUnique = 0; // Number of unique passwords
-        int nPwdsReused = 0; // Number of non-unique passwords
-        int nKnownBad = 0; // Number of known bad entries
-        int pwdTotalLen = 0; // Total length of all passwords
-
-        // Ctor does all the work
-        explicit Stats(QSharedPointer<Database> db)
-            : modified(QFileInfo(db->filePath()).lastModified())
-            , m_db(db)
-        {
-            gatherStats(db->rootGroup()->groupsRecursive(true));
-        }
+        gatherStats(db->rootGroup()->groupsRecursive(true));
+    }
 
-        // Get average password length
-        int averagePwdLength() const
-        {
-            return m_passwords.empty() ? 0 : pwdTotalLen / m_passwords.size();
-        }
+    // Get average password length
+    int averagePwdLength() const
+    {
+        return m_passwords.empty() ? 0 : pwdTotalLen / m_passwords.size();
+    }
 
-        // Get max number of password reuse (=how many entries
-        // share the same password)
-        int maxPwdReuse() const
-        {
-            int ret = 0;
-            for (const auto& count : m_passwords) {
-                ret = std::max(ret, count);
-            }
-            return ret;
+    // Get max number of password reuse (=how many entries
+    // share the same password)
+    int maxPwdReuse() const
+    {
+        int ret = 0;
+        for (const auto& count : m_passwords) {
+            ret = std::max(ret, count);
         }
+        return ret;
+    }
 
-        // A warning sign is displayed if one of the
-        // following returns true.
-        bool isAnyExpired() const
-        {
-            return nExpired > 0;
-        }
+    // A warning sign is displayed if one of the
+    // following returns true.
+    bool isAnyExpired() const
+    {
+        return nExpired > 0;
+    }
 
-        bool areTooManyPwdsReused() const
-        {
-            return nPwdsReused > nPwdsUnique / 10;
-        }
+    bool areTooManyPwdsReused() const
+    {
+        return nPwdsReused > nPwdsUnique / 10;
+    }
 
-        bool arePwdsReusedTooOften() const
-        {
-            return maxPwdReuse() > 3;
-        }
+    bool arePwdsReusedTooOften() const
+    {
+        return maxPwdReuse() > 3;
+    }
 
-        bool isAvgPwdTooShort() const
-        {
-            return averagePwdLength() < 10;
-        }
+    bool isAvgPwdTooShort() const
+    {
+        return averagePwdLength() < 10;
+    }
 
-    private:
-        QSharedPointer<Database> m_db;
-        QHash<QString, int> m_passwords;
+private:
+    QSharedPointer<Database> m_db;
+    QHash<QString, int> m_passwords;
 
-        void gatherStats(const QList<Group*>& groups)
-        {
-            auto checker = HealthChecker(m_db);
+    void gatherStats(const QList<Group*>& groups)
+    {
+        for (const auto* group : groups) {
+            // Don't count anything in the recycle bin
+            if (group->isRecycled()) {
+                continue;
+            }
+
+            ++nGroups;
 
-            for (const auto* group : groups) {
+            for (const auto* entry : group->entries()) {
                 // Don't count anything in the recycle bin
-                if (group->isRecycled()) {
+                if (entry->isRecycled()) {
                     continue;
                 }
 
-                ++nGroups;
+                ++nEntries;
+
+                if (entry->isExpired()) {
+                    ++nExpired;
+                }
 
-                for (const auto* entry : group->entries()) {
-                    // Don't count anything in the recycle bin
-                    if (entry->isRecycled()) {
-                        continue;
+                // Get password statistics
+                const auto pwd = entry->password();
+                if (!pwd.isEmpty()) {
+                    if (!m_passwords.contains(pwd)) {
+                        ++nPwdsUnique;
+                    } else {
+                        ++nPwdsReused;
                     }
 
-                    ++nEntries;
+                    if (pwd.size() < 8) {
+                        ++nPwdsShort;
+                    }
 
-                    if (entry->isExpired()) {
-                        ++nExpired;
+                    // Speed up Zxcvbn process by excluding very long passwords and most passphrases
+                    if (pwd.size() < 25) {
+                        weakCandidates.append(entry);
                     }
 
-                    // Get password statistics
-                    const auto pwd = entry->password();
-                    if (!pwd.isEmpty()) {
-                        if (!m_passwords.contains(pwd)) {
-                            ++nPwdsUnique;
-                        } else {
-                            ++nPwdsReused;
-                        }
-
-                        if (pwd.size() < 8) {
-                            ++nPwdsShort;
-                        }
-
-                        // Speed up Zxcvbn process by excluding very long passwords and most passphrases
-                        if (pwd.size() < 25 && checker.evaluate(entry)->quality() <= PasswordHealth::Quality::Weak) {
-                            ++nPwdsWeak;
-                        }
-
-                        if (entry->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
-                            && entry->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR) {
-                            ++nKnownBad;
-                        }
-
-                        pwdTotalLen += pwd.size();
-                        m_passwords[pwd]++;
+                    if (entry->customData()->contains(PasswordHealth::OPTION_KNOWN_BAD)
+                        && entry->customData()->value(PasswordHealth::OPTION_KNOWN_BAD) == TRUE_STR) {
+                        ++nKnownBad;
                     }
+
+                    pwdTotalLen += pwd.size();
+                    m_passwords[pwd]++;
                 }
             }
         }
-    };
-} // namespace
+    }
+};
 
 ReportsWidgetStatistics::ReportsWidgetStatistics(QWidget* parent)
     : QWidget(parent)
@@ -170,6 +168,7 @@ ReportsWidgetStatistics::ReportsWidgetStatistics(QWidget* parent)
 
 ReportsWidgetStatistics::~ReportsWidgetStatistics()
 {
+    cancelStats();
 }
 
 void ReportsWidgetStatistics::addStatsRow(QString name, QString value, bool bad, QString badMsg)
@@ -189,10 +188,69 @@ void ReportsWidgetStatistics::addStatsRow(QString name, QString value, bool bad,
 
 void ReportsWidgetStatistics::loadSettings(QSharedPointer<Database> db)
 {
+    if (db == m_db && m_statsCalculated) {
+        // The statistics are kept up to date while the database is modified
+        return;
+    }
+
+    cancelStats();
+    if (m_db) {
+        m_db->disconnect(this);
+        for (const auto* group : m_db->rootGroup()->groupsRecursive(true)) {
+            group->disconnect(this);
+        }
+    }
     m_db = std::move(db);
     m_statsCalculated = false;
     m_referencesModel->clear();
     addStatsRow(tr("Please wait, database statistics are being calculated..."), "");
+    connect(m_db.data(), &Database::databaseModified, this, &ReportsWidgetStatistics::refreshStats);
+    // saving changes the unsaved changes, last saved and location rows
+    connect(m_db.data(), &Database::databaseSaved, this, &ReportsWidgetStatistics::refreshStats);
+    connect(m_db.data(), &Database::filePathChanged, this, &ReportsWidgetStatistics::refreshStats);
+    // the evaluation reads the entries on the thread pool, stop it before any of them is deleted
+    connect(m_db.data(), &Database::groupAboutToAdd, this, &ReportsWidgetStatistics::cancelPendingStats);
+    connect(m_db.data(), &Database::groupAboutToRemove, this, &ReportsWidgetStatistics::cancelPendingStats);
+}
+
+/**
+ * Gather the statistics again after the database was modified or saved. The
+ * counting is cheap, and the password strength of unchanged passwords
+ * is cached, so only the modified entries are evaluated by zxcvbn.
+ */
+void ReportsWidgetStatistics::refreshStats()
+{
+    if (isVisible()) {
+        calculateStats();
+    } else {
+        m_statsCalculated = false;
+    }
+}
+
+/**
+ * Release the watcher of the last health check. If the check is
+ * still running, it is canceled and the statistics are not shown.
+ */
+void ReportsWidgetStatistics::cancelStats()
+{
+    if (m_statsWatcher) {
+        m_statsWatcher->disconnect(this);
+        m_statsWatcher->cancel();
+        m_statsWatcher->waitForFinished();
+        m_statsWatcher->deleteLater();
+    }
+}
+
+/**
+ * Stop the evaluation before entries are deleted. The statistics are
+ * gathered again once the database signals the modification.
+ */
+void ReportsWidgetStatistics::cancelPendingStats()
+{
+    if (m_statsWatcher) {
+        cancelStats();
+        m_statsCalculated = false;
+    }
 }
 
 void ReportsWidgetStatistics::showEvent(QShowEvent* event)
@@ -208,48 +266,72 @@ void ReportsWidgetStatistics::showEvent(QShowEvent* event)
 
 void ReportsWidgetStatistics::calculateStats()
 {
-    const QScopedPointer<Stats> stats(AsyncTask::runAndWaitForFuture([this] { return new Stats(m_db); }));
+    cancelStats();
+    const QSharedPointer<Stats> stats(new Stats(m_db));
+    for (const auto* group : m_db->rootGroup()->groupsRecursive(true)) {
+        connect(group,
+                &Group::entryAboutToRemove,
+                this,
+                &ReportsWidgetStatistics::cancelPendingStats,
+                Qt::UniqueConnection);
+    }
+
+    // Count the weak passwords on the thread pool, the statistics are shown once all entries are done
+    auto watcher = new QFutureWatcher<QSharedPointer<PasswordHealth>>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, stats] {
+        for (const auto& health : watcher->future().results()) {
+            if (health->quality() <= PasswordHealth::Quality::Weak) {
+                ++stats->nPwdsWeak;
+            }
+        }
+        showStats(*stats);
+    });
+    m_statsWatcher = watcher;
+    watcher->setFuture(HealthChecker(m_db).evaluateAll(stats->weakCandidates));
+}
 
+void ReportsWidgetStatistics::showStats(const Stats& stats)
+{
     m_referencesModel->clear();
     addStatsRow(tr("Database name"), m_db->metadata()->name());
     addStatsRow(tr("Description"), m_db->metadata()->description());
     addStatsRow(tr("Location"), m_db->filePath());
-    addStatsRow(tr("Last saved"), stats->modified.toString(Qt::DefaultLocaleShortDate));
+    addStatsRow(tr("Last saved"), stats.modified.toString(Qt::DefaultLocaleShortDate));
     addStatsRow(tr("Unsaved changes"),
                 m_db->isModified() ? tr("yes") : tr("no"),
                 m_db->isModified(),
                 tr("The database was modified, but the changes have not yet been saved to disk."));
-    addStatsRow(tr("Number of groups"), QString::number(stats->nGroups));
-    addStatsRow(tr("Number of entries"), QString::number(stats->nEntries));
+    addStatsRow(tr("Number of groups"), QString::number(stats.nGroups));
+    addStatsRow(tr("Number of entries"), QString::number(stats.nEntries));
     addStatsRow(tr("Number of expired entries"),
-                QString::number(stats->nExpired),
-                stats->isAnyExpired(),
+                QString::number(stats.nExpired),
+                stats.isAnyExpired(),
                 tr("The database contains entries that have expired."));
-    addStatsRow(tr("Unique passwords"), QString::number(stats->nPwdsUnique));
+    addStatsRow(tr("Unique passwords"), QString::number(stats.nPwdsUnique));
     addStatsRow(tr("Non-unique passwords"),
-                QString::number(stats->nPwdsReused),
-                stats->areTooManyPwdsReused(),
+                QString::number(stats.nPwdsReused),
+                stats.areTooManyPwdsReused(),
                 tr("More than 10% of passwords are reused. Use unique passwords when possible."));
     addStatsRow(tr("Maximum password reuse"),
-                QString::number(stats->maxPwdReuse()),
-                stats->arePwdsReusedTooOften(),
+                QString::number(stats.maxPwdReuse()),
+                stats.arePwdsReusedTooOften(),
                 tr("Some passwords are used more than three times. Use unique passwords when possible."));
     addStatsRow(tr("Number of short passwords"),
-                QString::number(stats->nPwdsShort),
-                stats->nPwdsShort > 0,
+                QString::number(stats.nPwdsShort),
+                stats.nPwdsShort > 0,
                 tr("Recommended minimum password length is at least 8 characters."));
     addStatsRow(tr("Number of weak passwords"),
-                QString::number(stats->nPwdsWeak),
-                stats->nPwdsWeak > 0,
+                QString::number(stats.nPwdsWeak),
+                stats.nPwdsWeak > 0,
                 tr("Recommend using long, randomized passwords with a rating of 'good' or 'excellent'."));
     addStatsRow(tr("Entries excluded from reports"),
-                QString::number(stats->nKnownBad),
-                stats->nKnownBad > 0,
+                QString::number(stats.nKnownBad),
+                stats.nKnownBad > 0,
                 tr("Excluding entries from reports, e. g. because they are known to have a poor password, isn't "
                    "necessarily a problem but you should keep an eye on them."));
     addStatsRow(tr("Average password length"),
-                tr("%1 characters").arg(stats->averagePwdLength()),
-                stats->isAvgPwdTooShort(),
+                tr("%1 characters").arg(stats.averagePwdLength()),
+                stats.isAvgPwdTooShort(),
                 tr("Average password length is less than ten characters. Longer passwords provide more security."));
 }
 
@@ -19,9 +19,11 @@
 #define KEEPASSXC_REPORTSWIDGETSTATISTICS_H
 
 #include <QIcon>
+#include <QPointer>
 #include <QWidget>
 
 class Database;
+class QFutureWatcherBase;
 class QStandardItemModel;
 
 namespace Ui
@@ -44,16 +46,23 @@ protected:
 
 private slots:
     void calculateStats();
+    void refreshStats();
+    void cancelPendingStats();
 
 private:
+    class Stats;
+
     QScopedPointer<Ui::ReportsWidgetStatistics> m_ui;
 
     bool m_statsCalculated = false;
     QIcon m_errIcon;
     QScopedPointer<QStandardItemModel> m_referencesModel;
     QSharedPointer<Database> m_db;
+    QPointer<QFutureWatcherBase> m_statsWatcher;
 
     void addStatsRow(QString name, QString value, bool bad = false, QString badMsg = "");
+    void showStats(const Stats& stats);
+    void cancelStats();
 };
 
 #endif // KEEPASSXC_REPORTSWIDGETSTATISTICS_H
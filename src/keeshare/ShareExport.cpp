@@ -78,7 +78,7 @@ namespace
             targetEntry->setUpdateTimeinfo(updateTimeinfoEntry);
             const auto iconUuid = targetEntry->iconUuid();
             if (!iconUuid.isNull() && !targetMetadata->hasCustomIcon(iconUuid)) {
-                targetMetadata->addCustomIcon(iconUuid, sourceEntry->icon());
+                targetMetadata->addCustomIcon(iconUuid, sourceDb->metadata()->customIconData(iconUuid));
             }
         }
 
@@ -21,6 +21,7 @@
 #include "core/FileWatcher.h"
 #include "core/Global.h"
 #include "core/Group.h"
+#include "core/Trace.h"
 #include "keeshare/KeeShare.h"
 #include "keeshare/ShareExport.h"
 #include "keeshare/ShareImport.h"
@@ -203,6 +204,7 @@ void ShareObserver::handleFileUpdated(const QString& path)
 
 ShareObserver::Result ShareObserver::importShare(const QString& path)
 {
+    TRACE_SCOPE("keeshare", "importShare");
     if (!KeeShare::active().in) {
         return {};
     }
@@ -235,6 +237,7 @@ QSharedPointer<Database> ShareObserver::database()
 
 QList<ShareObserver::Result> ShareObserver::exportShares()
 {
+    TRACE_SCOPE("keeshare", "exportShares");
     QList<Result> results;
     struct Reference
     {
@@ -25,6 +25,7 @@
 #include "core/Bootstrap.h"
 #include "core/Config.h"
 #include "core/Tools.h"
+#include "core/Trace.h"
 #include "crypto/Crypto.h"
 #include "gui/Application.h"
 #include "gui/MainWindow.h"
@@ -75,6 +76,10 @@ int main(int argc, char** argv)
     parser.addOption(keyfileOption);
     parser.addOption(pwstdinOption);
     parser.addOption(debugInfoOption);
+#ifdef WITH_XC_TRACING
+    QCommandLineOption traceOption("trace", QObject::tr("write Chrome trace events to the given file"), "file");
+    parser.addOption(traceOption);
+#endif
 
     Application app(argc, argv);
     // don't set organizationName as that changes the return value of
@@ -90,6 +95,12 @@ int main(int argc, char** argv)
         return EXIT_SUCCESS;
     }
 
+#ifdef WITH_XC_TRACING
+    if (parser.isSet(traceOption)) {
+        Trace::setOutputFile(parser.value(traceOption));
+    }
+#endif
+
     // Process config file options early
     if (parser.isSet(configOption) || parser.isSet(localConfigOption)) {
         Config::createConfigFromFile(parser.value(configOption), parser.value(localConfigOption));
@@ -17,6 +17,8 @@
 
 #include "HmacBlockStream.h"
 
+#include <QBuffer>
+
 #include <utility>
 
 #include "core/Endian.h"
@@ -28,6 +30,7 @@ HmacBlockStream::HmacBlockStream(QIODevice* baseDevice, QByteArray key)
     : LayeredStream(baseDevice)
     , m_blockSize(1024 * 1024)
     , m_key(std::move(key))
+    , m_baseBuffer(qobject_cast<QBuffer*>(baseDevice))
 {
     init();
 }
@@ -36,6 +39,7 @@ HmacBlockStream::HmacBlockStream(QIODevice* baseDevice, QByteArray key, qint32 b
     : LayeredStream(baseDevice)
     , m_blockSize(blockSize)
     , m_key(std::move(key))
+    , m_baseBuffer(qobject_cast<QBuffer*>(baseDevice))
 {
     init();
 }
@@ -128,14 +132,14 @@ bool HmacBlockStream::readHashedBlock()
     if (m_eof) {
         return false;
     }
-    QByteArray hmac = m_baseDevice->read(32);
+    QByteArray hmac = readBase(32);
     if (hmac.size() != 32) {
         m_error = true;
         setErrorString("Invalid HMAC size.");
         return false;
     }
 
-    QByteArray blockSizeBytes = m_baseDevice->read(4);
+    QByteArray blockSizeBytes = readBase(4);
     if (blockSizeBytes.size() != 4) {
         m_error = true;
         setErrorString("Invalid block size size.");
@@ -148,7 +152,7 @@ bool HmacBlockStream::readHashedBlock()
         return false;
     }
 
-    m_buffer = m_baseDevice->read(blockSize);
+    m_buffer = readBase(blockSize);
     if (m_buffer.size() != blockSize) {
         m_error = true;
         setErrorString("Block too short.");
@@ -178,6 +182,26 @@ bool HmacBlockStream::readHashedBlock()
     return true;
 }
 
+/**
+ * Read from the base device. In-memory and memory-mapped input is not
+ * copied, the returned array refers to the data of the base buffer.
+ */
+QByteArray HmacBlockStream::readBase(int size)
+{
+    if (!m_baseBuffer) {
+        return m_baseDevice->read(size);
+    }
+
+    const QByteArray& data = m_baseBuffer->data();
+    const qint64 pos = m_baseBuffer->pos();
+    const int available = static_cast<int>(qMin(static_cast<qint64>(size), data.size() - pos));
+    if (available <= 0) {
+        return {};
+    }
+    m_baseBuffer->seek(pos + available);
+    return QByteArray::fromRawData(data.constData() + pos, available);
+}
+
 qint64 HmacBlockStream::writeData(const char* data, qint64 maxSize)
 {
     Q_ASSERT(maxSize >= 0);
@@ -20,6 +20,8 @@
 
 #include <QSysInfo>
 
+class QBuffer;
+
 #include "streams/LayeredStream.h"
 
 class HmacBlockStream : public LayeredStream
@@ -45,6 +47,7 @@ protected:
 private:
     void init();
     bool readHashedBlock();
+    QByteArray readBase(int size);
     bool writeHashedBlock();
     QByteArray getCurrentHmacKey() const;
 
@@ -52,6 +55,7 @@ private:
     qint32 m_blockSize;
     QByteArray m_buffer;
     QByteArray m_key;
+    QBuffer* const m_baseBuffer;
     int m_bufferPos;
     quint64 m_blockIndex;
     bool m_eof;
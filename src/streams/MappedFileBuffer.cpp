@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFileBuffer.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <climits>
+
+#if defined(Q_OS_LINUX)
+#include <sys/vfs.h>
+#elif defined(Q_OS_MACOS)
+#include <sys/mount.h>
+#include <sys/param.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace
+{
+    /**
+     * Whether a file lives on a local filesystem.
+     *
+     * If a mapped file is truncated or rewritten in place by someone else,
+     * touching the missing pages kills the process with SIGBUS instead of
+     * failing a read. Network shares and their sync clients do that, so
+     * files there are read through QFile.
+     */
+    bool isOnLocalFilesystem(const QString& filePath)
+    {
+#if defined(Q_OS_LINUX)
+        struct statfs statfsBuf;
+        if (statfs(filePath.toLocal8Bit().constData(), &statfsBuf) != 0) {
+            return false;
+        }
+        switch (static_cast<quint32>(statfsBuf.f_type)) {
+        case 0xEF53: // ext2, ext3, ext4
+        case 0x58465342: // xfs
+        case 0x9123683E: // btrfs
+        case 0xF2F52010: // f2fs
+        case 0x2FC12FC1: // zfs
+        case 0x01021994: // tmpfs
+        case 0x794C7630: // overlayfs
+            return true;
+        default:
+            return false;
+        }
+#elif defined(Q_OS_MACOS)
+        struct statfs statfsBuf;
+        return statfs(filePath.toLocal8Bit().constData(), &statfsBuf) == 0 && (statfsBuf.f_flags & MNT_LOCAL);
+#elif defined(Q_OS_WIN)
+        const QString absolutePath = QFileInfo(filePath).absoluteFilePath();
+        if (absolutePath.startsWith(QLatin1String("//"))) {
+            // UNC path of a network share
+            return false;
+        }
+        const QString root = QDir::toNativeSeparators(absolutePath.left(3));
+        const UINT type = GetDriveTypeW(reinterpret_cast<LPCWSTR>(root.utf16()));
+        return type == DRIVE_FIXED || type == DRIVE_RAMDISK;
+#else
+        Q_UNUSED(filePath);
+        return false;
+#endif
+    }
+} // namespace
+
+MappedFileBuffer::MappedFileBuffer(QObject* parent)
+    : QBuffer(parent)
+    , m_file(nullptr)
+    , m_mapping(nullptr)
+{
+}
+
+MappedFileBuffer::~MappedFileBuffer()
+{
+    unmap();
+}
+
+/**
+ * Map an open file and open the buffer for reading.
+ *
+ * Files that are not on a local filesystem are never mapped.
+ *
+ * @param file file opened for reading, must stay open until unmap()
+ * @return false if the file cannot be mapped, the caller should read
+ *         from the file directly in that case
+ */
+bool MappedFileBuffer::map(QFile* file)
+{
+    unmap();
+
+    const qint64 size = file->size();
+    if (size <= 0 || size > INT_MAX || !isOnLocalFilesystem(file->fileName())) {
+        return false;
+    }
+
+    m_mapping = file->map(0, size);
+    if (!m_mapping) {
+        return false;
+    }
+    m_file = file;
+
+    m_data = QByteArray::fromRawData(reinterpret_cast<const char*>(m_mapping), static_cast<int>(size));
+    setBuffer(&m_data);
+    return open(QIODevice::ReadOnly);
+}
+
+/**
+ * Close the buffer and release the mapping. Data read from the buffer
+ * without copying must not be used afterwards.
+ */
+void MappedFileBuffer::unmap()
+{
+    if (!m_mapping) {
+        return;
+    }
+
+    close();
+    setBuffer(nullptr);
+    m_data.clear();
+    m_file->unmap(m_mapping);
+    m_file = nullptr;
+    m_mapping = nullptr;
+}
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_MAPPEDFILEBUFFER_H
+#define KEEPASSXC_MAPPEDFILEBUFFER_H
+
+#include <QBuffer>
+
+class QFile;
+
+/**
+ * Read-only buffer over a memory mapping of a file.
+ *
+ * Readers that know about QBuffer access the mapped pages directly instead
+ * of copying the file through read() calls, and the pages are shared with
+ * the page cache. The file must not be truncated while it is mapped, so
+ * only files on local filesystems are mapped.
+ */
+class MappedFileBuffer : public QBuffer
+{
+    Q_OBJECT
+
+public:
+    explicit MappedFileBuffer(QObject* parent = nullptr);
+    ~MappedFileBuffer() override;
+
+    bool map(QFile* file);
+    void unmap();
+
+private:
+    QFile* m_file;
+    uchar* m_mapping;
+    QByteArray m_data;
+};
+
+#endif // KEEPASSXC_MAPPEDFILEBUFFER_H
@@ -0,0 +1,281 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelGzipStream.h"
+
+#include <QFuture>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+
+#include <cstring>
+#include <zlib.h>
+
+namespace
+{
+    // deflate never refers back further than its window
+    const int DictionarySize = 32 * 1024;
+    // upper bound of input held back for compression, regardless of thread count
+    const qint64 MaxPendingBytes = 256 * 1024 * 1024;
+
+    struct Block
+    {
+        const char* data;
+        int size;
+        const char* dictionary;
+        int dictionarySize;
+        bool last;
+    };
+
+    /**
+     * Compress a single block to raw deflate data. All but the last block end
+     * with a sync flush, so the output can be concatenated.
+     *
+     * @return compressed data, empty on error
+     */
+    QByteArray deflateBlock(const Block& block, int level)
+    {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        // negative window bits for raw deflate, the gzip framing is written by the stream
+        if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return {};
+        }
+        if (block.dictionarySize > 0
+            && deflateSetDictionary(
+                   &stream, reinterpret_cast<const Bytef*>(block.dictionary), static_cast<uInt>(block.dictionarySize))
+                   != Z_OK) {
+            deflateEnd(&stream);
+            return {};
+        }
+
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data));
+        stream.avail_in = static_cast<uInt>(block.size);
+
+        // the bound does not include the empty stored block of the sync flush
+        QByteArray output;
+        output.resize(static_cast<int>(deflateBound(&stream, static_cast<uLong>(block.size))) + 16);
+
+        const int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+        bool done = false;
+        while (!done) {
+            if (stream.total_out == static_cast<uLong>(output.size())) {
+                output.resize(output.size() * 2);
+            }
+            stream.next_out = reinterpret_cast<Bytef*>(output.data() + stream.total_out);
+            stream.avail_out = static_cast<uInt>(output.size() - static_cast<int>(stream.total_out));
+
+            const int result = deflate(&stream, flush);
+            if (result == Z_STREAM_ERROR) {
+                deflateEnd(&stream);
+                return {};
+            }
+            done = block.last ? result == Z_STREAM_END : stream.avail_out != 0;
+        }
+
+        output.resize(static_cast<int>(stream.total_out));
+        deflateEnd(&stream);
+        return output;
+    }
+} // namespace
+
+/**
+ * @param baseDevice device the gzip data is written to
+ * @param compressionLevel zlib compression level between 1 and 9
+ * @param blockSize amount of input compressed by each thread at a time
+ */
+ParallelGzipStream::ParallelGzipStream(QIODevice* baseDevice, int compressionLevel, int blockSize)
+    : LayeredStream(baseDevice)
+    , m_compressionLevel(compressionLevel)
+    , m_blockSize(qMax(blockSize, DictionarySize))
+    , m_maxPendingBlocks(static_cast<int>(
+          qBound(qint64(1), MaxPendingBytes / m_blockSize, static_cast<qint64>(QThread::idealThreadCount()))))
+    , m_crc(0)
+    , m_size(0)
+    , m_finished(false)
+    , m_error(false)
+{
+}
+
+ParallelGzipStream::~ParallelGzipStream()
+{
+    close();
+}
+
+bool ParallelGzipStream::open(QIODevice::OpenMode mode)
+{
+    if (mode & QIODevice::ReadOnly) {
+        qWarning("ParallelGzipStream::open: Only writing is supported.");
+        return false;
+    }
+    if (!LayeredStream::open(mode)) {
+        return false;
+    }
+
+    m_pending.clear();
+    m_dictionary.clear();
+    m_crc = static_cast<quint32>(crc32(0, nullptr, 0));
+    m_size = 0;
+    m_finished = false;
+    m_error = false;
+
+    // magic, deflate, no flags, no modification time, extra flags, unknown OS
+    const char extraFlags = m_compressionLevel == Z_BEST_COMPRESSION ? 2 : (m_compressionLevel == Z_BEST_SPEED ? 4 : 0);
+    const char header[] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, extraFlags, '\xff'};
+    return writeBase(QByteArray(header, sizeof(header)));
+}
+
+/**
+ * Compress the remaining input and write the gzip trailer.
+ *
+ * Call this before close() to find out whether the compressed stream was
+ * written completely, close() resets errorString().
+ *
+ * @return true on success
+ */
+bool ParallelGzipStream::finish()
+{
+    if (!isOpen() || !isWritable()) {
+        return false;
+    }
+
+    if (!m_finished) {
+        m_finished = true;
+        if (!m_error && compressPending(true)) {
+            uchar trailer[8];
+            qToLittleEndian<quint32>(m_crc, trailer);
+            qToLittleEndian<quint32>(m_size, trailer + 4);
+            writeBase(QByteArray(reinterpret_cast<const char*>(trailer), sizeof(trailer)));
+        }
+    }
+
+    return !m_error;
+}
+
+void ParallelGzipStream::close()
+{
+    if (isOpen() && isWritable()) {
+        finish();
+    }
+
+    LayeredStream::close();
+}
+
+qint64 ParallelGzipStream::readData(char* data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
+
+qint64 ParallelGzipStream::writeData(const char* data, qint64 maxSize)
+{
+    Q_ASSERT(maxSize >= 0);
+
+    if (m_error || m_finished) {
+        return -1;
+    }
+
+    // bounded by MaxPendingBytes in the constructor
+    const qint64 batchSize = static_cast<qint64>(m_blockSize) * m_maxPendingBlocks;
+    qint64 offset = 0;
+    while (offset < maxSize) {
+        const int bytesToCopy = static_cast<int>(qMin(maxSize - offset, batchSize - m_pending.size()));
+        m_pending.append(data + offset, bytesToCopy);
+        m_crc = static_cast<quint32>(crc32(m_crc, reinterpret_cast<const Bytef*>(data + offset), bytesToCopy));
+        offset += bytesToCopy;
+
+        if (m_pending.size() == batchSize && !compressPending(false)) {
+            return -1;
+        }
+    }
+
+    // the gzip trailer stores the input size modulo 2^32
+    m_size += static_cast<quint32>(maxSize);
+    return maxSize;
+}
+
+/**
+ * Compress all pending input, one block per thread, and write the
+ * compressed blocks to the base device in order.
+ *
+ * @param finish true to terminate the deflate stream with the last block
+ * @return true on success
+ */
+bool ParallelGzipStream::compressPending(bool finish)
+{
+    const char* data = m_pending.constData();
+    const int size = m_pending.size();
+    if (size == 0 && !finish) {
+        return true;
+    }
+
+    QVector<Block> blocks;
+    int offset = 0;
+    do {
+        Block block;
+        block.data = data + offset;
+        block.size = qMin(m_blockSize, size - offset);
+        if (offset == 0) {
+            block.dictionary = m_dictionary.constData();
+            block.dictionarySize = m_dictionary.size();
+        } else {
+            block.dictionarySize = qMin(DictionarySize, offset);
+            block.dictionary = data + offset - block.dictionarySize;
+        }
+        offset += block.size;
+        block.last = finish && offset == size;
+        blocks.append(block);
+    } while (offset < size);
+
+    const int level = m_compressionLevel;
+    QList<QFuture<QByteArray>> futures;
+    for (const Block& block : blocks) {
+        futures.append(QtConcurrent::run([block, level] { return deflateBlock(block, level); }));
+    }
+
+    // wait for every block, the jobs reference the pending buffer
+    for (QFuture<QByteArray>& future : futures) {
+        const QByteArray compressed = future.result();
+        if (m_error) {
+            continue;
+        }
+        if (compressed.isEmpty()) {
+            m_error = true;
+            setErrorString("Failed to compress data.");
+        } else {
+            writeBase(compressed);
+        }
+    }
+
+    m_dictionary = m_pending.right(DictionarySize);
+    // keeps the allocated capacity for the next batch
+    m_pending.resize(0);
+
+    return !m_error;
+}
+
+bool ParallelGzipStream::writeBase(const QByteArray& data)
+{
+    if (m_baseDevice->write(data) != data.size()) {
+        m_error = true;
+        setErrorString(m_baseDevice->errorString());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,62 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_PARALLELGZIPSTREAM_H
+#define KEEPASSXC_PARALLELGZIPSTREAM_H
+
+#include "streams/LayeredStream.h"
+
+/**
+ * Write-only gzip stream that deflates blocks of input on multiple threads.
+ *
+ * Each block is compressed independently with the last 32 KiB of the
+ * previous block as preset dictionary and ends on a byte boundary, so the
+ * concatenated blocks form a single regular gzip member that any inflate
+ * implementation can read.
+ */
+class ParallelGzipStream : public LayeredStream
+{
+    Q_OBJECT
+
+public:
+    ParallelGzipStream(QIODevice* baseDevice, int compressionLevel, int blockSize);
+    ~ParallelGzipStream() override;
+
+    bool open(QIODevice::OpenMode mode) override;
+    void close() override;
+    bool finish();
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    bool compressPending(bool finish);
+    bool writeBase(const QByteArray& data);
+
+    const int m_compressionLevel;
+    const int m_blockSize;
+    const int m_maxPendingBlocks;
+    QByteArray m_pending;
+    QByteArray m_dictionary;
+    quint32 m_crc;
+    quint32 m_size;
+    bool m_finished;
+    bool m_error;
+};
+
+#endif // KEEPASSXC_PARALLELGZIPSTREAM_H
@@ -17,18 +17,44 @@
 
 #include "SymmetricCipherStream.h"
 
+#include <QThread>
+#include <QtConcurrent>
+
+#include "core/Global.h"
+
+namespace
+{
+    // Position-addressable stream ciphers are buffered in larger blocks
+    // so that each block can be split across several threads.
+    const int ParallelBlockSize = 4 * 1024 * 1024;
+    const int ParallelMinChunkSize = 256 * 1024;
+    const int KeystreamAlignment = 64;
+
+    struct ParallelChunk
+    {
+        QByteArray data;
+        quint64 offset;
+        bool ok;
+    };
+} // namespace
+
 SymmetricCipherStream::SymmetricCipherStream(QIODevice* baseDevice,
                                              SymmetricCipher::Algorithm algo,
                                              SymmetricCipher::Mode mode,
                                              SymmetricCipher::Direction direction)
     : LayeredStream(baseDevice)
     , m_cipher(new SymmetricCipher(algo, mode, direction))
+    , m_algo(algo)
+    , m_mode(mode)
+    , m_direction(direction)
     , m_bufferPos(0)
     , m_bufferFilling(false)
     , m_error(false)
     , m_isInitialized(false)
     , m_dataWritten(false)
     , m_streamCipher(false)
+    , m_parallel(false)
+    , m_streamPos(0)
 {
 }
 
@@ -44,9 +70,35 @@ bool SymmetricCipherStream::init(const QByteArray& key, const QByteArray& iv)
         setErrorString(m_cipher->errorString());
     }
     m_streamCipher = m_cipher->blockSize() == 1;
+    m_key = key;
+    m_iv = iv;
+    m_parallel = m_isInitialized && m_streamCipher && QThread::idealThreadCount() > 1 && canProcessParallel();
     return m_isInitialized;
 }
 
+/**
+ * Verify that the cipher backend can seek within the keystream and that the
+ * result matches sequential processing. Older libgcrypt versions silently
+ * ignore counter IVs, so this must not be assumed from the API alone.
+ */
+bool SymmetricCipherStream::canProcessParallel() const
+{
+    SymmetricCipher sequential(m_algo, m_mode, SymmetricCipher::Encrypt);
+    SymmetricCipher seeked(m_algo, m_mode, SymmetricCipher::Encrypt);
+    if (!sequential.init(m_key, m_iv) || !seeked.init(m_key, m_iv)) {
+        return false;
+    }
+
+    const int probeOffset = KeystreamAlignment + 7;
+    QByteArray expected(probeOffset + KeystreamAlignment, '\0');
+    QByteArray actual(KeystreamAlignment, '\0');
+    if (!sequential.processInPlace(expected) || !seeked.seek(probeOffset) || !seeked.processInPlace(actual)) {
+        return false;
+    }
+
+    return expected.mid(probeOffset) == actual;
+}
+
 void SymmetricCipherStream::resetInternalState()
 {
     m_buffer.clear();
@@ -54,6 +106,7 @@ void SymmetricCipherStream::resetInternalState()
     m_bufferFilling = false;
     m_error = false;
     m_dataWritten = false;
+    m_streamPos = 0;
     m_cipher->reset();
 }
 
@@ -145,9 +198,7 @@ bool SymmetricCipherStream::readBlock()
         m_bufferFilling = true;
         return false;
     } else {
-        if (!m_cipher->processInPlace(m_buffer)) {
-            m_error = true;
-            setErrorString(m_cipher->errorString());
+        if (!processBuffer()) {
             return false;
         }
         m_bufferPos = 0;
@@ -229,9 +280,7 @@ bool SymmetricCipherStream::writeBlock(bool lastBlock)
         }
     }
 
-    if (!m_cipher->processInPlace(m_buffer)) {
-        m_error = true;
-        setErrorString(m_cipher->errorString());
+    if (!processBuffer()) {
         return false;
     }
 
@@ -245,10 +294,75 @@ bool SymmetricCipherStream::writeBlock(bool lastBlock)
     }
 }
 
+bool SymmetricCipherStream::processBuffer()
+{
+    bool ok;
+    if (m_parallel && m_buffer.size() >= 2 * ParallelMinChunkSize) {
+        ok = processBufferParallel();
+    } else {
+        ok = m_cipher->processInPlace(m_buffer);
+        if (!ok) {
+            setErrorString(m_cipher->errorString());
+        }
+    }
+
+    if (!ok) {
+        m_error = true;
+        return false;
+    }
+
+    m_streamPos += static_cast<quint64>(m_buffer.size());
+    return true;
+}
+
+/**
+ * Process the buffer in independent chunks, each with its own cipher
+ * instance positioned at the chunk's keystream offset. The sequential
+ * cipher is advanced past the buffer afterwards so both paths can be mixed.
+ */
+bool SymmetricCipherStream::processBufferParallel()
+{
+    const int size = m_buffer.size();
+    const int chunkCount = qMin(QThread::idealThreadCount(), size / ParallelMinChunkSize);
+    const int chunkSize = (size / chunkCount + KeystreamAlignment - 1) / KeystreamAlignment * KeystreamAlignment;
+
+    QVector<ParallelChunk> chunks;
+    for (int pos = 0; pos < size; pos += chunkSize) {
+        chunks.append({m_buffer.mid(pos, chunkSize), m_streamPos + static_cast<quint64>(pos), false});
+    }
+
+    const auto algo = m_algo;
+    const auto mode = m_mode;
+    const auto direction = m_direction;
+    const QByteArray key = m_key;
+    const QByteArray iv = m_iv;
+    QtConcurrent::blockingMap(chunks, [=](ParallelChunk& chunk) {
+        SymmetricCipher cipher(algo, mode, direction);
+        chunk.ok = cipher.init(key, iv) && cipher.seek(chunk.offset) && cipher.processInPlace(chunk.data);
+    });
+
+    char* data = m_buffer.data();
+    for (const ParallelChunk& chunk : asConst(chunks)) {
+        if (!chunk.ok) {
+            setErrorString("Failed to process cipher stream in parallel.");
+            return false;
+        }
+        memcpy(data, chunk.data.constData(), static_cast<size_t>(chunk.data.size()));
+        data += chunk.data.size();
+    }
+
+    if (!m_cipher->seek(m_streamPos + static_cast<quint64>(size))) {
+        setErrorString(m_cipher->errorString());
+        return false;
+    }
+
+    return true;
+}
+
 int SymmetricCipherStream::blockSize() const
 {
     if (m_streamCipher) {
-        return 1024;
+        return m_parallel ? ParallelBlockSize : 1024;
     }
     return m_cipher->blockSize();
 }
@@ -47,9 +47,17 @@ private:
     void resetInternalState();
     bool readBlock();
     bool writeBlock(bool lastBlock);
+    bool processBuffer();
+    bool processBufferParallel();
+    bool canProcessParallel() const;
     int blockSize() const;
 
     const QScopedPointer<SymmetricCipher> m_cipher;
+    const SymmetricCipher::Algorithm m_algo;
+    const SymmetricCipher::Mode m_mode;
+    const SymmetricCipher::Direction m_direction;
+    QByteArray m_key;
+    QByteArray m_iv;
     QByteArray m_buffer;
     int m_bufferPos;
     bool m_bufferFilling;
@@ -57,6 +65,8 @@ private:
     bool m_isInitialized;
     bool m_dataWritten;
     bool m_streamCipher;
+    bool m_parallel;
+    quint64 m_streamPos;
 };
 
 #endif // KEEPASSX_SYMMETRICCIPHERSTREAM_H
@@ -159,18 +159,102 @@ static int Cardinality(const uint8_t *Str, int Len)
 }
 
 /**********************************************************************************
- * Allocate a ZxcMatch_t struct, clear it to zero
+ * Match structs are taken from an arena that is released as a whole at the end of
+ * ZxcvbnMatch(), instead of allocating and freeing every match on the heap. The
+ * first block of the arena is on the stack of ZxcvbnMatch(), so most passwords need
+ * no heap allocation for their matches at all. The arena in use is kept per thread,
+ * so several passwords can be checked in parallel.
+ */
+#define ARENA_STACK_MATCHES 128
+#define ARENA_HEAP_MATCHES  1024
+
+#if defined(_MSC_VER)
+#define ZXC_THREAD_LOCAL __declspec(thread)
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+#define ZXC_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define ZXC_THREAD_LOCAL _Thread_local
+#else
+#define ZXC_THREAD_LOCAL __thread
+#endif
+
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *Next;
+    ZxcMatch_t Matches[ARENA_HEAP_MATCHES];
+} ArenaBlock_t;
+
+typedef struct
+{
+    ZxcMatch_t   *Matches;  /* Match structs of the current block */
+    int           Used;     /* Number of match structs used in the current block */
+    int           Size;     /* Number of match structs in the current block */
+    ArenaBlock_t *Blocks;   /* Blocks taken from the heap */
+} Arena_t;
+
+static ZXC_THREAD_LOCAL Arena_t *CurArena;
+
+/**********************************************************************************
+ * Start using the arena, the first block is passed by the caller.
+ */
+static void ArenaInit(Arena_t *Arena, ZxcMatch_t *Matches, int Size)
+{
+    Arena->Matches = Matches;
+    Arena->Used = 0;
+    Arena->Size = Size;
+    Arena->Blocks = 0;
+    CurArena = Arena;
+}
+
+/**********************************************************************************
+ * Free the heap blocks of the arena, all its match structs become invalid.
+ */
+static void ArenaRelease(Arena_t *Arena)
+{
+    while(Arena->Blocks)
+    {
+        ArenaBlock_t *Nxt = Arena->Blocks->Next;
+        FreeFn(Arena->Blocks);
+        Arena->Blocks = Nxt;
+    }
+    CurArena = 0;
+}
+
+/**********************************************************************************
+ * Allocate a ZxcMatch_t struct from the arena, clear it to zero
  */
 static ZxcMatch_t *AllocMatch()
 {
-    ZxcMatch_t *p = MallocFn(ZxcMatch_t, 1);
+    Arena_t *Arena = CurArena;
+    ZxcMatch_t *p;
+    if (Arena->Used >= Arena->Size)
+    {
+        ArenaBlock_t *Blk = MallocFn(ArenaBlock_t, 1);
+        Blk->Next = Arena->Blocks;
+        Arena->Blocks = Blk;
+        Arena->Matches = Blk->Matches;
+        Arena->Used = 0;
+        Arena->Size = ARENA_HEAP_MATCHES;
+    }
+    p = Arena->Matches + Arena->Used++;
     memset(p, 0, sizeof *p);
     return p;
 }
 
+/**********************************************************************************
+ * Return a discarded match struct to the arena. Only the most recently allocated
+ * struct can be reused, others are released with the arena.
+ */
+static void DiscardMatch(ZxcMatch_t *p)
+{
+    Arena_t *Arena = CurArena;
+    if (Arena->Used && (p == Arena->Matches + Arena->Used - 1))
+        --Arena->Used;
+}
+
 /**********************************************************************************
  * Add new match struct to linked list of matches. List ordered with shortest at
- * head of list. Note: passed new match struct in parameter Nu may be de allocated.
+ * head of list. Note: passed new match struct in parameter Nu may be discarded.
  */
 static void AddResult(ZxcMatch_t **HeadRef, ZxcMatch_t *Nu, int MaxLen)
 {
@@ -198,13 +282,12 @@ static void AddResult(ZxcMatch_t **HeadRef, ZxcMatch_t *Nu, int MaxLen)
         if ((*HeadRef)->MltEnpy <= Nu->MltEnpy)
         {
             /* Existing entry has lower entropy - keep it, discard new entry */
-            FreeFn(Nu);
+            DiscardMatch(Nu);
         }
         else
         {
             /* New entry has lower entropy - replace existing entry */
             Nu->Next = (*HeadRef)->Next;
-            FreeFn(*HeadRef);
             *HeadRef = Nu;
         }
     }
@@ -1578,8 +1661,11 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
     int Len = strlen(Pwd);
     const uint8_t *Passwd = (const uint8_t *)Pwd;
     uint8_t *RevPwd;
+    ZxcMatch_t StackMatches[ARENA_STACK_MATCHES];
+    Arena_t Arena;
     /* Create the paths */
     Node_t *Nodes = MallocFn(Node_t, Len+1);
+    ArenaInit(&Arena, StackMatches, ARENA_STACK_MATCHES);
     memset(Nodes, 0, (Len+1) * sizeof *Nodes);
     i = Cardinality(Passwd, Len);
     e = log((double)i);
@@ -1707,50 +1793,28 @@ double ZxcvbnMatch(const char *Pwd, const char *UserDict[], ZxcMatch_t **Info)
 
     if (Info)
     {
-        /* Construct info on password parts */
+        /* Construct info on password parts. The arena is released below, so the */
+        /* returned parts are copied to the heap for ZxcvbnFreeInfo(). */
         *Info = 0;
         for(Zp = Nodes[Len].From; Zp; )
         {
-            ZxcMatch_t *Xp;
+            ZxcMatch_t *Xp = MallocFn(ZxcMatch_t, 1);
+            *Xp = *Zp;
             i = Zp->Begin;
 
-            /* Remove all but required path */
-            Xp = Nodes[i].Paths;
-            Nodes[i].Paths = 0;
-            while(Xp)
-            {
-                ZxcMatch_t *p = Xp->Next;
-                if (Xp == Zp)
-                {
-                    /* Adjust the entropy to log to base 2 */
-                    Xp->Entrpy /= log(2.0);
-                    Xp->MltEnpy /= log(2.0);
+            /* Adjust the entropy to log to base 2 */
+            Xp->Entrpy /= log(2.0);
+            Xp->MltEnpy /= log(2.0);
+
+            /* Put previous part at head of info list */
+            Xp->Next = *Info;
+            *Info = Xp;
 
-                    /* Put previous part at head of info list */
-                    Xp->Next = *Info;
-                    *Info = Xp;
-                }
-                else
-                {
-                    /* Not going on info list, so free it */
-                    FreeFn(Xp);
-                }
-                Xp = p;
-            }
             Zp = Nodes[i].From;
         }
     }
-    /* Free all paths. Any being returned to caller have already been freed */
-    for(i = 0; i <= Len; ++i)
-    {
-        Zp = Nodes[i].Paths;
-        while(Zp)
-        {
-            ZxcMatch_t *p = Zp->Next;
-            FreeFn(Zp);
-            Zp = p;
-        }
-    }
+    /* Free all paths at once. Any being returned to caller have already been copied */
+    ArenaRelease(&Arena);
     FreeFn(Nodes);
     return e;
 }
@@ -416,6 +416,54 @@ void TestCli::testAddGroup()
     QCOMPARE(m_stdout->readAll(), QByteArray());
 }
 
+void TestCli::testCompressionOptions_data()
+{
+    QTest::addColumn<QStringList>("options");
+    QTest::addColumn<QString>("error");
+
+    QTest::newRow("named level") << QStringList({"--compression-level", "best"}) << QString();
+    QTest::newRow("numeric level and buffer")
+        << QStringList({"--compression-level", "3", "--compression-buffer-size", "1024"}) << QString();
+    QTest::newRow("level too high") << QStringList({"--compression-level", "10"})
+                                    << QString("Invalid compression level 10.\n");
+    QTest::newRow("unknown level") << QStringList({"--compression-level", "fastest"})
+                                   << QString("Invalid compression level fastest.\n");
+    QTest::newRow("buffer too small")
+        << QStringList({"--compression-buffer-size", "2"})
+        << QString("Invalid compression buffer size 2, must be between 4 and 65536 KiB.\n");
+    QTest::newRow("buffer too large")
+        << QStringList({"--compression-buffer-size", "65537"})
+        << QString("Invalid compression buffer size 65537, must be between 4 and 65536 KiB.\n");
+}
+
+void TestCli::testCompressionOptions()
+{
+    QFETCH(QStringList, options);
+    QFETCH(QString, error);
+
+    AddGroup addGroupCmd;
+    setInput("a");
+    const int ret = execCmd(addGroupCmd, QStringList({"mkdir"}) << options << m_dbFile->fileName() << "/compressed");
+    if (error.isEmpty()) {
+        QCOMPARE(ret, EXIT_SUCCESS);
+        m_stderr->readLine(); // Skip password prompt
+        QCOMPARE(m_stderr->readAll(), QByteArray());
+        auto db = readDatabase();
+        QVERIFY(db->rootGroup()->findGroupByPath("compressed"));
+    } else {
+        // Invalid values are rejected before the password prompt
+        QCOMPARE(ret, EXIT_FAILURE);
+        QCOMPARE(QString(m_stderr->readAll()), error);
+        QCOMPARE(m_stdout->readAll(), QByteArray());
+    }
+
+    // Commands that do not save the database do not accept the options
+    List listCmd;
+    setInput("a");
+    QCOMPARE(execCmd(listCmd, QStringList({"ls"}) << options << m_dbFile->fileName()), EXIT_FAILURE);
+    QVERIFY(m_stderr->readAll().contains("Unknown option"));
+}
+
 void TestCli::testAnalyze()
 {
     Analyze analyzeCmd;
@@ -431,6 +479,43 @@ void TestCli::testAnalyze()
     QVERIFY(output.contains("123"));
     m_stderr->readLine(); // Skip password prompt
     QCOMPARE(m_stderr->readAll(), QByteArray());
+
+    // Indexes can only be built from files ordered by hash
+    QFile hibpFile(hibpPath);
+    QVERIFY(hibpFile.open(QIODevice::ReadOnly));
+    QList<QByteArray> hibpLines = hibpFile.readAll().split('\n');
+    hibpLines.removeAll(QByteArray());
+    std::sort(hibpLines.begin(), hibpLines.end());
+
+    QScopedPointer<QTemporaryDir> testDir(new QTemporaryDir());
+    const QString sortedHibpPath = testDir->path() + "/hibp-sorted.txt";
+    QFile sortedHibpFile(sortedHibpPath);
+    QVERIFY(sortedHibpFile.open(QIODevice::WriteOnly));
+    sortedHibpFile.write(hibpLines.join('\n'));
+    sortedHibpFile.close();
+
+    const QString indexPath = testDir->path() + "/hibp.idx";
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--hibp", sortedHibpPath, "--build-hibp-index", indexPath, m_dbFile->fileName()});
+    output = m_stdout->readAll();
+    QVERIFY(output.contains("Sample Entry"));
+    QVERIFY(output.contains("123"));
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+    QVERIFY(QFile::exists(indexPath));
+
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--hibp", indexPath, m_dbFile->fileName()});
+    output = m_stdout->readAll();
+    QVERIFY(output.contains("Sample Entry"));
+    QVERIFY(output.contains("123"));
+    m_stderr->readLine(); // Skip password prompt
+    QCOMPARE(m_stderr->readAll(), QByteArray());
+
+    setInput("a");
+    execCmd(analyzeCmd, {"analyze", "--hibp", hibpPath, "--build-hibp-index", indexPath, m_dbFile->fileName()});
+    m_stderr->readLine(); // Skip password prompt
+    QVERIFY(m_stderr->readAll().contains("only files ordered by hash can be indexed"));
 }
 
 void TestCli::testClip()
@@ -974,6 +1059,14 @@ void TestCli::testExport()
     QVERIFY(csvData.contains(QByteArray(
         "\"NewDatabase\",\"Sample Entry\",\"User Name\",\"Password\",\"http://www.somesite.com/\",\"Notes\"")));
 
+    // HTML exporting
+    setInput("a");
+    execCmd(exportCmd, {"export", "-f", "html", m_dbFile->fileName()});
+    QByteArray htmlData = m_stdout->readAll();
+    QVERIFY(htmlData.startsWith("<html>"));
+    QVERIFY(htmlData.contains("<h3>Sample Entry</h3>"));
+    QVERIFY(htmlData.trimmed().endsWith("</html>"));
+
     // test invalid format
     setInput("a");
     execCmd(exportCmd, {"export", "-f", "yaml", m_dbFile->fileName()});
@@ -53,6 +53,8 @@ private slots:
     void testClip();
     void testCommandParsing_data();
     void testCommandParsing();
+    void testCompressionOptions_data();
+    void testCompressionOptions();
     void testCreate();
     void testDiceware();
     void testEdit();
@@ -0,0 +1,334 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestCryptoBenchmark.h"
+
+#include <QBuffer>
+#include <QTest>
+
+#include "crypto/Crypto.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/SymmetricCipher.h"
+#include "crypto/kdf/AesKdf.h"
+#include "crypto/kdf/Argon2Kdf.h"
+#include "format/KeePass2RandomStream.h"
+#include "streams/HashedBlockStream.h"
+#include "streams/HmacBlockStream.h"
+#include "streams/QtIOCompressor"
+#include "streams/SymmetricCipherStream.h"
+#include "util/BenchmarkReport.h"
+
+QTEST_GUILESS_MAIN(TestCryptoBenchmark)
+Q_DECLARE_METATYPE(SymmetricCipher::Algorithm);
+Q_DECLARE_METATYPE(SymmetricCipher::Mode);
+
+namespace
+{
+    const int MinMsec = 500;
+    const int StreamPayloadSize = 16 * 1024 * 1024;
+
+    QByteArray benchmarkPayload(int size)
+    {
+        // mildly compressible so QtIOCompressor does representative work
+        QByteArray data(size, '\0');
+        quint32 state = 0x12345678;
+        for (int i = 0; i < size; ++i) {
+            state = state * 1103515245 + 12345;
+            data[i] = static_cast<char>((state >> 16) & 0x3F);
+        }
+        return data;
+    }
+
+    QByteArray rowName(const char* name, int size)
+    {
+        return QByteArray(name) + ' ' + QByteArray::number(size);
+    }
+
+    QIODevice* createStream(const QString& type, QIODevice* baseDevice, SymmetricCipher::Direction direction)
+    {
+        const QByteArray key(32, '\x4B');
+        if (type == "HashedBlockStream") {
+            return new HashedBlockStream(baseDevice);
+        } else if (type == "HmacBlockStream") {
+            return new HmacBlockStream(baseDevice, QByteArray(64, '\x4B'));
+        } else if (type == "QtIOCompressor") {
+            auto compressor = new QtIOCompressor(baseDevice);
+            compressor->setStreamFormat(QtIOCompressor::GzipFormat);
+            return compressor;
+        } else if (type == "SymmetricCipherStream/AES256-CBC") {
+            auto stream =
+                new SymmetricCipherStream(baseDevice, SymmetricCipher::Aes256, SymmetricCipher::Cbc, direction);
+            stream->init(key, QByteArray(16, '\0'));
+            return stream;
+        } else if (type == "SymmetricCipherStream/Twofish-CBC") {
+            auto stream =
+                new SymmetricCipherStream(baseDevice, SymmetricCipher::Twofish, SymmetricCipher::Cbc, direction);
+            stream->init(key, QByteArray(16, '\0'));
+            return stream;
+        } else if (type == "SymmetricCipherStream/ChaCha20") {
+            auto stream =
+                new SymmetricCipherStream(baseDevice, SymmetricCipher::ChaCha20, SymmetricCipher::Stream, direction);
+            stream->init(key, QByteArray(12, '\0'));
+            return stream;
+        }
+        Q_ASSERT(false);
+        return nullptr;
+    }
+} // namespace
+
+TestCryptoBenchmark::TestCryptoBenchmark()
+    : m_report(new BenchmarkReport("crypto"))
+{
+}
+
+TestCryptoBenchmark::~TestCryptoBenchmark()
+{
+}
+
+void TestCryptoBenchmark::initTestCase()
+{
+    if (!BenchmarkReport::isEnabled()) {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+    QVERIFY(Crypto::init());
+}
+
+void TestCryptoBenchmark::cleanupTestCase()
+{
+    if (BenchmarkReport::isEnabled()) {
+        QVERIFY(m_report->write());
+    }
+}
+
+void TestCryptoBenchmark::benchmarkKdf_data()
+{
+    QTest::addColumn<QString>("kdf");
+    QTest::addColumn<int>("rounds");
+    QTest::addColumn<int>("memory");
+    QTest::addColumn<int>("parallelism");
+
+    QTest::newRow("AES-KDF 100k") << "aes" << 100000 << 0 << 1;
+    QTest::newRow("AES-KDF 1M") << "aes" << 1000000 << 0 << 1;
+    QTest::newRow("Argon2 64MiB x1") << "argon2" << 2 << 64 * 1024 << 1;
+    QTest::newRow("Argon2 64MiB x4") << "argon2" << 2 << 64 * 1024 << 4;
+    QTest::newRow("Argon2 256MiB x4") << "argon2" << 2 << 256 * 1024 << 4;
+}
+
+void TestCryptoBenchmark::benchmarkKdf()
+{
+    QFETCH(QString, kdf);
+    QFETCH(int, rounds);
+    QFETCH(int, memory);
+    QFETCH(int, parallelism);
+
+    QSharedPointer<Kdf> instance;
+    if (kdf == "aes") {
+        instance = QSharedPointer<AesKdf>::create();
+    } else {
+        auto argon2 = QSharedPointer<Argon2Kdf>::create();
+        QVERIFY(argon2->setMemory(static_cast<quint64>(memory)));
+        QVERIFY(argon2->setParallelism(static_cast<quint32>(parallelism)));
+        instance = argon2;
+    }
+    QVERIFY(instance->setRounds(rounds));
+    QVERIFY(instance->setSeed(QByteArray(32, '\x4B')));
+
+    const QByteArray raw(32, '\x7E');
+    QByteArray result;
+    bool ok = true;
+    int iterations;
+    qint64 nsecs = BenchmarkReport::measure([&] { ok &= instance->transform(raw, result); }, MinMsec, &iterations);
+    QVERIFY(ok);
+
+    QVariantMap parameters{{"kdf", kdf}, {"rounds", rounds}, {"memory", memory}, {"parallelism", parallelism}};
+    m_report->addResult("kdf", parameters, nsecs, iterations);
+}
+
+void TestCryptoBenchmark::benchmarkCipher_data()
+{
+    QTest::addColumn<SymmetricCipher::Algorithm>("algorithm");
+    QTest::addColumn<SymmetricCipher::Mode>("mode");
+    QTest::addColumn<int>("ivSize");
+    QTest::addColumn<int>("size");
+
+    for (int size : {1024, 64 * 1024, 1024 * 1024}) {
+        // clang-format off
+        QTest::newRow(rowName("AES256-CBC", size)) << SymmetricCipher::Aes256 << SymmetricCipher::Cbc << 16 << size;
+        QTest::newRow(rowName("AES256-CTR", size)) << SymmetricCipher::Aes256 << SymmetricCipher::Ctr << 16 << size;
+        QTest::newRow(rowName("Twofish-CBC", size)) << SymmetricCipher::Twofish << SymmetricCipher::Cbc << 16 << size;
+        QTest::newRow(rowName("ChaCha20", size)) << SymmetricCipher::ChaCha20 << SymmetricCipher::Stream << 12 << size;
+        QTest::newRow(rowName("Salsa20", size)) << SymmetricCipher::Salsa20 << SymmetricCipher::Stream << 8 << size;
+        // clang-format on
+    }
+}
+
+void TestCryptoBenchmark::benchmarkCipher()
+{
+    QFETCH(SymmetricCipher::Algorithm, algorithm);
+    QFETCH(SymmetricCipher::Mode, mode);
+    QFETCH(int, ivSize);
+    QFETCH(int, size);
+
+    SymmetricCipher cipher(algorithm, mode, SymmetricCipher::Encrypt);
+    QVERIFY(cipher.init(QByteArray(32, '\x4B'), QByteArray(ivSize, '\0')));
+
+    QByteArray data = benchmarkPayload(size);
+    bool ok = true;
+    int iterations;
+    qint64 nsecs = BenchmarkReport::measure([&] { ok &= cipher.processInPlace(data); }, MinMsec, &iterations);
+    QVERIFY(ok);
+
+    QVariantMap parameters{{"cipher", QString::fromLatin1(QTest::currentDataTag()).section(' ', 0, 0)},
+                           {"size", size}};
+    m_report->addResult("cipher", parameters, nsecs, iterations, size);
+}
+
+void TestCryptoBenchmark::benchmarkHash_data()
+{
+    QTest::addColumn<int>("algorithm");
+    QTest::addColumn<bool>("hmac");
+    QTest::addColumn<int>("size");
+
+    for (int size : {64, 1024, 1024 * 1024}) {
+        QTest::newRow(rowName("SHA-256", size)) << int(CryptoHash::Sha256) << false << size;
+        QTest::newRow(rowName("SHA-512", size)) << int(CryptoHash::Sha512) << false << size;
+        QTest::newRow(rowName("HMAC-SHA-256", size)) << int(CryptoHash::Sha256) << true << size;
+        QTest::newRow(rowName("HMAC-SHA-512", size)) << int(CryptoHash::Sha512) << true << size;
+    }
+}
+
+void TestCryptoBenchmark::benchmarkHash()
+{
+    QFETCH(int, algorithm);
+    QFETCH(bool, hmac);
+    QFETCH(int, size);
+
+    const auto algo = static_cast<CryptoHash::Algorithm>(algorithm);
+    const QByteArray key(64, '\x4B');
+    const QByteArray data = benchmarkPayload(size);
+    QByteArray result;
+    int iterations;
+    qint64 nsecs = BenchmarkReport::measure(
+        [&] { result = hmac ? CryptoHash::hmac(data, key, algo) : CryptoHash::hash(data, algo); },
+        MinMsec,
+        &iterations);
+    QVERIFY(!result.isEmpty());
+
+    QVariantMap parameters{{"hash", QString::fromLatin1(QTest::currentDataTag()).section(' ', 0, 0)},
+                           {"size", size}};
+    m_report->addResult("hash", parameters, nsecs, iterations, size);
+}
+
+void TestCryptoBenchmark::benchmarkStream_data()
+{
+    QTest::addColumn<QString>("stream");
+    QTest::addColumn<int>("chunkSize");
+
+    const QStringList streams{"HashedBlockStream",
+                              "HmacBlockStream",
+                              "QtIOCompressor",
+                              "SymmetricCipherStream/AES256-CBC",
+                              "SymmetricCipherStream/Twofish-CBC",
+                              "SymmetricCipherStream/ChaCha20"};
+    for (const QString& stream : streams) {
+        for (int chunkSize : {4 * 1024, 64 * 1024, 1024 * 1024}) {
+            QTest::newRow(rowName(qPrintable(stream), chunkSize)) << stream << chunkSize;
+        }
+    }
+}
+
+void TestCryptoBenchmark::benchmarkStream()
+{
+    QFETCH(QString, stream);
+    QFETCH(int, chunkSize);
+
+    const QByteArray payload = benchmarkPayload(StreamPayloadSize);
+    QByteArray encoded;
+    bool ok = true;
+
+    int writeIterations;
+    qint64 writeNsecs = BenchmarkReport::measure(
+        [&] {
+            QBuffer buffer(&encoded);
+            buffer.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            QScopedPointer<QIODevice> device(createStream(stream, &buffer, SymmetricCipher::Encrypt));
+            ok &= device->open(QIODevice::WriteOnly);
+            for (int offset = 0; offset < payload.size(); offset += chunkSize) {
+                const qint64 length = qMin(chunkSize, payload.size() - offset);
+                ok &= device->write(payload.constData() + offset, length) == length;
+            }
+            device->close();
+        },
+        MinMsec,
+        &writeIterations);
+    QVERIFY(ok);
+
+    QByteArray chunk(chunkSize, '\0');
+    int readIterations;
+    qint64 readNsecs = BenchmarkReport::measure(
+        [&] {
+            QBuffer buffer(&encoded);
+            buffer.open(QIODevice::ReadOnly);
+            QScopedPointer<QIODevice> device(createStream(stream, &buffer, SymmetricCipher::Decrypt));
+            ok &= device->open(QIODevice::ReadOnly);
+            qint64 total = 0;
+            qint64 bytesRead;
+            while ((bytesRead = device->read(chunk.data(), chunk.size())) > 0) {
+                total += bytesRead;
+            }
+            ok &= total == payload.size();
+            device->close();
+        },
+        MinMsec,
+        &readIterations);
+    QVERIFY(ok);
+
+    QVariantMap parameters{{"stream", stream}, {"chunkSize", chunkSize}};
+    m_report->addResult("stream-write", parameters, writeNsecs, writeIterations, payload.size());
+    m_report->addResult("stream-read", parameters, readNsecs, readIterations, payload.size());
+}
+
+void TestCryptoBenchmark::benchmarkRandomStream_data()
+{
+    QTest::addColumn<int>("algorithm");
+    QTest::addColumn<int>("size");
+
+    for (int size : {16, 256, 4096}) {
+        QTest::newRow(rowName("Salsa20", size)) << int(KeePass2::ProtectedStreamAlgo::Salsa20) << size;
+        QTest::newRow(rowName("ChaCha20", size)) << int(KeePass2::ProtectedStreamAlgo::ChaCha20) << size;
+    }
+}
+
+void TestCryptoBenchmark::benchmarkRandomStream()
+{
+    QFETCH(int, algorithm);
+    QFETCH(int, size);
+
+    KeePass2RandomStream randomStream(static_cast<KeePass2::ProtectedStreamAlgo>(algorithm));
+    QVERIFY(randomStream.init(QByteArray(64, '\x4B')));
+
+    // one iteration corresponds to one protected value
+    QByteArray value = benchmarkPayload(size);
+    bool ok = true;
+    int iterations;
+    qint64 nsecs = BenchmarkReport::measure([&] { ok &= randomStream.processInPlace(value); }, MinMsec, &iterations);
+    QVERIFY(ok);
+
+    QVariantMap parameters{{"algorithm", QString::fromLatin1(QTest::currentDataTag()).section(' ', 0, 0)},
+                           {"size", size}};
+    m_report->addResult("random-stream", parameters, nsecs, iterations, size);
+}
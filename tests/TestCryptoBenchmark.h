@@ -0,0 +1,52 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_TESTCRYPTOBENCHMARK_H
+#define KEEPASSXC_TESTCRYPTOBENCHMARK_H
+
+#include <QObject>
+#include <QScopedPointer>
+
+class BenchmarkReport;
+
+class TestCryptoBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestCryptoBenchmark();
+    ~TestCryptoBenchmark() override;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkKdf_data();
+    void benchmarkKdf();
+    void benchmarkCipher_data();
+    void benchmarkCipher();
+    void benchmarkHash_data();
+    void benchmarkHash();
+    void benchmarkStream_data();
+    void benchmarkStream();
+    void benchmarkRandomStream_data();
+    void benchmarkRandomStream();
+
+private:
+    QScopedPointer<BenchmarkReport> m_report;
+};
+
+#endif // KEEPASSXC_TESTCRYPTOBENCHMARK_H
@@ -18,6 +18,7 @@
 
 #include "TestCsvParser.h"
 
+#include <QBuffer>
 #include <QTest>
 
 QTEST_GUILESS_MAIN(TestCsvParser)
@@ -344,3 +345,77 @@ void TestCsvParser::testUnicode()
     QVERIFY(t.at(0).at(2) == "3śAż");
     QVERIFY(t.at(0).at(3) == "żac");
 }
+
+CsvTable TestCsvParser::parseStreaming(const QByteArray& data)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    CsvTable table;
+    int maxCols = 0;
+    parser->parse(&buffer, [&](const CsvRow& row) {
+        table.append(row);
+        maxCols = qMax(maxCols, row.size());
+        return true;
+    });
+
+    // fill up short rows like the buffered parser does
+    for (auto& row : table) {
+        while (row.size() < maxCols) {
+            row.append(QString());
+        }
+    }
+    return table;
+}
+
+void TestCsvParser::testStreaming_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<bool>("good");
+
+    QTest::newRow("simple") << QByteArray(",,2\r,2,3\nA,,B\"\n ,,\n") << true;
+    QTest::newRow("crlf") << QByteArray("1,2\r\n3,4\r\n\r\n") << true;
+    QTest::newRow("quoted") << QByteArray("ro,w,\"end, of \"\"\"\"\"\"row\"\"\"\"\"\n2\n") << true;
+    QTest::newRow("multiline") << QByteArray("\"1\r\n2a\"\"b\",\"3\r4\"\n2\n") << true;
+    QTest::newRow("comments") << QByteArray("  #one\n \t  # two, three \r\n #, sing\t with\r #\t  me!\nuseful,text #1!")
+                              << true;
+    QTest::newRow("columns") << QByteArray("1,2\n,,,,,,,,,a\na,b,c,d\n") << true;
+    QTest::newRow("unicode") << QString("\u20ac1,2\u015b,\"3\u015b,\u017c\"").toUtf8() << true;
+    QTest::newRow("missing quote") << QByteArray("A,B\n\"BM,1") << false;
+    QTest::newRow("empty") << QByteArray() << true;
+}
+
+void TestCsvParser::testStreaming()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(bool, good);
+
+    file->write(data);
+    file->flush();
+    QCOMPARE(parser->parse(file.data()), good);
+    const CsvTable expected = parser->getCsvTable();
+
+    QCOMPARE(parseStreaming(data), expected);
+    QCOMPARE(parser->getCsvRows(), expected.size());
+    QCOMPARE(parser->getFileSize(), data.size());
+}
+
+void TestCsvParser::testStreamingLarge()
+{
+    // rows, quoted line breaks and multi-byte characters cross the read blocks
+    QByteArray data;
+    for (int i = 0; i < 5000; ++i) {
+        data.append(QString("entry %1,\"user\"\"%1\",\"line\r\nbreak \u00e9\u20ac\",%1\r\n").arg(i).toUtf8());
+    }
+    QVERIFY(data.size() > 4 * 64 * 1024);
+
+    const CsvTable table = parseStreaming(data);
+    QCOMPARE(table.size(), 5000);
+    QCOMPARE(table.at(4321), CsvRow({"entry 4321", "user\"4321", QString("line\nbreak \u00e9\u20ac"), "4321"}));
+
+    // stop early once enough rows have been seen
+    QBuffer buffer;
+    buffer.setData(data);
+    int rows = 0;
+    QVERIFY(parser->parse(&buffer, [&](const CsvRow&) { return ++rows < 10; }));
+    QCOMPARE(rows, 10);
+}
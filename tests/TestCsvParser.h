@@ -59,12 +59,16 @@ private slots:
     void testQuoted();
     void testMultiline();
     void testColumns();
+    void testStreaming();
+    void testStreaming_data();
+    void testStreamingLarge();
 
 private:
     QScopedPointer<QTemporaryFile> file;
     QScopedPointer<CsvParser> parser;
     CsvTable t;
     void dumpRow(CsvTable table, int row);
+    CsvTable parseStreaming(const QByteArray& data);
 };
 
 #endif // KEEPASSX_TESTCSVPARSER_H
@@ -22,10 +22,13 @@
 #include <QSignalSpy>
 
 #include "config-keepassx-tests.h"
+#include "core/Group.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
+#include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/PasswordKey.h"
+#include "streams/MappedFileBuffer.h"
 #include "util/TemporaryFile.h"
 
 QTEST_GUILESS_MAIN(TestDatabase)
@@ -56,6 +59,47 @@ void TestDatabase::testOpen()
     QVERIFY(db->isModified());
 }
 
+void TestDatabase::testOpenMapped()
+{
+    auto key = QSharedPointer<CompositeKey>::create();
+    key->addKey(QSharedPointer<PasswordKey>::create("a"));
+
+    QFile file(dbFileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    // read from the file itself, which copies the header through a separate stream
+    Database fileDb;
+    KeePass2Reader fileReader;
+    QVERIFY(fileReader.readDatabase(&file, key, &fileDb));
+
+    // read from the mapping, which parses the header and HMAC blocks in place
+    MappedFileBuffer mappedFile;
+    if (!mappedFile.map(&file)) {
+        QSKIP("Files are only mapped on local filesystems.");
+    }
+    Database mappedDb;
+    KeePass2Reader mappedReader;
+    QVERIFY(mappedReader.readDatabase(&mappedFile, key, &mappedDb));
+    mappedFile.unmap();
+
+    QCOMPARE(mappedDb.metadata()->name(), fileDb.metadata()->name());
+    const QList<Entry*> fileEntries = fileDb.rootGroup()->entriesRecursive(true);
+    const QList<Entry*> mappedEntries = mappedDb.rootGroup()->entriesRecursive(true);
+    QCOMPARE(mappedEntries.size(), fileEntries.size());
+    for (int i = 0; i < fileEntries.size(); ++i) {
+        QCOMPARE(mappedEntries[i]->uuid(), fileEntries[i]->uuid());
+        QCOMPARE(mappedEntries[i]->password(), fileEntries[i]->password());
+    }
+
+    // a wrong key is still detected by the header HMAC
+    auto wrongKey = QSharedPointer<CompositeKey>::create();
+    wrongKey->addKey(QSharedPointer<PasswordKey>::create("b"));
+    QVERIFY(mappedFile.map(&file));
+    Database wrongDb;
+    KeePass2Reader wrongReader;
+    QVERIFY(!wrongReader.readDatabase(&mappedFile, wrongKey, &wrongDb));
+}
+
 void TestDatabase::testSave()
 {
     TemporaryFile tempFile;
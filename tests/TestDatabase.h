@@ -28,6 +28,7 @@ class TestDatabase : public QObject
 private slots:
     void initTestCase();
     void testOpen();
+    void testOpenMapped();
     void testSave();
     void testSignals();
     void testEmptyRecycleBinOnDisabled();
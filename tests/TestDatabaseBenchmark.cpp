@@ -0,0 +1,277 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestDatabaseBenchmark.h"
+#include "TestGlobal.h"
+
+#include <QBuffer>
+#include <QElapsedTimer>
+
+#include "config-keepassx.h"
+#include "core/Database.h"
+#include "core/EntrySearcher.h"
+#include "core/Group.h"
+#include "core/Merger.h"
+#include "core/PasswordHealth.h"
+#include "crypto/Crypto.h"
+#include "crypto/kdf/Argon2Kdf.h"
+#include "format/KdbxXmlReader.h"
+#include "format/KeePass2.h"
+#include "keys/PasswordKey.h"
+#include "util/BenchmarkReport.h"
+#include "util/DatabaseGenerator.h"
+#include "util/TemporaryFile.h"
+
+#ifdef WITH_XC_BROWSER
+#include "browser/BrowserService.h"
+#endif
+
+QTEST_GUILESS_MAIN(TestDatabaseBenchmark)
+
+namespace
+{
+    QSharedPointer<CompositeKey> benchmarkKey()
+    {
+        auto key = QSharedPointer<CompositeKey>::create();
+        key->addKey(QSharedPointer<PasswordKey>::create("benchmark"));
+        return key;
+    }
+
+    QStringList strengthPasswords()
+    {
+        const QStringList words{"correct", "horse", "battery", "staple", "Password", "dragon", "monkey", "sunshine"};
+        const QStringList suffixes{"", "1", "123", "!", "2020", "qwerty", "01/02/1999", "aaaa"};
+        QStringList passwords;
+        for (int i = 0; i < words.size(); ++i) {
+            for (int j = 0; j < suffixes.size(); ++j) {
+                passwords << words[i] + words[(i + j) % words.size()] + suffixes[j];
+            }
+        }
+        // a few random looking ones that fall back to brute force
+        passwords << "MIhIN9UKrgtPL2hp" << "Yohb2ChR4" << "x#9vP!q2Lm@7zR$w"
+                  << "prompter-ream-oversleep-step-extortion";
+        return passwords;
+    }
+} // namespace
+
+TestDatabaseBenchmark::TestDatabaseBenchmark()
+    : m_report(new BenchmarkReport("database"))
+{
+}
+
+TestDatabaseBenchmark::~TestDatabaseBenchmark()
+{
+}
+
+void TestDatabaseBenchmark::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void TestDatabaseBenchmark::cleanupTestCase()
+{
+    if (BenchmarkReport::isEnabled()) {
+        QVERIFY(m_report->write());
+    }
+}
+
+void TestDatabaseBenchmark::testGeneratorDeterministic()
+{
+    DatabaseGenerator::Options options;
+    options.entries = 200;
+    options.groupDepth = 2;
+    options.historyDepth = 2;
+    options.attachmentSize = 128;
+    options.referenceInterval = 10;
+    options.customAttributes = 3;
+
+    auto db1 = DatabaseGenerator(options).generate();
+    auto db2 = DatabaseGenerator(options).generate();
+
+    const QList<Entry*> entries1 = db1->rootGroup()->entriesRecursive();
+    const QList<Entry*> entries2 = db2->rootGroup()->entriesRecursive();
+    QCOMPARE(entries1.size(), options.entries);
+    QCOMPARE(entries2.size(), options.entries);
+    QCOMPARE(db1->rootGroup()->groupsRecursive(false).size(), 4 + 16);
+    QCOMPARE(db1->rootGroup()->uuid(), db2->rootGroup()->uuid());
+
+    for (int i = 0; i < entries1.size(); ++i) {
+        QCOMPARE(entries1[i]->uuid(), entries2[i]->uuid());
+        QCOMPARE(entries1[i]->username(), entries2[i]->username());
+        QCOMPARE(entries1[i]->password(), entries2[i]->password());
+        QCOMPARE(entries1[i]->timeInfo().creationTime(), entries2[i]->timeInfo().creationTime());
+        QCOMPARE(entries1[i]->attributes()->customKeys().size(), options.customAttributes);
+        QCOMPARE(entries1[i]->attachments()->values(), entries2[i]->attachments()->values());
+        QCOMPARE(entries1[i]->historyItems().size(), options.historyDepth);
+    }
+
+    options.seed = 2;
+    auto db3 = DatabaseGenerator(options).generate();
+    QVERIFY(db3->rootGroup()->uuid() != db1->rootGroup()->uuid());
+}
+
+void TestDatabaseBenchmark::benchmarkScale_data()
+{
+    QTest::addColumn<int>("entries");
+
+    QTest::newRow("1k") << 1000;
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+}
+
+void TestDatabaseBenchmark::benchmarkScale()
+{
+    if (!BenchmarkReport::isEnabled()) {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    QFETCH(int, entries);
+
+    DatabaseGenerator::Options options;
+    options.entries = entries;
+    options.groupDepth = 3;
+    options.groupsPerLevel = 4;
+    options.historyDepth = 2;
+    options.attachmentSize = 4096;
+    options.attachmentInterval = 50;
+    options.referenceInterval = 20;
+    options.customAttributes = 2;
+
+    const QVariantMap parameters{{"entries", entries},
+                                 {"groupDepth", options.groupDepth},
+                                 {"historyDepth", options.historyDepth},
+                                 {"attachmentSize", options.attachmentSize},
+                                 {"customAttributes", options.customAttributes}};
+    auto addResult = [&](const QString& name, qint64 nsecs) {
+        QVariantMap resultParameters = parameters;
+        resultParameters.insert("peakRss", BenchmarkReport::peakRss());
+        m_report->addResult(name, resultParameters, nsecs, 1);
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    auto db = DatabaseGenerator(options).generate();
+    addResult("generate", timer.nsecsElapsed());
+
+    // keep the KDF cheap so it does not dominate open and save
+    auto kdf = QSharedPointer<Argon2Kdf>::create();
+    kdf->setMemory(1024);
+    kdf->setRounds(1);
+    kdf->setParallelism(1);
+    db->setKdf(kdf);
+    QVERIFY(db->setKey(benchmarkKey()));
+
+    TemporaryFile file;
+    QVERIFY(file.open());
+    file.close();
+
+    QString error;
+    timer.restart();
+    QVERIFY2(db->saveAs(file.fileName(), &error, false), qPrintable(error));
+    addResult("save", timer.nsecsElapsed());
+
+    auto reopened = QSharedPointer<Database>::create();
+    timer.restart();
+    QVERIFY2(reopened->open(file.fileName(), benchmarkKey(), &error), qPrintable(error));
+    addResult("open", timer.nsecsElapsed());
+    QCOMPARE(reopened->rootGroup()->entriesRecursive().size(), entries);
+
+    // parse the plain XML payload on its own, without KDF and decryption
+    QByteArray xml;
+    QVERIFY2(reopened->extract(xml, &error), qPrintable(error));
+    QBuffer xmlBuffer(&xml);
+    QVERIFY(xmlBuffer.open(QIODevice::ReadOnly));
+    KdbxXmlReader xmlReader(KeePass2::FILE_VERSION_4);
+    timer.restart();
+    auto parsed = xmlReader.readDatabase(&xmlBuffer);
+    const qint64 parseTime = timer.nsecsElapsed();
+    QVERIFY2(!xmlReader.hasError(), qPrintable(xmlReader.errorString()));
+    QVariantMap parseParameters = parameters;
+    parseParameters.insert("peakRss", BenchmarkReport::peakRss());
+    m_report->addResult("parse-xml", parseParameters, parseTime, 1, xml.size());
+    parsed.reset();
+    xmlBuffer.close();
+    xml.clear();
+
+    EntrySearcher searcher;
+    timer.restart();
+    QList<Entry*> found = searcher.search("alpha", reopened->rootGroup());
+    addResult("search", timer.nsecsElapsed());
+    QVERIFY(!found.isEmpty());
+
+    timer.restart();
+    found = searcher.search("user:example url:login -notes:bravo", reopened->rootGroup());
+    addResult("search-fields", timer.nsecsElapsed());
+
+    QSharedPointer<HealthChecker> checker;
+    timer.restart();
+    checker.reset(new HealthChecker(reopened));
+    for (const Entry* entry : reopened->rootGroup()->entriesRecursive()) {
+        checker->evaluate(entry);
+    }
+    addResult("health-check", timer.nsecsElapsed());
+
+#ifdef WITH_XC_BROWSER
+    timer.restart();
+    found = browserService()->searchEntries(reopened, "https://alpha1.example.com", "https://alpha1.example.com/login");
+    addResult("browser-search", timer.nsecsElapsed());
+#endif
+
+    // modify one percent of the entries in a copy and merge it back
+    auto modified = QSharedPointer<Database>::create();
+    modified->setRootGroup(reopened->rootGroup()->clone(Entry::CloneIncludeHistory, Group::CloneIncludeEntries));
+    const QList<Entry*> modifiedEntries = modified->rootGroup()->entriesRecursive();
+    for (int i = 0; i < modifiedEntries.size(); i += 100) {
+        modifiedEntries[i]->beginUpdate();
+        modifiedEntries[i]->setPassword(QStringLiteral("changed-%1").arg(i));
+        modifiedEntries[i]->endUpdate();
+    }
+
+    Merger merger(modified.data(), reopened.data());
+    timer.restart();
+    merger.merge();
+    addResult("merge", timer.nsecsElapsed());
+}
+
+void TestDatabaseBenchmark::benchmarkPasswordStrength()
+{
+    if (!BenchmarkReport::isEnabled()) {
+        QSKIP("Benchmark skipped. Set env variable BENCHMARK=1 to enable.");
+    }
+
+    const QStringList passwords = strengthPasswords();
+    double score = 0;
+    int iterations = 0;
+    // clear the cache on every pass so each estimate runs zxcvbn
+    const qint64 nsecs = BenchmarkReport::measure(
+        [&] {
+            PasswordHealth::clearEntropyCache();
+            for (const QString& password : passwords) {
+                score += PasswordHealth(password).entropy();
+            }
+        },
+        500,
+        &iterations);
+    QVERIFY(score > 0);
+
+    // measure() returns the time of a single pass over all passwords
+    const double estimatesPerSecond = passwords.size() * 1000000000.0 / nsecs;
+    m_report->addResult("password-strength",
+                        {{"passwords", passwords.size()}, {"estimatesPerSecond", estimatesPerSecond}},
+                        nsecs,
+                        iterations);
+}
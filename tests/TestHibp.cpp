@@ -27,9 +27,15 @@
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QCryptographicHash>
 #include <QFile>
+#include <QHash>
 #include <QList>
+#include <QTemporaryFile>
 #include <QTest>
+#include <QtEndian>
+
+#include <algorithm>
 
 QTEST_GUILESS_MAIN(TestHibp)
 
@@ -38,6 +44,31 @@ const char* TEST_HIBP_CONTENTS = "0BEEC7B5EA3F0FDBC95D0DD47F3C5BC275DA8A33:123\n
 
 const char* TEST_BAD_HIBP_CONTENTS = "barf:nope\n";
 
+namespace
+{
+    QByteArray sha1Line(const QByteArray& data, int count)
+    {
+        return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex().toUpper() + ":"
+               + QByteArray::number(count) + "\r\n";
+    }
+
+    QByteArray sortedHibpContents(int lines)
+    {
+        QList<QByteArray> sorted;
+        for (int i = 0; i < lines; ++i) {
+            sorted << sha1Line(QByteArray::number(i), i + 1);
+        }
+        sorted << sha1Line("foo", 123) << sha1Line("bar", 456);
+        std::sort(sorted.begin(), sorted.end());
+
+        QByteArray contents;
+        for (const auto& line : asConst(sorted)) {
+            contents.append(line);
+        }
+        return contents;
+    }
+} // namespace
+
 void TestHibp::initTestCase()
 {
     QVERIFY(Crypto::init());
@@ -123,3 +154,265 @@ void TestHibp::testPwned()
     QCOMPARE(findings[1].first, entry4);
     QCOMPARE(findings[1].second, 456);
 }
+
+void TestHibp::testPwnedSortedFile()
+{
+    // Large enough for the binary search to take a few steps
+    QTemporaryFile hibpFile;
+    QVERIFY(hibpFile.open());
+    hibpFile.write(sortedHibpContents(10000));
+    QVERIFY(hibpFile.flush());
+    QVERIFY(hibpFile.seek(0));
+
+    Group* root = m_db->rootGroup();
+    QList<Entry*> entries;
+    const QStringList passwords({"foo", "xyz", "bar", "0", "9999", "foo"});
+    for (const QString& password : passwords) {
+        auto entry = new Entry();
+        entry->setPassword(password);
+        entry->setGroup(root);
+        entries << entry;
+    }
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(HibpOffline::report(m_db, hibpFile, findings, &error));
+    QCOMPARE(error, QString());
+
+    QHash<const Entry*, int> counts;
+    for (const auto& finding : findings) {
+        counts.insert(finding.first, finding.second);
+    }
+    QCOMPARE(findings.size(), 5);
+    QCOMPARE(counts.value(entries[0]), 123);
+    QVERIFY(!counts.contains(entries[1]));
+    QCOMPARE(counts.value(entries[2]), 456);
+    QCOMPARE(counts.value(entries[3]), 1);
+    QCOMPARE(counts.value(entries[4]), 10000);
+    QCOMPARE(counts.value(entries[5]), 123);
+}
+
+void TestHibp::testPwnedUnsortedFile()
+{
+    // Not ordered by hash, the whole file has to be read
+    QTemporaryFile hibpFile;
+    QVERIFY(hibpFile.open());
+    hibpFile.write(sha1Line("bar", 456) + sha1Line("foo", 123));
+    QVERIFY(hibpFile.flush());
+    QVERIFY(hibpFile.seek(0));
+
+    auto entry = new Entry();
+    entry->setPassword("foo");
+    entry->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(HibpOffline::report(m_db, hibpFile, findings, &error));
+    QCOMPARE(error, QString());
+    QCOMPARE(findings.size(), 1);
+    QCOMPARE(findings[0].second, 123);
+}
+
+void TestHibp::testUnsortedSearch()
+{
+    // The first lines are in order, the rest of the file is not
+    QList<QByteArray> lines;
+    for (int i = 0; i < 1000; ++i) {
+        lines << sha1Line(QByteArray::number(i), i + 1);
+    }
+    std::sort(lines.begin(), lines.begin() + 100);
+    std::sort(lines.begin() + 100, lines.end(), [](const QByteArray& a, const QByteArray& b) { return b < a; });
+
+    QTemporaryFile hibpFile;
+    QVERIFY(hibpFile.open());
+    for (const auto& line : lines) {
+        hibpFile.write(line);
+    }
+    QVERIFY(hibpFile.flush());
+    QVERIFY(hibpFile.seek(0));
+
+    auto entry = new Entry();
+    entry->setPassword("foo");
+    entry->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY(!HibpOffline::report(m_db, hibpFile, findings, &error));
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(findings.size(), 0);
+}
+
+void TestHibp::testIndex()
+{
+    QByteArray hibpContents = sortedHibpContents(10000);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QTemporaryFile indexFile;
+    QVERIFY(indexFile.open());
+    QString error;
+    QVERIFY2(HibpOffline::buildIndex(hibpBuffer, indexFile, &error), qPrintable(error));
+    QVERIFY(indexFile.flush());
+    QVERIFY(indexFile.seek(0));
+
+    Group* root = m_db->rootGroup();
+    QList<Entry*> entries;
+    const QStringList passwords({"foo", "xyz", "bar", "0", "9999"});
+    for (const QString& password : passwords) {
+        auto entry = new Entry();
+        entry->setPassword(password);
+        entry->setGroup(root);
+        entries << entry;
+    }
+
+    QList<QPair<const Entry*, int>> findings;
+    QVERIFY2(HibpOffline::report(m_db, indexFile, findings, &error), qPrintable(error));
+    QCOMPARE(error, QString());
+
+    QHash<const Entry*, int> counts;
+    for (const auto& finding : findings) {
+        counts.insert(finding.first, finding.second);
+    }
+    QCOMPARE(findings.size(), 4);
+    QCOMPARE(counts.value(entries[0]), 123);
+    QVERIFY(!counts.contains(entries[1]));
+    QCOMPARE(counts.value(entries[2]), 456);
+    QCOMPARE(counts.value(entries[3]), 1);
+    QCOMPARE(counts.value(entries[4]), 10000);
+}
+
+void TestHibp::testIndexUnsorted()
+{
+    QByteArray hibpContents = sha1Line("bar", 456) + sha1Line("foo", 123);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QByteArray index;
+    QBuffer indexBuffer(&index);
+    QVERIFY(indexBuffer.open(QIODevice::WriteOnly));
+    QString error;
+    QVERIFY(!HibpOffline::buildIndex(hibpBuffer, indexBuffer, &error));
+    QVERIFY(error.contains("line 2"));
+}
+
+void TestHibp::testIndexCorrupted()
+{
+    QByteArray hibpContents = sortedHibpContents(100);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QByteArray index;
+    QBuffer indexBuffer(&index);
+    QVERIFY(indexBuffer.open(QIODevice::WriteOnly));
+    QString error;
+    QVERIFY2(HibpOffline::buildIndex(hibpBuffer, indexBuffer, &error), qPrintable(error));
+    indexBuffer.close();
+
+    // A truncated index is not mistaken for a text file
+    QTemporaryFile indexFile;
+    QVERIFY(indexFile.open());
+    indexFile.write(index.left(index.size() - 1));
+    QVERIFY(indexFile.flush());
+    QVERIFY(indexFile.seek(0));
+
+    auto entry = new Entry();
+    entry->setPassword("foo");
+    entry->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QVERIFY(!HibpOffline::report(m_db, indexFile, findings, &error));
+    QVERIFY(!error.isEmpty());
+    QCOMPARE(findings.size(), 0);
+}
+
+void TestHibp::testIndexCorruptedTable_data()
+{
+    QTest::addColumn<int>("firstBucket");
+    QTest::addColumn<int>("lastBucket");
+
+    // bucket of SHA-1("foo") = 0beec7b5...
+    const int fooBucket = 0x0bee;
+    QTest::newRow("not monotonic") << fooBucket + 1 << fooBucket + 1;
+    QTest::newRow("count mismatch") << fooBucket + 1 << (1 << 16);
+}
+
+void TestHibp::testIndexCorruptedTable()
+{
+    QFETCH(int, firstBucket);
+    QFETCH(int, lastBucket);
+
+    QByteArray hibpContents = sortedHibpContents(100);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    QByteArray index;
+    QBuffer indexBuffer(&index);
+    QVERIFY(indexBuffer.open(QIODevice::WriteOnly));
+    QString error;
+    QVERIFY2(HibpOffline::buildIndex(hibpBuffer, indexBuffer, &error), qPrintable(error));
+    indexBuffer.close();
+
+    // Point the buckets far beyond the records, the size of the index stays valid
+    const int tableOffset = 8 + 4 + 4;
+    for (int bucket = firstBucket; bucket <= lastBucket; ++bucket) {
+        qToLittleEndian<quint32>(0x7ffffff0, reinterpret_cast<uchar*>(index.data()) + tableOffset + bucket * 4);
+    }
+
+    QTemporaryFile indexFile;
+    QVERIFY(indexFile.open());
+    indexFile.write(index);
+    QVERIFY(indexFile.flush());
+    QVERIFY(indexFile.seek(0));
+
+    auto entry = new Entry();
+    entry->setPassword("foo");
+    entry->setGroup(m_db->rootGroup());
+
+    QList<QPair<const Entry*, int>> findings;
+    QVERIFY(!HibpOffline::report(m_db, indexFile, findings, &error));
+    QVERIFY(error.contains("corrupted"));
+    QCOMPARE(findings.size(), 0);
+}
+
+void TestHibp::testScanChunks()
+{
+    // Not ordered by hash and larger than a chunk, so lines are split between reads
+    QByteArray hibpContents;
+    for (int i = 0; i < 120000; ++i) {
+        hibpContents.append(sha1Line(QByteArray::number(i), i + 1));
+    }
+    hibpContents.append("\r\n" + sha1Line("foo", 123));
+    hibpContents.chop(2);
+    QBuffer hibpBuffer(&hibpContents);
+    QVERIFY(hibpBuffer.open(QIODevice::ReadOnly));
+
+    Group* root = m_db->rootGroup();
+    QList<Entry*> entries;
+    const QStringList passwords({"foo", "119999", "xyz"});
+    for (const QString& password : passwords) {
+        auto entry = new Entry();
+        entry->setPassword(password);
+        entry->setGroup(root);
+        entries << entry;
+    }
+
+    qint64 lastProcessed = 0;
+    int progressCalls = 0;
+    auto progress = [&](qint64 processed, qint64 total) {
+        QCOMPARE(total, static_cast<qint64>(hibpContents.size()));
+        QVERIFY(processed >= lastProcessed);
+        lastProcessed = processed;
+        ++progressCalls;
+    };
+
+    QList<QPair<const Entry*, int>> findings;
+    QString error;
+    QVERIFY2(HibpOffline::report(m_db, hibpBuffer, findings, &error, progress), qPrintable(error));
+    QCOMPARE(findings.size(), 2);
+    QCOMPARE(findings[0].first, entries[1]);
+    QCOMPARE(findings[0].second, 120000);
+    QCOMPARE(findings[1].first, entries[0]);
+    QCOMPARE(findings[1].second, 123);
+    QVERIFY(progressCalls > 1);
+    QCOMPARE(lastProcessed, static_cast<qint64>(hibpContents.size()));
+}
@@ -34,6 +34,15 @@ private slots:
     void testEmpty();
     void testIoError();
     void testPwned();
+    void testPwnedSortedFile();
+    void testPwnedUnsortedFile();
+    void testUnsortedSearch();
+    void testIndex();
+    void testIndexUnsorted();
+    void testIndexCorrupted();
+    void testIndexCorruptedTable_data();
+    void testIndexCorruptedTable();
+    void testScanChunks();
 
 private:
     QSharedPointer<Database> m_db;
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestHibpDownloader.h"
+#include "TestGlobal.h"
+#include "mock/MockNetworkAccessManager.h"
+
+#include "core/HibpDownloader.h"
+#include "core/NetworkManager.h"
+
+#include <QCryptographicHash>
+#include <QSignalSpy>
+
+QTEST_GUILESS_MAIN(TestHibpDownloader)
+
+namespace
+{
+    const QString RANGE_URL = QStringLiteral("https://api.pwnedpasswords.com/range/");
+
+    QString sha1Hex(const QString& password)
+    {
+        return QCryptographicHash::hash(password.toUtf8(), QCryptographicHash::Sha1).toHex().toUpper();
+    }
+
+    QHash<QString, int> results(const QSignalSpy& spy)
+    {
+        QHash<QString, int> counts;
+        for (const auto& args : spy) {
+            counts.insert(args[0].toString(), args[1].toInt());
+        }
+        return counts;
+    }
+} // namespace
+
+void TestHibpDownloader::cleanupTestCase()
+{
+    setNetMgr(nullptr);
+}
+
+void TestHibpDownloader::testSharedPrefix()
+{
+    // The SHA1 hashes of both passwords start with D1000
+    QCOMPARE(sha1Hex("pwd220").left(5), QString("D1000"));
+    QCOMPARE(sha1Hex("pwd815").left(5), QString("D1000"));
+
+    MockNetworkAccessManager netMgr;
+    netMgr.setReply(RANGE_URL + "D1000",
+                    "0005AD76BD555C1D6D771DE417A4B87E4B4:10\r\n"
+                    + sha1Hex("pwd220").mid(5).toLatin1() + ":42\r\n"
+                    "FFFF00A3BD6EA2B0A87D5EB4F17D8DE3D47:3\r\n");
+    netMgr.setReply(RANGE_URL + sha1Hex("password").left(5), sha1Hex("password").mid(5).toLatin1() + ":3730471");
+    setNetMgr(&netMgr);
+
+    HibpDownloader downloader;
+    QSignalSpy spy(&downloader, SIGNAL(hibpResult(QString, int)));
+    downloader.add("pwd220");
+    downloader.add("pwd815");
+    downloader.add("password");
+    downloader.add("pwd220");
+    QCOMPARE(downloader.passwordsToValidate(), 3);
+
+    downloader.validate();
+    QCOMPARE(downloader.passwordsToValidate(), 0);
+    QCOMPARE(downloader.passwordsRemaining(), 3);
+    QTRY_COMPARE(downloader.passwordsRemaining(), 0);
+
+    // One request per hash prefix
+    QCOMPARE(netMgr.requests().size(), 2);
+    QCOMPARE(spy.size(), 3);
+    const auto counts = results(spy);
+    QCOMPARE(counts.value("pwd220"), 42);
+    QCOMPARE(counts.value("pwd815"), 0);
+    QCOMPARE(counts.value("password"), 3730471);
+
+    setNetMgr(nullptr);
+}
+
+void TestHibpDownloader::testConcurrencyLimit()
+{
+    MockNetworkAccessManager netMgr;
+    QStringList passwords;
+    for (int i = 0; i < 20; ++i) {
+        const auto password = QString("password%1").arg(i);
+        passwords << password;
+        netMgr.setReply(RANGE_URL + sha1Hex(password).left(5), sha1Hex(password).mid(5).toLatin1() + ":1");
+    }
+    setNetMgr(&netMgr);
+
+    HibpDownloader downloader;
+    QSignalSpy spy(&downloader, SIGNAL(hibpResult(QString, int)));
+    for (const auto& password : passwords) {
+        downloader.add(password);
+    }
+    downloader.validate();
+    QTRY_COMPARE(downloader.passwordsRemaining(), 0);
+
+    QCOMPARE(spy.size(), passwords.size());
+    QCOMPARE(netMgr.requests().size(), passwords.size());
+    QVERIFY(netMgr.maxConcurrentRequests() > 1);
+    QVERIFY(netMgr.maxConcurrentRequests() <= HibpDownloader::MAX_CONCURRENT_REQUESTS);
+    for (const auto& count : results(spy)) {
+        QCOMPARE(count, 1);
+    }
+
+    setNetMgr(nullptr);
+}
+
+void TestHibpDownloader::testFetchFailed()
+{
+    MockNetworkAccessManager netMgr;
+    setNetMgr(&netMgr);
+
+    HibpDownloader downloader;
+    QSignalSpy resultSpy(&downloader, SIGNAL(hibpResult(QString, int)));
+    QSignalSpy failedSpy(&downloader, SIGNAL(fetchFailed(QString)));
+    for (int i = 0; i < 10; ++i) {
+        downloader.add(QString("password%1").arg(i));
+    }
+    downloader.validate();
+
+    // The first failed request aborts the others
+    QTRY_COMPARE(failedSpy.size(), 1);
+    QCOMPARE(downloader.passwordsRemaining(), 0);
+    QCOMPARE(resultSpy.size(), 0);
+    QVERIFY(netMgr.requests().size() <= HibpDownloader::MAX_CONCURRENT_REQUESTS);
+
+    setNetMgr(nullptr);
+}
@@ -0,0 +1,111 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestImportTask.h"
+
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/ImportTask.h"
+#include "crypto/Crypto.h"
+
+QTEST_GUILESS_MAIN(TestImportTask)
+
+void TestImportTask::initTestCase()
+{
+    QVERIFY(Crypto::init());
+}
+
+void TestImportTask::testImport()
+{
+    QThread* workerThread = nullptr;
+    ImportTask task([&](ImportTask* importTask, QString*) {
+        workerThread = QThread::currentThread();
+        auto db = QSharedPointer<Database>::create();
+        for (int i = 0; i < 10; ++i) {
+            auto entry = new Entry();
+            entry->setGroup(db->rootGroup());
+            entry->setTitle(QString("Entry %1").arg(i));
+            auto historyItem = new Entry();
+            historyItem->setTitle(QString("Old entry %1").arg(i));
+            entry->addHistoryItem(historyItem);
+            importTask->setProgress(i + 1, 10);
+        }
+        return db;
+    });
+    QSignalSpy progressSpy(&task, SIGNAL(progressChanged(int, int)));
+
+    auto db = task.run();
+    QVERIFY(db);
+    QVERIFY(task.errorString().isEmpty());
+    QVERIFY(!task.isRunning());
+    QVERIFY(workerThread != QThread::currentThread());
+
+    // The finished tree belongs to the thread that started the import
+    QCOMPARE(db->thread(), QThread::currentThread());
+    QCOMPARE(db->rootGroup()->thread(), QThread::currentThread());
+    QCOMPARE(db->rootGroup()->entries().size(), 10);
+    QCOMPARE(db->rootGroup()->entries().last()->thread(), QThread::currentThread());
+    // history items are no QObject children and have to be moved on their own
+    QCOMPARE(db->rootGroup()->entries().last()->historyItems().size(), 1);
+    QCOMPARE(db->rootGroup()->entries().last()->historyItems().first()->thread(), QThread::currentThread());
+
+    QCOMPARE(progressSpy.size(), 10);
+    QCOMPARE(progressSpy.last().at(0).toInt(), 10);
+}
+
+void TestImportTask::testError()
+{
+    ImportTask task([](ImportTask*, QString* error) {
+        *error = "Broken file";
+        return QSharedPointer<Database>();
+    });
+
+    QSignalSpy finishedSpy(&task, SIGNAL(finished()));
+    task.start();
+    QVERIFY(task.isRunning());
+    QVERIFY(finishedSpy.wait());
+    QVERIFY(!task.database());
+    QCOMPARE(task.errorString(), QString("Broken file"));
+}
+
+void TestImportTask::testCancel()
+{
+    QSemaphore started;
+    ImportTask task([&](ImportTask* importTask, QString*) {
+        started.release();
+        while (!importTask->isCanceled()) {
+            QThread::msleep(1);
+        }
+        return QSharedPointer<Database>::create();
+    });
+
+    QSignalSpy finishedSpy(&task, SIGNAL(finished()));
+    task.start();
+    started.acquire();
+    task.cancel();
+    QVERIFY(finishedSpy.wait());
+
+    // A database produced after cancellation is discarded
+    QVERIFY(!task.database());
+    QCOMPARE(task.errorString(), QString("Import was canceled."));
+}
@@ -23,11 +23,13 @@
 #include "format/KdbxXmlReader.h"
 #include "format/KdbxXmlWriter.h"
 #include "format/KeePass2.h"
+#include "format/KeePass2RandomStream.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Writer.h"
 #include "keys/FileKey.h"
 #include "keys/PasswordKey.h"
 #include "mock/MockChallengeResponseKey.h"
+#include "util/DatabaseGenerator.h"
 
 int main(int argc, char* argv[])
 {
@@ -438,6 +440,57 @@ void TestKdbx4Argon2::testCustomData()
     QCOMPARE(newEntry->customData()->value(customDataKey2), customData2);
 }
 
+void TestKdbx4Argon2::testParallelXmlSerialization()
+{
+    DatabaseGenerator::Options options;
+    options.entries = 2500;
+    options.groupDepth = 2;
+    options.historyDepth = 1;
+    options.attachmentSize = 64;
+    options.customAttributes = 2;
+    auto db = DatabaseGenerator(options).generate();
+    // protected entries directly in the root group come before the subtrees in the document
+    auto* rootEntry = new Entry();
+    rootEntry->setUuid(QUuid::createUuid());
+    rootEntry->setPassword("root password");
+    rootEntry->setGroup(db->rootGroup());
+
+    const QByteArray key = QByteArray::fromHex("00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff");
+    QByteArray sequentialXml;
+    QByteArray parallelXml;
+    for (bool parallel : {false, true}) {
+        KeePass2RandomStream randomStream(KeePass2::ProtectedStreamAlgo::ChaCha20);
+        QVERIFY(randomStream.init(key));
+        QBuffer buffer(parallel ? &parallelXml : &sequentialXml);
+        buffer.open(QIODevice::WriteOnly);
+        KdbxXmlWriter writer(KeePass2::FILE_VERSION_4);
+        writer.setParallelSerialization(parallel);
+        writer.writeDatabase(&buffer, db.data(), &randomStream);
+        QVERIFY(!writer.hasError());
+    }
+
+    QCOMPARE(parallelXml.size(), sequentialXml.size());
+    QVERIFY(parallelXml == sequentialXml);
+
+    // the keystream must decrypt every protected value in document order
+    KeePass2RandomStream randomStream(KeePass2::ProtectedStreamAlgo::ChaCha20);
+    QVERIFY(randomStream.init(key));
+    QBuffer buffer;
+    buffer.setData(parallelXml);
+    buffer.open(QIODevice::ReadOnly);
+    KdbxXmlReader reader(KeePass2::FILE_VERSION_4);
+    Database readDb;
+    reader.readDatabase(&buffer, &readDb, &randomStream);
+    QVERIFY2(!reader.hasError(), qPrintable(reader.errorString()));
+
+    const QList<Entry*> entries = db->rootGroup()->entriesRecursive(true);
+    const QList<Entry*> readEntries = readDb.rootGroup()->entriesRecursive(true);
+    QCOMPARE(readEntries.size(), entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        QCOMPARE(readEntries[i]->password(), entries[i]->password());
+    }
+}
+
 void TestKdbx4AesKdf::initTestCaseImpl()
 {
     m_xmlDb->changeKdf(fastKdf(KeePass2::uuidToKdf(KeePass2::KDF_AES_KDBX4)));
@@ -127,6 +127,34 @@ void TestKeePass2Format::testXmlCustomIcons()
     }
 }
 
+void TestKeePass2Format::testXmlCustomIconsPreserved()
+{
+    QUuid uuid = QUuid::fromRfc4122(QByteArray::fromBase64("++vyI+daLk6omox4a6kQGA=="));
+    QByteArray iconData = m_xmlDb->metadata()->customIconData(uuid);
+    QVERIFY(!iconData.isEmpty());
+
+    QScopedPointer<Database> dbWrite(new Database());
+    dbWrite->metadata()->addCustomIcon(uuid, iconData);
+    QCOMPARE(dbWrite->metadata()->customIconData(uuid), iconData);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    bool hasError;
+    QString errorString;
+    writeXml(&buffer, dbWrite.data(), hasError, errorString);
+    QVERIFY(!hasError);
+    buffer.seek(0);
+
+    auto dbRead = readXml(&buffer, true, hasError, errorString);
+    QVERIFY(!hasError);
+    QVERIFY(dbRead.data());
+
+    // the encoded icon is written back unchanged
+    QCOMPARE(dbRead->metadata()->customIconData(uuid), iconData);
+    QCOMPARE(dbRead->metadata()->customIcon(uuid), m_xmlDb->metadata()->customIcon(uuid));
+    QCOMPARE(dbRead->metadata()->findCustomIcon(m_xmlDb->metadata()->customIcon(uuid)), uuid);
+}
+
 void TestKeePass2Format::testXmlGroupRoot()
 {
     const Group* group = m_xmlDb->rootGroup();
@@ -496,6 +524,57 @@ void TestKeePass2Format::testXmlRepairUuidHistoryItem()
     QCOMPARE(historyItem->uuid(), entry->uuid());
 }
 
+void TestKeePass2Format::testXmlRoundTripValues()
+{
+    QScopedPointer<Database> dbWrite(new Database());
+    dbWrite->metadata()->setHistoryMaxItems(-1);
+    dbWrite->metadata()->setMaintenanceHistoryDays(2147483647);
+
+    const QUuid iconUuid = QUuid::fromRfc4122(QByteArray::fromHex("00ff10e0a55a0f0f123456789abcdef0"));
+    dbWrite->metadata()->addCustomIcon(iconUuid, QByteArray("x"));
+
+    auto entry = new Entry();
+    entry->setUuid(QUuid::fromRfc4122(QByteArray::fromHex("fbebf223e75a2e4ea89a8c786ba91018")));
+    entry->setIcon(iconUuid);
+    entry->setGroup(dbWrite->rootGroup());
+    TimeInfo timeInfo;
+    timeInfo.setCreationTime(MockClock::datetimeUtc(1, 1, 1, 0, 0, 0));
+    timeInfo.setLastModificationTime(MockClock::datetimeUtc(1969, 12, 31, 23, 59, 59));
+    timeInfo.setLastAccessTime(MockClock::datetimeUtc(2038, 1, 19, 3, 14, 8));
+    timeInfo.setExpiryTime(MockClock::datetimeUtc(9999, 12, 31, 23, 59, 59));
+    timeInfo.setLocationChanged(MockClock::datetimeUtc(2020, 2, 29, 12, 0, 1));
+    timeInfo.setUsageCount(1234567);
+    entry->setTimeInfo(timeInfo);
+    entry->attributes()->set("Empty", "");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    bool hasError;
+    QString errorString;
+    writeXml(&buffer, dbWrite.data(), hasError, errorString);
+    QVERIFY(!hasError);
+    buffer.seek(0);
+
+    auto dbRead = readXml(&buffer, true, hasError, errorString);
+    QVERIFY2(!hasError, qPrintable(errorString));
+    QCOMPARE(dbRead->metadata()->historyMaxItems(), -1);
+    QCOMPARE(dbRead->metadata()->maintenanceHistoryDays(), 2147483647);
+    QCOMPARE(dbRead->metadata()->customIconData(iconUuid), QByteArray("x"));
+
+    QCOMPARE(dbRead->rootGroup()->entries().size(), 1);
+    Entry* entryRead = dbRead->rootGroup()->entries().at(0);
+    QCOMPARE(entryRead->uuid(), entry->uuid());
+    QCOMPARE(entryRead->iconUuid(), iconUuid);
+    QCOMPARE(entryRead->timeInfo().creationTime(), timeInfo.creationTime());
+    QCOMPARE(entryRead->timeInfo().lastModificationTime(), timeInfo.lastModificationTime());
+    QCOMPARE(entryRead->timeInfo().lastAccessTime(), timeInfo.lastAccessTime());
+    QCOMPARE(entryRead->timeInfo().expiryTime(), timeInfo.expiryTime());
+    QCOMPARE(entryRead->timeInfo().locationChanged(), timeInfo.locationChanged());
+    QCOMPARE(entryRead->timeInfo().usageCount(), 1234567);
+    QVERIFY(entryRead->attributes()->hasKey("Empty"));
+    QCOMPARE(entryRead->attributes()->value("Empty"), QString());
+}
+
 void TestKeePass2Format::testReadBackTargetDb()
 {
     // read back previously constructed KDBX
@@ -568,6 +647,30 @@ void TestKeePass2Format::testKdbxDeviceFailure()
     QCOMPARE(errorString, QString("FAILDEVICE"));
 }
 
+void TestKeePass2Format::testExtractToDevice()
+{
+    QScopedPointer<Database> db(new Database());
+    auto entry = new Entry();
+    entry->setParent(db->rootGroup());
+    entry->setTitle("Extract");
+    entry->attachments()->set("test", QByteArray(64 * 1024, 'Z'));
+
+    QByteArray xmlData;
+    QVERIFY(db->extract(xmlData));
+
+    // Streaming to a device produces the same document
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(db->extract(&buffer));
+    QCOMPARE(buffer.data(), xmlData);
+
+    FailDevice failDevice(512);
+    QVERIFY(failDevice.open(QIODevice::WriteOnly));
+    QString errorString;
+    QVERIFY(!db->extract(&failDevice, &errorString));
+    QCOMPARE(errorString, QString("FAILDEVICE"));
+}
+
 Q_DECLARE_METATYPE(QSharedPointer<CompositeKey>)
 
 void TestKeePass2Format::testKdbxKeyChange()
@@ -40,6 +40,7 @@ private slots:
      */
     void testXmlMetadata();
     void testXmlCustomIcons();
+    void testXmlCustomIconsPreserved();
     void testXmlGroupRoot();
     void testXmlGroup1();
     void testXmlGroup2();
@@ -52,6 +53,7 @@ private slots:
     void testXmlEmptyUuids();
     void testXmlInvalidXmlChars();
     void testXmlRepairUuidHistoryItem();
+    void testXmlRoundTripValues();
 
     /**
      * KDBX binary format tests.
@@ -62,6 +64,7 @@ private slots:
     void testKdbxAttachments();
     void testKdbxNonAsciiPasswords();
     void testKdbxDeviceFailure();
+    void testExtractToDevice();
     void testKdbxKeyChange();
     void testKdbxKeyChange_data();
     void testDuplicateAttachments();
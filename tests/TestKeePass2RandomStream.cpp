@@ -79,3 +79,31 @@ void TestKeePass2RandomStream::test()
     QCOMPARE(cipherData, cipherDataEncrypt);
     QCOMPARE(randomStreamData, cipherData);
 }
+
+void TestKeePass2RandomStream::testBlockBoundaries()
+{
+    const QByteArray key("\x11\x22\x33\x44\x55\x66\x77\x88");
+    const int Size = 20000;
+
+    QByteArray keyIv = CryptoHash::hash(key, CryptoHash::Sha512);
+    SymmetricCipher cipher(SymmetricCipher::ChaCha20, SymmetricCipher::Stream, SymmetricCipher::Encrypt);
+    QVERIFY(cipher.init(keyIv.left(32), keyIv.mid(32, 12)));
+    QByteArray expected(Size, '\0');
+    QVERIFY(cipher.processInPlace(expected));
+
+    KeePass2RandomStream randomStream(KeePass2::ProtectedStreamAlgo::ChaCha20);
+    QVERIFY(randomStream.init(key));
+
+    bool ok;
+    QByteArray actual;
+    // chunk sizes chosen to straddle the internal keystream blocks
+    for (int chunk : {1, 63, 4000, 100, 8192, 3, 7000}) {
+        actual.append(randomStream.randomBytes(chunk, &ok));
+        QVERIFY(ok);
+    }
+    QByteArray tail(Size - actual.size(), '\0');
+    QVERIFY(randomStream.processInPlace(tail));
+    actual.append(tail);
+
+    QCOMPARE(actual, expected);
+}
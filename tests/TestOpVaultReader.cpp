@@ -134,3 +134,29 @@ void TestOpVaultReader::testReadIntoDatabase()
         QVERIFY2(!group->isEmpty(), qPrintable(QStringLiteral("Group %1 is empty").arg(group->name())));
     }
 }
+
+void TestOpVaultReader::testReadIsDeterministic()
+{
+    // Items are decrypted on the thread pool, the entries must still be placed in the same order every time
+    auto readEntryOrder = [this] {
+        QDir opVaultDir(m_opVaultPath);
+        OpVaultReader reader;
+        QScopedPointer<Database> db(reader.readDatabase(opVaultDir, "a"));
+        QStringList order;
+        if (!db) {
+            return order;
+        }
+        for (const auto group : db->rootGroup()->groupsRecursive(true)) {
+            for (const auto entry : group->entries()) {
+                order << group->name() + "/" + entry->uuidToHex();
+            }
+        }
+        return order;
+    };
+
+    const QStringList expected = readEntryOrder();
+    QVERIFY(!expected.isEmpty());
+    for (int i = 0; i < 5; ++i) {
+        QCOMPARE(readEntryOrder(), expected);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TestParallelGzipStream.h"
+#include "TestGlobal.h"
+
+#include <QBuffer>
+#include <QThread>
+
+#include "FailDevice.h"
+#include "streams/ParallelGzipStream.h"
+#include "streams/QtIOCompressor"
+
+QTEST_GUILESS_MAIN(TestParallelGzipStream)
+
+namespace
+{
+    QByteArray sampleData(int size)
+    {
+        // compressible, but with enough variation to produce back references across blocks
+        QByteArray data;
+        data.reserve(size);
+        quint32 state = 1;
+        while (data.size() < size) {
+            state = state * 1103515245 + 12345;
+            data.append(QByteArray("<Entry><String><Key>Title</Key><Value>").left(8 + (state >> 16) % 32));
+            data.append(QByteArray::number(state % 1000));
+        }
+        data.resize(size);
+        return data;
+    }
+} // namespace
+
+void TestParallelGzipStream::testRoundTrip()
+{
+    QFETCH(int, size);
+    QFETCH(int, blockSize);
+    QFETCH(int, level);
+    QFETCH(int, writeSize);
+
+    const QByteArray input = sampleData(size);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    ParallelGzipStream writer(&buffer, level, blockSize);
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+    for (int offset = 0; offset < input.size(); offset += writeSize) {
+        const QByteArray chunk = input.mid(offset, writeSize);
+        QCOMPARE(writer.write(chunk), qint64(chunk.size()));
+    }
+    writer.close();
+    buffer.close();
+
+    const QByteArray compressed = buffer.data();
+    QVERIFY(compressed.startsWith("\x1f\x8b\x08"));
+
+    QBuffer compressedBuffer;
+    compressedBuffer.setData(compressed);
+    QVERIFY(compressedBuffer.open(QIODevice::ReadOnly));
+    QtIOCompressor reader(&compressedBuffer);
+    reader.setStreamFormat(QtIOCompressor::GzipFormat);
+    QVERIFY(reader.open(QIODevice::ReadOnly));
+    QCOMPARE(reader.readAll(), input);
+}
+
+void TestParallelGzipStream::testRoundTrip_data()
+{
+    QTest::addColumn<int>("size");
+    QTest::addColumn<int>("blockSize");
+    QTest::addColumn<int>("level");
+    QTest::addColumn<int>("writeSize");
+
+    QTest::newRow("empty") << 0 << 65536 << 6 << 1;
+    QTest::newRow("single block") << 1000 << 65536 << 6 << 1000;
+    QTest::newRow("many blocks") << 1000000 << 32768 << 6 << 4096;
+    QTest::newRow("unaligned writes") << 300000 << 40000 << 1 << 7777;
+    QTest::newRow("single write") << 500000 << 65536 << 9 << 500000;
+}
+
+void TestParallelGzipStream::testWriteFailure()
+{
+    FailDevice failDevice(1000);
+    QVERIFY(failDevice.open(QIODevice::WriteOnly));
+
+    ParallelGzipStream writer(&failDevice, 6, 32768);
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+
+    // more incompressible data than the stream keeps pending, so the write hits the failure
+    QByteArray input;
+    quint32 state = 1;
+    const int size = 32768 * (qMax(1, QThread::idealThreadCount()) + 1);
+    for (int i = 0; i < size; ++i) {
+        state = state * 1103515245 + 12345;
+        input.append(static_cast<char>(state >> 24));
+    }
+
+    QCOMPARE(writer.write(input), qint64(-1));
+    QCOMPARE(writer.errorString(), QString("FAILDEVICE"));
+}
+
+void TestParallelGzipStream::testFinishFailure()
+{
+    FailDevice failDevice(1000);
+    QVERIFY(failDevice.open(QIODevice::WriteOnly));
+
+    ParallelGzipStream writer(&failDevice, 6, 32768);
+    QVERIFY(writer.open(QIODevice::WriteOnly));
+
+    // stays pending until the stream is finished
+    QByteArray input;
+    quint32 state = 1;
+    for (int i = 0; i < 16384; ++i) {
+        state = state * 1103515245 + 12345;
+        input.append(static_cast<char>(state >> 24));
+    }
+
+    QCOMPARE(writer.write(input), qint64(input.size()));
+    QVERIFY(!writer.finish());
+    QCOMPARE(writer.errorString(), QString("FAILDEVICE"));
+}
@@ -18,12 +18,17 @@
 #include "TestPasswordHealth.h"
 #include "TestGlobal.h"
 
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
 #include "core/PasswordHealth.h"
+#include "crypto/Crypto.h"
 
 QTEST_GUILESS_MAIN(TestPasswordHealth)
 
 void TestPasswordHealth::initTestCase()
 {
+    QVERIFY(Crypto::init());
 }
 
 void TestPasswordHealth::testNoDb()
@@ -63,3 +68,133 @@ void TestPasswordHealth::testNoDb()
     QVERIFY(excellent.scoreReason().isEmpty());
     QVERIFY(excellent.scoreDetails().isEmpty());
 }
+
+void TestPasswordHealth::testEvaluateAll()
+{
+    QSharedPointer<Database> db(new Database());
+    const QStringList passwords = {"secret", "Yohb2ChR4", "MIhIN9UKrgtPL2hp", "secret", ""};
+    QList<const Entry*> entries;
+    for (const auto& password : passwords) {
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setPassword(password);
+        entry->setGroup(db->rootGroup());
+        entries.append(entry);
+    }
+
+    const HealthChecker checker(db);
+    auto future = checker.evaluateAll(entries);
+    future.waitForFinished();
+
+    QCOMPARE(future.resultCount(), entries.size());
+    for (int i = 0; i < entries.size(); ++i) {
+        const auto expected = checker.evaluate(entries[i]);
+        const auto health = future.resultAt(i);
+        QCOMPARE(health->score(), expected->score());
+        QCOMPARE(health->quality(), expected->quality());
+        QCOMPARE(health->scoreReason(), expected->scoreReason());
+    }
+    QCOMPARE(future.resultAt(2)->quality(), PasswordHealth::Quality::Good);
+    QCOMPARE(future.resultAt(4)->quality(), PasswordHealth::Quality::Bad);
+}
+
+void TestPasswordHealth::testEntropyCache()
+{
+    PasswordHealth::clearEntropyCache();
+    QCOMPARE(PasswordHealth::entropyCacheSize(), 0);
+    QVERIFY(!PasswordHealth::isEntropyCached("Yohb2ChR4"));
+
+    const auto uncached = PasswordHealth("Yohb2ChR4");
+    QVERIFY(PasswordHealth::isEntropyCached("Yohb2ChR4"));
+    QCOMPARE(PasswordHealth::entropyCacheSize(), 1);
+    const auto cached = PasswordHealth("Yohb2ChR4");
+    QCOMPARE(PasswordHealth::entropyCacheSize(), 1);
+    QCOMPARE(cached.entropy(), uncached.entropy());
+    QCOMPARE(cached.quality(), PasswordHealth::Quality::Weak);
+
+    // Changing the password of an entry drops the old one from the cache
+    Entry entry;
+    entry.setPassword("Yohb2ChR4");
+    entry.setPassword("MIhIN9UKrgtPL2hp");
+    QVERIFY(!PasswordHealth::isEntropyCached("Yohb2ChR4"));
+    QCOMPARE(PasswordHealth::entropyCacheSize(), 0);
+    QCOMPARE(PasswordHealth(entry.password()).quality(), PasswordHealth::Quality::Good);
+    QVERIFY(PasswordHealth::isEntropyCached("MIhIN9UKrgtPL2hp"));
+
+    // Clearing, as done when a database is locked, empties the cache
+    PasswordHealth::clearEntropyCache();
+    QCOMPARE(PasswordHealth::entropyCacheSize(), 0);
+    QVERIFY(!PasswordHealth::isEntropyCached("MIhIN9UKrgtPL2hp"));
+    QCOMPARE(PasswordHealth("Yohb2ChR4").entropy(), uncached.entropy());
+    QCOMPARE(PasswordHealth::entropyCacheSize(), 1);
+}
+
+void TestPasswordHealth::testReuse()
+{
+    QSharedPointer<Database> db(new Database());
+    auto group = new Group();
+    group->setName("Shared");
+    group->setParent(db->rootGroup());
+    const QStringList titles = {"first", "second", "unique"};
+    for (const auto& title : titles) {
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setTitle(title);
+        entry->setPassword(title == "unique" ? "Ree6uaTh3ieK7eeM" : "MIhIN9UKrgtPL2hp");
+        entry->setGroup(group);
+    }
+
+    const HealthChecker checker(db);
+    const auto entries = group->entries();
+    const auto reused = checker.evaluate(entries[0]);
+    QCOMPARE(reused->score(), 78 - 15);
+    QCOMPARE(reused->quality(), PasswordHealth::Quality::Weak);
+    QCOMPARE(reused->scoreReason(), QString("Password is used 2 times"));
+    QVERIFY(reused->scoreDetails().contains("/Shared/first"));
+    QVERIFY(reused->scoreDetails().contains("/Shared/second"));
+
+    // Only the weak strength is reported, nothing about reuse
+    const auto unique = checker.evaluate(entries[2]);
+    QCOMPARE(unique->scoreReason(), QString("Weak password"));
+    QVERIFY(!unique->scoreDetails().contains("/Shared/"));
+}
+
+void TestPasswordHealth::testIncrementalReuse()
+{
+    QSharedPointer<Database> db(new Database());
+    QList<Entry*> entries;
+    for (int i = 0; i < 3; ++i) {
+        auto entry = new Entry();
+        entry->setUuid(QUuid::createUuid());
+        entry->setTitle(QString("entry%1").arg(i));
+        entry->setPassword(i < 2 ? "MIhIN9UKrgtPL2hp" : "prompter-ream-oversleep-step-extortion");
+        entry->setGroup(db->rootGroup());
+        entries.append(entry);
+    }
+
+    HealthChecker checker(db);
+    QCOMPARE(checker.evaluate(entries[0])->quality(), PasswordHealth::Quality::Weak);
+
+    // Unchanged password, only the entries sharing it are affected
+    auto affected = checker.updateEntry(entries[2]);
+    QCOMPARE(affected, QList<const Entry*>({entries[2]}));
+
+    // Reusing a password affects the entries of the old and the new password
+    entries[2]->setPassword("MIhIN9UKrgtPL2hp");
+    affected = checker.updateEntry(entries[2]);
+    QCOMPARE(affected.size(), 3);
+    QCOMPARE(checker.evaluate(entries[0])->scoreReason(), QString("Password is used 3 times"));
+
+    entries[0]->setPassword("prompter-ream-oversleep-step-extortion");
+    affected = checker.updateEntry(entries[0]);
+    QCOMPARE(affected.size(), 3);
+    QVERIFY(checker.evaluate(entries[0])->scoreReason().isEmpty());
+    QCOMPARE(checker.evaluate(entries[1])->scoreReason(), QString("Password is used 2 times"));
+
+    // Removing an entry affects the entries that shared its password
+    affected = checker.removeEntry(entries[2]);
+    QCOMPARE(affected, QList<const Entry*>({entries[1]}));
+    delete entries[2];
+    QVERIFY(checker.evaluate(entries[1])->scoreReason().isEmpty());
+    QVERIFY(checker.removeEntry(entries[2]).isEmpty());
+}
@@ -27,6 +27,10 @@ class TestPasswordHealth : public QObject
 private slots:
     void initTestCase();
     void testNoDb();
+    void testEvaluateAll();
+    void testEntropyCache();
+    void testReuse();
+    void testIncrementalReuse();
 };
 
 #endif // KEEPASSX_TESTPASSWORDHEALTH_H
@@ -510,3 +510,81 @@ void TestSymmetricCipher::testStreamReset()
     writer.close();
     QCOMPARE(buffer.buffer().size(), 16);
 }
+
+void TestSymmetricCipher::testSeek_data()
+{
+    QTest::addColumn<SymmetricCipher::Algorithm>("algorithm");
+    QTest::addColumn<SymmetricCipher::Mode>("mode");
+    QTest::addColumn<QByteArray>("iv");
+
+    QTest::newRow("ChaCha20 64 bit nonce") << SymmetricCipher::ChaCha20 << SymmetricCipher::Stream
+                                           << QByteArray::fromHex("0001020304050607");
+    QTest::newRow("ChaCha20 96 bit nonce") << SymmetricCipher::ChaCha20 << SymmetricCipher::Stream
+                                           << QByteArray::fromHex("000102030405060708090a0b");
+    QTest::newRow("AES256-CTR") << SymmetricCipher::Aes256 << SymmetricCipher::Ctr
+                                << QByteArray::fromHex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+}
+
+void TestSymmetricCipher::testSeek()
+{
+    QFETCH(SymmetricCipher::Algorithm, algorithm);
+    QFETCH(SymmetricCipher::Mode, mode);
+    QFETCH(QByteArray, iv);
+
+    QByteArray key = QByteArray::fromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+
+    SymmetricCipher sequential(algorithm, mode, SymmetricCipher::Encrypt);
+    QVERIFY(sequential.init(key, iv));
+    QByteArray keystream(4096, '\0');
+    QVERIFY(sequential.processInPlace(keystream));
+
+    SymmetricCipher seeked(algorithm, mode, SymmetricCipher::Encrypt);
+    QVERIFY(seeked.init(key, iv));
+    for (int offset : {0, 1, 63, 64, 65, 1000, 4000}) {
+        QByteArray data(qMin(96, keystream.size() - offset), '\0');
+        QVERIFY(seeked.seek(offset));
+        QVERIFY(seeked.processInPlace(data));
+        QCOMPARE(data, keystream.mid(offset, data.size()));
+    }
+
+    SymmetricCipher unsupported(SymmetricCipher::Aes256, SymmetricCipher::Cbc, SymmetricCipher::Encrypt);
+    QVERIFY(unsupported.init(key, QByteArray(16, '\0')));
+    QVERIFY(!unsupported.seek(16));
+}
+
+void TestSymmetricCipher::testParallelStream()
+{
+    QByteArray key = QByteArray::fromHex("603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4");
+    QByteArray iv = QByteArray::fromHex("000102030405060708090a0b");
+
+    QByteArray plainText;
+    for (int i = 0; i < 10 * 1024 * 1024 + 123; ++i) {
+        plainText.append(static_cast<char>(i * 7));
+    }
+
+    bool ok;
+    SymmetricCipher cipher(SymmetricCipher::ChaCha20, SymmetricCipher::Stream, SymmetricCipher::Encrypt);
+    QVERIFY(cipher.init(key, iv));
+    QByteArray cipherText = cipher.process(plainText, &ok);
+    QVERIFY(ok);
+
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::ReadWrite));
+    SymmetricCipherStream streamEnc(
+        &buffer, SymmetricCipher::ChaCha20, SymmetricCipher::Stream, SymmetricCipher::Encrypt);
+    QVERIFY(streamEnc.init(key, iv));
+    QVERIFY(streamEnc.open(QIODevice::WriteOnly));
+    // mix small and large writes to exercise unaligned keystream offsets
+    QCOMPARE(streamEnc.write(plainText.left(100)), qint64(100));
+    QCOMPARE(streamEnc.write(plainText.mid(100)), qint64(plainText.size() - 100));
+    streamEnc.close();
+    QCOMPARE(buffer.data(), cipherText);
+
+    buffer.reset();
+    SymmetricCipherStream streamDec(
+        &buffer, SymmetricCipher::ChaCha20, SymmetricCipher::Stream, SymmetricCipher::Decrypt);
+    QVERIFY(streamDec.init(key, iv));
+    QVERIFY(streamDec.open(QIODevice::ReadOnly));
+    QCOMPARE(streamDec.read(777), plainText.left(777));
+    QCOMPARE(streamDec.readAll(), plainText.mid(777));
+}
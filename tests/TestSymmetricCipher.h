@@ -40,6 +40,9 @@ private slots:
     void testChaCha20();
     void testPadding();
     void testStreamReset();
+    void testSeek_data();
+    void testSeek();
+    void testParallelStream();
 };
 
 #endif // KEEPASSX_TESTSYMMETRICCIPHER_H
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MockNetworkAccessManager.h"
+
+#include <QNetworkReply>
+#include <QTimer>
+
+#include <cstring>
+
+namespace
+{
+    /*
+     * Reply that delivers its data on the next event loop iteration.
+     */
+    class MockNetworkReply : public QNetworkReply
+    {
+    public:
+        MockNetworkReply(const QNetworkRequest& request, const QByteArray& data, bool found, QObject* parent)
+            : QNetworkReply(parent)
+            , m_data(data)
+        {
+            setRequest(request);
+            setUrl(request.url());
+            setOperation(QNetworkAccessManager::GetOperation);
+            open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+            if (found) {
+                setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 200);
+            } else {
+                setAttribute(QNetworkRequest::HttpStatusCodeAttribute, 404);
+                setError(QNetworkReply::ContentNotFoundError, QStringLiteral("Not Found"));
+            }
+
+            QTimer::singleShot(0, this, [this] {
+                if (isFinished()) {
+                    return;
+                }
+                if (!m_data.isEmpty()) {
+                    emit readyRead();
+                }
+                setFinished(true);
+                emit finished();
+            });
+        }
+
+        void abort() override
+        {
+            if (isFinished()) {
+                return;
+            }
+            setError(QNetworkReply::OperationCanceledError, QStringLiteral("Operation canceled"));
+            setFinished(true);
+            emit finished();
+        }
+
+        bool isSequential() const override
+        {
+            return true;
+        }
+
+        qint64 bytesAvailable() const override
+        {
+            return m_data.size() - m_pos + QNetworkReply::bytesAvailable();
+        }
+
+    protected:
+        qint64 readData(char* data, qint64 maxSize) override
+        {
+            const auto size = qMin(maxSize, static_cast<qint64>(m_data.size() - m_pos));
+            memcpy(data, m_data.constData() + m_pos, static_cast<size_t>(size));
+            m_pos += static_cast<int>(size);
+            return size;
+        }
+
+    private:
+        QByteArray m_data;
+        int m_pos = 0;
+    };
+} // namespace
+
+MockNetworkAccessManager::MockNetworkAccessManager(QObject* parent)
+    : QNetworkAccessManager(parent)
+{
+}
+
+void MockNetworkAccessManager::setReply(const QUrl& url, const QByteArray& data)
+{
+    m_replies.insert(url, data);
+}
+
+const QList<QUrl>& MockNetworkAccessManager::requests() const
+{
+    return m_requests;
+}
+
+int MockNetworkAccessManager::maxConcurrentRequests() const
+{
+    return m_maxConcurrentRequests;
+}
+
+QNetworkReply* MockNetworkAccessManager::createRequest(Operation op,
+                                                      const QNetworkRequest& request,
+                                                      QIODevice* outgoingData)
+{
+    Q_UNUSED(op);
+    Q_UNUSED(outgoingData);
+
+    const auto url = request.url();
+    m_requests << url;
+    m_maxConcurrentRequests = qMax(m_maxConcurrentRequests, ++m_runningRequests);
+
+    auto reply = new MockNetworkReply(request, m_replies.value(url), m_replies.contains(url), this);
+    connect(reply, &QNetworkReply::finished, this, [this] { --m_runningRequests; });
+    return reply;
+}
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_MOCKNETWORKACCESSMANAGER_H
+#define KEEPASSXC_MOCKNETWORKACCESSMANAGER_H
+
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QUrl>
+
+/**
+ * Network access manager that answers requests from a fixed
+ * table of URLs without accessing the network. Unknown URLs
+ * fail with ContentNotFoundError. Install it with setNetMgr().
+ */
+class MockNetworkAccessManager : public QNetworkAccessManager
+{
+public:
+    explicit MockNetworkAccessManager(QObject* parent = nullptr);
+
+    void setReply(const QUrl& url, const QByteArray& data);
+
+    const QList<QUrl>& requests() const;
+    int maxConcurrentRequests() const;
+
+protected:
+    QNetworkReply* createRequest(Operation op, const QNetworkRequest& request, QIODevice* outgoingData) override;
+
+private:
+    QHash<QUrl, QByteArray> m_replies;
+    QList<QUrl> m_requests;
+    int m_runningRequests = 0;
+    int m_maxConcurrentRequests = 0;
+};
+
+#endif // KEEPASSXC_MOCKNETWORKACCESSMANAGER_H
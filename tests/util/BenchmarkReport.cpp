@@ -0,0 +1,136 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BenchmarkReport.h"
+
+#include "config-keepassx.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QThread>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+BenchmarkReport::BenchmarkReport(const QString& suite)
+    : m_suite(suite)
+{
+}
+
+bool BenchmarkReport::isEnabled()
+{
+    QByteArray env = qgetenv("BENCHMARK");
+    return !env.isEmpty() && env != "0" && env != "no";
+}
+
+/**
+ * Run a task repeatedly until at least minMsec have passed.
+ *
+ * @param task task to measure
+ * @param minMsec minimum total run time
+ * @param iterations receives the number of runs
+ * @return average run time in nanoseconds
+ */
+qint64 BenchmarkReport::measure(const std::function<void()>& task, int minMsec, int* iterations)
+{
+    QElapsedTimer timer;
+    int runs = 0;
+
+    timer.start();
+    do {
+        task();
+        ++runs;
+    } while (timer.elapsed() < minMsec);
+    qint64 nsecs = timer.nsecsElapsed();
+
+    if (iterations) {
+        *iterations = runs;
+    }
+    return nsecs / runs;
+}
+
+/**
+ * @return peak resident set size of this process in bytes, or -1 if unknown
+ */
+qint64 BenchmarkReport::peakRss()
+{
+#if defined(Q_OS_UNIX)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return -1;
+    }
+#if defined(Q_OS_MACOS)
+    return static_cast<qint64>(usage.ru_maxrss);
+#else
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return -1;
+#endif
+}
+
+void BenchmarkReport::addResult(const QString& name,
+                                const QVariantMap& parameters,
+                                qint64 nsecs,
+                                int iterations,
+                                qint64 bytes)
+{
+    QJsonObject result;
+    result.insert("name", name);
+    result.insert("parameters", QJsonObject::fromVariantMap(parameters));
+    result.insert("nsecs", static_cast<double>(nsecs));
+    result.insert("iterations", iterations);
+    if (bytes > 0 && nsecs > 0) {
+        result.insert("bytes", static_cast<double>(bytes));
+        result.insert("mibPerSec", (bytes / (1024.0 * 1024.0)) / (nsecs / 1e9));
+    }
+    m_results.append(result);
+}
+
+bool BenchmarkReport::write() const
+{
+    QJsonObject root;
+    root.insert("suite", m_suite);
+    root.insert("version", QString(KEEPASSXC_VERSION));
+    root.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    root.insert("cpu", QSysInfo::currentCpuArchitecture());
+    root.insert("threads", QThread::idealThreadCount());
+    root.insert("results", m_results);
+
+    QByteArray json = QJsonDocument(root).toJson();
+
+    QString outputDir = QString::fromLocal8Bit(qgetenv("BENCHMARK_OUTPUT"));
+    if (outputDir.isEmpty()) {
+        QTextStream out(stdout, QIODevice::WriteOnly);
+        out << json;
+        return true;
+    }
+
+    QFile file(QDir(outputDir).absoluteFilePath(m_suite + ".json"));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning("Could not write benchmark results: %s", qPrintable(file.errorString()));
+        return false;
+    }
+    return file.write(json) == json.size();
+}
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_BENCHMARKREPORT_H
+#define KEEPASSXC_BENCHMARKREPORT_H
+
+#include <QJsonArray>
+#include <QString>
+#include <QVariantMap>
+
+#include <functional>
+
+/**
+ * Collects benchmark measurements and writes them as JSON.
+ *
+ * Benchmarks only run if the BENCHMARK environment variable is set. Results are
+ * written to $BENCHMARK_OUTPUT/<suite>.json if BENCHMARK_OUTPUT names a directory,
+ * otherwise they are printed to stdout.
+ */
+class BenchmarkReport
+{
+public:
+    explicit BenchmarkReport(const QString& suite);
+
+    static bool isEnabled();
+    static qint64 measure(const std::function<void()>& task, int minMsec, int* iterations);
+    static qint64 peakRss();
+
+    void addResult(const QString& name, const QVariantMap& parameters, qint64 nsecs, int iterations, qint64 bytes = 0);
+    bool write() const;
+
+private:
+    const QString m_suite;
+    QJsonArray m_results;
+};
+
+#endif // KEEPASSXC_BENCHMARKREPORT_H
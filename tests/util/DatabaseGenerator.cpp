@@ -0,0 +1,202 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseGenerator.h"
+
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/Group.h"
+#include "core/Metadata.h"
+#include "core/Tools.h"
+
+namespace
+{
+    const char* const Words[] = {"alpha",  "bravo",   "charlie", "delta", "echo",     "foxtrot", "golf",
+                                 "hotel",  "india",   "juliet",  "kilo",  "lima",     "mike",    "november",
+                                 "oscar",  "papa",    "quebec",  "romeo", "sierra",   "tango",   "uniform",
+                                 "victor", "whiskey", "xray",    "yankee", "zulu"};
+    const int WordCount = sizeof(Words) / sizeof(Words[0]);
+
+    const QString PasswordChars =
+        QStringLiteral("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!\"#$%&'()*+,-./:;<=>?@[]^_{|}~");
+
+    // one in this many entries reuses the password of an earlier entry
+    const int PasswordReuseInterval = 7;
+} // namespace
+
+DatabaseGenerator::DatabaseGenerator(const Options& options)
+    : m_options(options)
+    , m_state(options.seed)
+    , m_baseTime(QDateTime(QDate(2020, 1, 1), QTime(0, 0), Qt::UTC))
+{
+}
+
+/**
+ * Generate a new database according to the options.
+ *
+ * Groups form a tree of groupDepth levels with groupsPerLevel children each;
+ * entries are distributed over the leaf groups in round-robin order.
+ */
+QSharedPointer<Database> DatabaseGenerator::generate()
+{
+    m_state = m_options.seed;
+    m_entries.clear();
+
+    auto db = QSharedPointer<Database>::create();
+    db->setEmitModified(false);
+    db->metadata()->setName(QStringLiteral("Generated %1").arg(m_options.entries));
+
+    Group* root = db->rootGroup();
+    root->setUpdateTimeinfo(false);
+    root->setUuid(nextUuid());
+
+    QList<Group*> leaves;
+    createGroups(root, m_options.groupDepth, leaves);
+    if (leaves.isEmpty()) {
+        leaves.append(root);
+    }
+
+    for (int i = 0; i < m_options.entries; ++i) {
+        auto* entry = new Entry();
+        entry->setUpdateTimeinfo(false);
+        populateEntry(entry, i);
+        addHistory(entry);
+        entry->setGroup(leaves.at(i % leaves.size()));
+        m_entries.append(entry);
+    }
+
+    db->setEmitModified(true);
+    return db;
+}
+
+quint32 DatabaseGenerator::nextRandom()
+{
+    // xorshift32, good enough for synthetic data
+    m_state ^= m_state << 13;
+    m_state ^= m_state >> 17;
+    m_state ^= m_state << 5;
+    return m_state;
+}
+
+QUuid DatabaseGenerator::nextUuid()
+{
+    QByteArray bytes;
+    for (int i = 0; i < 4; ++i) {
+        const quint32 value = nextRandom();
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    return QUuid::fromRfc4122(bytes);
+}
+
+QString DatabaseGenerator::nextWord()
+{
+    return QString::fromLatin1(Words[nextRandom() % WordCount]);
+}
+
+QDateTime DatabaseGenerator::nextTime()
+{
+    return m_baseTime.addSecs(nextRandom() % (365 * 24 * 3600));
+}
+
+void DatabaseGenerator::createGroups(Group* parent, int depth, QList<Group*>& leaves)
+{
+    if (depth <= 0) {
+        return;
+    }
+
+    for (int i = 0; i < m_options.groupsPerLevel; ++i) {
+        auto* group = new Group();
+        group->setUpdateTimeinfo(false);
+        group->setUuid(nextUuid());
+        group->setName(QStringLiteral("%1 %2").arg(nextWord()).arg(i));
+        TimeInfo timeInfo;
+        timeInfo.setCreationTime(nextTime());
+        timeInfo.setLastModificationTime(timeInfo.creationTime());
+        timeInfo.setLastAccessTime(timeInfo.creationTime());
+        timeInfo.setLocationChanged(timeInfo.creationTime());
+        group->setTimeInfo(timeInfo);
+        group->setParent(parent);
+
+        if (depth == 1) {
+            leaves.append(group);
+        } else {
+            createGroups(group, depth - 1, leaves);
+        }
+    }
+}
+
+void DatabaseGenerator::populateEntry(Entry* entry, int index)
+{
+    const QString word = nextWord();
+    entry->setUuid(nextUuid());
+    entry->setTitle(QStringLiteral("%1 %2").arg(word).arg(index));
+    entry->setUrl(QStringLiteral("https://%1%2.example.com/login").arg(word).arg(index));
+    entry->setNotes(QStringLiteral("Generated entry %1 for %2").arg(index).arg(nextWord()));
+
+    const bool isReference = m_options.referenceInterval > 0 && !m_entries.isEmpty()
+                             && index % m_options.referenceInterval == 0;
+    if (isReference) {
+        const Entry* target = m_entries.at(nextRandom() % m_entries.size());
+        entry->setUsername(QStringLiteral("{REF:U@I:%1}").arg(Tools::uuidToHex(target->uuid()).toUpper()));
+    } else {
+        entry->setUsername(QStringLiteral("%1.%2@example.com").arg(nextWord(), word));
+    }
+
+    if (!m_entries.isEmpty() && index % PasswordReuseInterval == 0) {
+        entry->setPassword(m_entries.at(nextRandom() % m_entries.size())->password());
+    } else {
+        QString password;
+        const int length = 8 + nextRandom() % 17;
+        for (int i = 0; i < length; ++i) {
+            password.append(PasswordChars.at(nextRandom() % PasswordChars.size()));
+        }
+        entry->setPassword(password);
+    }
+
+    for (int i = 0; i < m_options.customAttributes; ++i) {
+        entry->attributes()->set(
+            QStringLiteral("Attribute %1").arg(i), QStringLiteral("%1 %2").arg(nextWord()).arg(nextRandom()), i % 2);
+    }
+
+    if (m_options.attachmentSize > 0 && m_options.attachmentInterval > 0 && index % m_options.attachmentInterval == 0) {
+        QByteArray data(m_options.attachmentSize, '\0');
+        for (int i = 0; i < data.size(); ++i) {
+            data[i] = static_cast<char>(nextRandom() & 0xFF);
+        }
+        entry->attachments()->set(QStringLiteral("attachment-%1.bin").arg(index), data);
+    }
+
+    TimeInfo timeInfo;
+    timeInfo.setCreationTime(nextTime());
+    timeInfo.setLastModificationTime(timeInfo.creationTime().addSecs(nextRandom() % 3600));
+    timeInfo.setLastAccessTime(timeInfo.lastModificationTime());
+    timeInfo.setLocationChanged(timeInfo.creationTime());
+    entry->setTimeInfo(timeInfo);
+}
+
+void DatabaseGenerator::addHistory(Entry* entry)
+{
+    for (int i = 0; i < m_options.historyDepth; ++i) {
+        Entry* historyItem = entry->clone(Entry::CloneNoFlags);
+        historyItem->setUpdateTimeinfo(false);
+        historyItem->setPassword(QStringLiteral("%1-%2").arg(nextWord()).arg(nextRandom()));
+        TimeInfo timeInfo = historyItem->timeInfo();
+        timeInfo.setLastModificationTime(entry->timeInfo().creationTime().addSecs(i));
+        historyItem->setTimeInfo(timeInfo);
+        entry->addHistoryItem(historyItem);
+    }
+}
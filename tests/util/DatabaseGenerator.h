@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2020 KeePassXC Team <team@keepassxc.org>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEEPASSXC_DATABASEGENERATOR_H
+#define KEEPASSXC_DATABASEGENERATOR_H
+
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QUuid>
+
+class Database;
+class Entry;
+class Group;
+
+/**
+ * Builds synthetic databases for scale tests and benchmarks.
+ *
+ * The output only depends on the options, so two generators with the same
+ * options produce databases with identical UUIDs, timestamps and contents.
+ */
+class DatabaseGenerator
+{
+public:
+    struct Options
+    {
+        int entries = 1000;
+        int groupDepth = 3;
+        int groupsPerLevel = 4;
+        int historyDepth = 0;
+        int attachmentSize = 0;
+        int attachmentInterval = 10;
+        int referenceInterval = 0;
+        int customAttributes = 0;
+        quint32 seed = 1;
+    };
+
+    explicit DatabaseGenerator(const Options& options);
+
+    QSharedPointer<Database> generate();
+
+private:
+    quint32 nextRandom();
+    QUuid nextUuid();
+    QString nextWord();
+    QDateTime nextTime();
+
+    void populateEntry(Entry* entry, int index);
+    void addHistory(Entry* entry);
+    void createGroups(Group* parent, int depth, QList<Group*>& leaves);
+
+    const Options m_options;
+    quint32 m_state;
+    QDateTime m_baseTime;
+    QList<Entry*> m_entries;
+};
+
+#endif // KEEPASSXC_DATABASEGENERATOR_H